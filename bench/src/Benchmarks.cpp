@@ -0,0 +1,361 @@
+#include "CorpusGenerator.hpp"
+
+#include "obj/ObjHelpers.hpp"
+#include "obj/ObjLoader.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <format>
+#include <future>
+#include <iostream>
+#include <ranges>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Every stage runs over the same synthetic corpus, regenerated from a fixed seed on each run, plus any real obj files
+ * passed with --corpus_dir. Results are machine readable through the usual Google Benchmark flags, e.g.
+ * --benchmark_format=json or --benchmark_out=results.json --benchmark_out_format=json, and two such files can be diffed
+ * with the compare.py tool that ships with Google Benchmark. LoadFile runs also report the vertex and index counts of
+ * the loaded model, so a change in output shows up in the same file as a change in speed.
+ */
+
+namespace
+{
+  struct CorpusEntry
+  {
+    bench::Corpus corpus;
+    unsigned int  scale;
+    bool          parallelParse; // large single objects are the ones ParseObjParallel is meant for
+  };
+
+  constexpr std::array<CorpusEntry, 5> CORPUS = {{
+    {bench::Corpus::LargeMesh, 512, true},
+    {bench::Corpus::ManyObjects, 4096, false},
+    {bench::Corpus::QuadHeavy, 512, true},
+    {bench::Corpus::LodChain, 512, false},
+    {bench::Corpus::MaterialHeavy, 2048, false},
+  }};
+
+  constexpr std::array<size_t, 5> THREAD_COUNTS = {0, 1, 2, 4, 8}; // 0 runs everything on the calling thread
+  constexpr size_t                ENQUEUE_BATCH = 1024;              // tasks per iteration of the Enqueue benchmark
+
+  // what an editor import would ask for, Lods only matters to models that have lod files next to them
+  constexpr obj::Flag LOAD_FLAGS =
+    obj::Flag::Lods | obj::Flag::JoinIdentical | obj::Flag::CalculateTangents | obj::Flag::CombineMeshes;
+
+  /*!
+   * @brief An obj and the mtl next to it, read once so the stage benchmarks never touch the disk
+   */
+  struct Source
+  {
+    std::filesystem::path path;
+    std::string           obj;
+    std::string           mtl;
+  };
+
+  Source ReadSource(const std::filesystem::path& t_path) {
+    Source source{.path = t_path, .obj = obj::ReadFileToBuffer(t_path), .mtl = {}};
+
+    std::filesystem::path mtlPath = t_path;
+    mtlPath.replace_extension(".mtl");
+    if (std::filesystem::exists(mtlPath)) {
+      source.mtl = obj::ReadFileToBuffer(mtlPath);
+    }
+    return source;
+  }
+
+  /*!
+   * @brief Runs the pipeline on t_source up to the stage a benchmark measures, serially and outside of any timing
+   * @param t_construct Whether to construct vertices after parsing
+   * @param t_join Whether to also join identical vertices afterwards
+   */
+  obj::LoaderState Prepare(const Source& t_source, const bool t_construct, const bool t_join) {
+    obj::LoaderState state(obj::Flag::None);
+    state.path = t_source.path;
+
+    obj::ParseMtl(state, t_source.mtl, 0);
+    obj::ParseObj(state, t_source.obj);
+
+    if (t_construct) {
+      obj::ConstructVertices(state);
+    }
+    if (t_join) {
+      obj::JoinIdenticalVertices(state);
+    }
+    state.tempMeshes.clear();
+    return state;
+  }
+
+  size_t CountVertices(const obj::LoaderState& t_state) {
+    size_t count = 0;
+    for (const auto& meshes : t_state.meshes | std::views::values) {
+      for (const auto& mesh : meshes) {
+        count += mesh.VertexCount();
+      }
+    }
+    return count;
+  }
+
+  void BM_ParseObj(benchmark::State& t_benchState, const Source& t_source) {
+    const obj::LoaderState prototype = Prepare(t_source, false, false);
+
+    for (auto _ : t_benchState) {
+      t_benchState.PauseTiming();
+      obj::LoaderState state(obj::Flag::None);
+      state.materials = prototype.materials; // usemtl lines look their material up, like they would in a real load
+      t_benchState.ResumeTiming();
+
+      obj::ParseObj(state, t_source.obj);
+      benchmark::DoNotOptimize(state.tempMeshes);
+    }
+
+    t_benchState.SetBytesProcessed(static_cast<int64_t>(t_benchState.iterations() * t_source.obj.size()));
+  }
+
+  void BM_ParseObjParallel(benchmark::State& t_benchState, const Source& t_source, const size_t t_threads) {
+    const obj::LoaderState prototype = Prepare(t_source, false, false);
+    ThreadPool             pool(t_threads);
+
+    for (auto _ : t_benchState) {
+      t_benchState.PauseTiming();
+      obj::LoaderState state(obj::Flag::ParallelParse);
+      state.threadPool = &pool;
+      state.materials  = prototype.materials;
+      t_benchState.ResumeTiming();
+
+      obj::ParseObjParallel(state, t_source.obj);
+      benchmark::DoNotOptimize(state.tempMeshes);
+    }
+
+    t_benchState.SetBytesProcessed(static_cast<int64_t>(t_benchState.iterations() * t_source.obj.size()));
+  }
+
+  void BM_ParseMtl(benchmark::State& t_benchState, const Source& t_source) {
+    for (auto _ : t_benchState) {
+      obj::LoaderState state(obj::Flag::None);
+      obj::ParseMtl(state, t_source.mtl, 0);
+      benchmark::DoNotOptimize(state.materials);
+    }
+
+    t_benchState.SetBytesProcessed(static_cast<int64_t>(t_benchState.iterations() * t_source.mtl.size()));
+  }
+
+  void BM_JoinIdenticalVertices(benchmark::State& t_benchState, const Source& t_source) {
+    const obj::LoaderState prototype = Prepare(t_source, true, false);
+    const size_t           vertices  = CountVertices(prototype);
+
+    for (auto _ : t_benchState) {
+      t_benchState.PauseTiming();
+      obj::LoaderState state(obj::Flag::JoinIdentical);
+      state.meshes = prototype.meshes;
+      t_benchState.ResumeTiming();
+
+      obj::JoinIdenticalVertices(state);
+      benchmark::DoNotOptimize(state.meshes);
+    }
+
+    t_benchState.SetItemsProcessed(static_cast<int64_t>(t_benchState.iterations() * vertices));
+  }
+
+  void BM_CalcTangentSpace(benchmark::State& t_benchState, const Source& t_source) {
+    const obj::LoaderState prototype = Prepare(t_source, true, true);
+    const size_t           vertices  = CountVertices(prototype);
+
+    for (auto _ : t_benchState) {
+      t_benchState.PauseTiming();
+      obj::LoaderState state(obj::Flag::CalculateTangents);
+      state.meshes = prototype.meshes;
+      t_benchState.ResumeTiming();
+
+      obj::CalcTangentSpace(state);
+      benchmark::DoNotOptimize(state.meshes);
+    }
+
+    t_benchState.SetItemsProcessed(static_cast<int64_t>(t_benchState.iterations() * vertices));
+  }
+
+  void BM_LoadFile(benchmark::State&            t_benchState,
+                   const std::filesystem::path& t_path,
+                   const obj::Flag              t_flags,
+                   const size_t                 t_threads) {
+    ObjLoader      loader(t_threads);
+    obj::LoadStats stats;
+
+    for (auto _ : t_benchState) {
+      obj::Model model = loader.LoadFile(t_path, t_flags).get();
+      stats            = model.stats;
+      benchmark::DoNotOptimize(model);
+    }
+
+    t_benchState.SetBytesProcessed(static_cast<int64_t>(t_benchState.iterations() * stats.bytesRead));
+    t_benchState.counters["vertices"] = static_cast<double>(stats.vertexCount);
+    t_benchState.counters["indices"]  = static_cast<double>(stats.indexCount);
+  }
+
+  void BM_Enqueue(benchmark::State& t_benchState, const size_t t_threads, const ThreadPool::Scheduling t_scheduling) {
+    ThreadPool                     pool(t_threads, t_scheduling);
+    std::vector<std::future<void>> futures;
+    futures.reserve(ENQUEUE_BATCH);
+
+    for (auto _ : t_benchState) {
+      for (size_t i = 0; i < ENQUEUE_BATCH; ++i) {
+        futures.push_back(pool.Enqueue([] {}));
+      }
+      for (auto& future : futures) {
+        future.get();
+      }
+      futures.clear();
+    }
+
+    t_benchState.SetItemsProcessed(static_cast<int64_t>(t_benchState.iterations() * ENQUEUE_BATCH));
+  }
+
+  /*!
+   * @brief Takes --name=value off the command line, Google Benchmark rejects flags it doesn't know
+   * @return The value, or an empty string if the flag wasn't passed
+   */
+  std::string TakeFlag(int& t_argc, char** t_argv, const std::string_view t_name) {
+    const std::string prefix = std::format("--{}=", t_name);
+    std::string       value;
+
+    int kept = 1;
+    for (int i = 1; i < t_argc; ++i) {
+      const std::string_view argument = t_argv[i];
+      if (argument.starts_with(prefix)) {
+        value = argument.substr(prefix.size());
+      }
+      else {
+        t_argv[kept++] = t_argv[i];
+      }
+    }
+    t_argc = kept;
+    return value;
+  }
+
+  std::vector<size_t> ThreadCounts() {
+    const size_t        hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    std::vector<size_t> counts;
+
+    // the pool never spawns more threads than the hardware has, larger counts would only repeat the last one
+    for (const size_t count : THREAD_COUNTS) {
+      if (count <= hardware) {
+        counts.push_back(count);
+      }
+    }
+    return counts;
+  }
+
+  void RegisterCorpus(const std::vector<Source>& t_sources, const std::vector<size_t>& t_threadCounts) {
+    for (const Source& source : t_sources) {
+      const std::string name = source.path.stem().string();
+
+      benchmark::RegisterBenchmark(std::format("ParseObj/{}", name), BM_ParseObj, std::cref(source))
+        ->Unit(benchmark::kMillisecond);
+      if (!source.mtl.empty()) {
+        benchmark::RegisterBenchmark(std::format("ParseMtl/{}", name), BM_ParseMtl, std::cref(source))
+          ->Unit(benchmark::kMicrosecond);
+      }
+      benchmark::RegisterBenchmark(std::format("JoinIdenticalVertices/{}", name), BM_JoinIdenticalVertices, std::cref(source))
+        ->Unit(benchmark::kMillisecond);
+      benchmark::RegisterBenchmark(std::format("CalcTangentSpace/{}", name), BM_CalcTangentSpace, std::cref(source))
+        ->Unit(benchmark::kMillisecond);
+
+      for (const size_t threads : t_threadCounts) {
+        benchmark::RegisterBenchmark(
+          std::format("LoadFile/{}/threads:{}", name, threads),
+          BM_LoadFile,
+          source.path,
+          LOAD_FLAGS,
+          threads)
+          ->Unit(benchmark::kMillisecond)
+          ->UseRealTime();
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  const std::string corpusDirectory = TakeFlag(argc, argv, "corpus_dir");
+  const std::string outputDirectory = TakeFlag(argc, argv, "corpus_out");
+  const std::string seed            = TakeFlag(argc, argv, "corpus_seed");
+
+  // keep the worker threads busy with the benchmark rather than with log lines
+  Logger::Instance().currentLogLevel     = Logger::Error;
+  Logger::Instance().currentDiskLogLevel = Logger::None;
+
+  const bench::CorpusGenerator generator(
+    outputDirectory.empty() ? std::filesystem::temp_directory_path() / "obj_bench" : std::filesystem::path(outputDirectory),
+    seed.empty() ? bench::CorpusGenerator::DEFAULT_SEED : static_cast<std::uint32_t>(std::stoul(seed, nullptr, 0)));
+
+  const std::vector<size_t> threadCounts = ThreadCounts();
+
+  // RegisterBenchmark keeps references into these, so they have to outlive RunSpecifiedBenchmarks()
+  std::vector<Source> generated;
+  std::vector<Source> corpus;
+
+  try {
+    for (const CorpusEntry& entry : CORPUS) {
+      generated.push_back(ReadSource(generator.Generate(entry.corpus, entry.scale)));
+    }
+
+    if (!corpusDirectory.empty()) {
+      for (const auto& file : obj::ListDirectoryFiles(corpusDirectory)) {
+        // lod files are picked up with their base model
+        if (file.extension() == ".obj" && file.stem().string().find("_lod") == std::string::npos) {
+          corpus.push_back(ReadSource(file));
+        }
+      }
+    }
+  }
+  catch (const std::exception& e) {
+    std::cerr << e.what() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  RegisterCorpus(generated, threadCounts);
+  RegisterCorpus(corpus, threadCounts);
+
+  for (size_t i = 0; i < CORPUS.size(); ++i) {
+    if (!CORPUS[i].parallelParse) {
+      continue;
+    }
+    for (const size_t threads : threadCounts) {
+      benchmark::RegisterBenchmark(
+        std::format("ParseObjParallel/{}/threads:{}", generated[i].path.stem().string(), threads),
+        BM_ParseObjParallel,
+        std::cref(generated[i]),
+        threads)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+    }
+  }
+
+  for (const size_t threads : threadCounts) {
+    for (const auto scheduling : {ThreadPool::Scheduling::SharedQueue, ThreadPool::Scheduling::WorkStealing}) {
+      benchmark::RegisterBenchmark(
+        std::format(
+          "ThreadPool::Enqueue/{}/threads:{}",
+          scheduling == ThreadPool::Scheduling::SharedQueue ? "SharedQueue" : "WorkStealing",
+          threads),
+        BM_Enqueue,
+        threads,
+        scheduling)
+        ->Unit(benchmark::kMicrosecond)
+        ->UseRealTime();
+    }
+  }
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return EXIT_FAILURE;
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return EXIT_SUCCESS;
+}
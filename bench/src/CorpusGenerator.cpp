@@ -0,0 +1,213 @@
+#include "CorpusGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+  /*!
+   * @brief std::mt19937 gives the same sequence everywhere, the std distributions don't, so floats are mapped by hand
+   */
+  class Random
+  {
+  public:
+    explicit Random(const std::uint32_t t_seed) : m_engine(t_seed) {}
+
+    // in [t_min, t_max)
+    float Next(const float t_min, const float t_max) {
+      const float unit = static_cast<float>(m_engine() >> 8) * (1.0f / 16777216.0f);
+      return t_min + (t_max - t_min) * unit;
+    }
+
+  private:
+    std::mt19937 m_engine;
+  };
+
+  struct ObjWriter
+  {
+    std::string  obj;
+    std::string  mtl;
+    unsigned int elementCount = 0; // v, vt and vn written so far, all three always advance together
+  };
+
+  /*!
+   * @brief Appends a unit grid of t_resolution by t_resolution cells with a slightly random height and normal per vertex
+   * @param t_writer Writer to append to, faces index its vertices globally like exporters do
+   * @param t_random Source of the displacement, advanced by every vertex
+   * @param t_resolution Cells per side, the grid gets (t_resolution + 1)^2 vertices
+   * @param t_offset Distance along x from the origin, keeps the objects of one file apart
+   * @param t_quads Whether to write one quad per cell rather than two triangles
+   */
+  void AppendGrid(ObjWriter&         t_writer,
+                  Random&            t_random,
+                  const unsigned int t_resolution,
+                  const float        t_offset,
+                  const bool         t_quads) {
+    const unsigned int side  = t_resolution + 1;
+    const float        scale = 1.0f / static_cast<float>(t_resolution);
+    auto               out   = std::back_inserter(t_writer.obj);
+
+    for (unsigned int y = 0; y < side; ++y) {
+      for (unsigned int x = 0; x < side; ++x) {
+        std::format_to(out, "v {:.6f} {:.6f} {:.6f}\n", t_offset + x * scale, t_random.Next(-0.05f, 0.05f), y * scale);
+      }
+    }
+    for (unsigned int y = 0; y < side; ++y) {
+      for (unsigned int x = 0; x < side; ++x) {
+        std::format_to(out, "vt {:.6f} {:.6f}\n", x * scale, y * scale);
+      }
+    }
+    for (unsigned int i = 0; i < side * side; ++i) {
+      const float nx     = t_random.Next(-0.1f, 0.1f);
+      const float nz     = t_random.Next(-0.1f, 0.1f);
+      const float length = std::sqrt(nx * nx + 1.0f + nz * nz);
+      std::format_to(out, "vn {:.6f} {:.6f} {:.6f}\n", nx / length, 1.0f / length, nz / length);
+    }
+
+    // obj indices are 1 based
+    const unsigned int base = t_writer.elementCount + 1;
+    for (unsigned int y = 0; y < t_resolution; ++y) {
+      for (unsigned int x = 0; x < t_resolution; ++x) {
+        const unsigned int a = base + y * side + x;
+        const unsigned int b = a + 1;
+        const unsigned int c = a + side + 1;
+        const unsigned int d = a + side;
+
+        if (t_quads) {
+          std::format_to(out, "f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2} {3}/{3}/{3}\n", a, b, c, d);
+        }
+        else {
+          std::format_to(out, "f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", a, b, c);
+          std::format_to(out, "f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", a, c, d);
+        }
+      }
+    }
+
+    t_writer.elementCount += side * side;
+  }
+
+  void AppendMaterial(ObjWriter& t_writer, Random& t_random, const std::string_view t_name) {
+    std::format_to(
+      std::back_inserter(t_writer.mtl),
+      "newmtl {0}\n"
+      "Ka 1.000000 1.000000 1.000000\n"
+      "Kd {1:.6f} {2:.6f} {3:.6f}\n"
+      "Ks 0.500000 0.500000 0.500000\n"
+      "Ns {4:.6f}\n"
+      "illum 2\n"
+      "map_Kd textures/{0}_albedo.png\n"
+      "map_Ks textures/{0}_specular.png\n"
+      "map_Bump textures/{0}_normal.png\n"
+      "disp textures/{0}_height.png\n\n",
+      t_name,
+      t_random.Next(0.0f, 1.0f),
+      t_random.Next(0.0f, 1.0f),
+      t_random.Next(0.0f, 1.0f),
+      t_random.Next(1.0f, 256.0f));
+  }
+
+  void WriteFile(const std::filesystem::path& t_path, const std::string& t_contents) {
+    std::ofstream file(t_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      throw std::runtime_error(std::format("Failed to write benchmark corpus file {}", t_path.string()));
+    }
+    file.write(t_contents.data(), static_cast<std::streamsize>(t_contents.size()));
+  }
+
+  /*!
+   * @brief Writes one obj and the mtl it references, named after t_stem
+   */
+  void WriteModel(const std::filesystem::path& t_directory, const std::string& t_stem, ObjWriter& t_writer) {
+    WriteFile(t_directory / (t_stem + ".obj"), std::format("mtllib {}.mtl\n", t_stem) + t_writer.obj);
+    WriteFile(t_directory / (t_stem + ".mtl"), t_writer.mtl);
+  }
+}
+
+namespace bench
+{
+  std::string_view CorpusName(const Corpus t_corpus) {
+    switch (t_corpus) {
+      case Corpus::LargeMesh: return "LargeMesh";
+      case Corpus::ManyObjects: return "ManyObjects";
+      case Corpus::QuadHeavy: return "QuadHeavy";
+      case Corpus::LodChain: return "LodChain";
+      case Corpus::MaterialHeavy: return "MaterialHeavy";
+      default: return "Unknown";
+    }
+  }
+
+  CorpusGenerator::CorpusGenerator(std::filesystem::path t_directory, const std::uint32_t t_seed) :
+    m_directory(std::move(t_directory)), m_seed(t_seed) {}
+
+  /*!
+   * @brief Writes a corpus model into the generator's directory, overwriting an earlier one of the same name
+   * @param t_corpus Shape of the model
+   * @param t_scale Grid resolution of LargeMesh, QuadHeavy and LodChain, object count of ManyObjects and MaterialHeavy
+   * @return Path of the obj to load, its mtl and any lods sit next to it
+   */
+  std::filesystem::path CorpusGenerator::Generate(const Corpus t_corpus, const unsigned int t_scale) const {
+    if (t_scale == 0) {
+      throw std::runtime_error("Benchmark corpus scale has to be at least 1");
+    }
+
+    std::filesystem::create_directories(m_directory);
+
+    const std::string stem = std::format("{}_{}", CorpusName(t_corpus), t_scale);
+    Random            random(m_seed ^ (static_cast<std::uint32_t>(t_corpus) << 24) ^ t_scale);
+    ObjWriter         writer;
+
+    switch (t_corpus) {
+      case Corpus::LargeMesh:
+        AppendMaterial(writer, random, "surface");
+        writer.obj += "o surface\nusemtl surface\n";
+        AppendGrid(writer, random, t_scale, 0.0f, false);
+        break;
+      case Corpus::ManyObjects:
+        for (unsigned int m = 0; m < 8; ++m) {
+          AppendMaterial(writer, random, std::format("material_{}", m));
+        }
+        for (unsigned int o = 0; o < t_scale; ++o) {
+          std::format_to(std::back_inserter(writer.obj), "o object_{}\nusemtl material_{}\n", o, o % 8);
+          AppendGrid(writer, random, 4, static_cast<float>(o) * 1.5f, false);
+        }
+        break;
+      case Corpus::QuadHeavy:
+        AppendMaterial(writer, random, "surface");
+        writer.obj += "o surface\nusemtl surface\n";
+        AppendGrid(writer, random, t_scale, 0.0f, true);
+        break;
+      case Corpus::LodChain:
+        for (unsigned int lod = 1; lod <= LOD_DEPTH; ++lod) {
+          ObjWriter lodWriter;
+          AppendMaterial(lodWriter, random, "surface");
+          lodWriter.obj += "o surface\nusemtl surface\n";
+          AppendGrid(lodWriter, random, std::max(t_scale >> lod, 1u), 0.0f, false);
+          WriteModel(m_directory, std::format("{}_lod{}", stem, lod), lodWriter);
+        }
+
+        AppendMaterial(writer, random, "surface");
+        writer.obj += "o surface\nusemtl surface\n";
+        AppendGrid(writer, random, t_scale, 0.0f, false);
+        break;
+      case Corpus::MaterialHeavy:
+        for (unsigned int o = 0; o < t_scale; ++o) {
+          AppendMaterial(writer, random, std::format("material_{}", o));
+        }
+        // usemtl resolves by a linear search, so late materials cost the most
+        for (unsigned int o = 0; o < t_scale; ++o) {
+          std::format_to(std::back_inserter(writer.obj), "o object_{0}\nusemtl material_{0}\n", o);
+          AppendGrid(writer, random, 2, static_cast<float>(o) * 1.5f, false);
+        }
+        break;
+    }
+
+    WriteModel(m_directory, stem, writer);
+    return m_directory / (stem + ".obj");
+  }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace bench
+{
+  enum class Corpus : uint8_t
+  {
+    LargeMesh,     // one object, a displaced triangle grid
+    ManyObjects,   // many small objects cycling through a handful of materials
+    QuadHeavy,     // one object made of quads only, triangulated by the parser
+    LodChain,      // a triangle grid plus _lod1 to _lodN files, each half the resolution of the one before
+    MaterialHeavy, // every object uses a material of its own, most of the file size is the mtl
+  };
+
+  std::string_view CorpusName(Corpus t_corpus);
+
+  /*!
+   * @brief Writes a synthetic obj and its mtl (and lods) that are byte for byte the same for the same seed and scale,
+   * so results of different builds and machines stay comparable
+   */
+  class CorpusGenerator
+  {
+  public:
+    static constexpr std::uint32_t DEFAULT_SEED = 0x0b1ec7u;
+    static constexpr unsigned int  LOD_DEPTH    = 6; // lod files written next to a LodChain corpus
+
+    explicit CorpusGenerator(std::filesystem::path t_directory, std::uint32_t t_seed = DEFAULT_SEED);
+
+    std::filesystem::path Generate(Corpus t_corpus, unsigned int t_scale) const;
+
+  private:
+    std::filesystem::path m_directory;
+    std::uint32_t         m_seed;
+  };
+}
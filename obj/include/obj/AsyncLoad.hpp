@@ -0,0 +1,55 @@
+#pragma once
+
+#include "obj/FileBuffer.hpp"
+#include "obj/ObjHelpers.hpp"
+#include "obj/ObjLoader.hpp"
+
+#include <chrono>
+#include <filesystem>
+
+namespace obj
+{
+  /*!
+   * @brief One load of ObjLoader::LoadFileAsync(), run by the awaiter on a pool worker once a coroutine co_awaits it.
+   * \n The state is created when the load is, with the loader's settings at that time. Every file is read on the
+   * worker, the awaiting thread never touches the disk beyond the directory scan
+   */
+  class AsyncLoad
+  {
+  public:
+    AsyncLoad(const ObjLoader&                          t_loader,
+              LoaderState                               t_state,
+              std::chrono::duration<double, std::milli> t_cacheElapsed,
+              unsigned int                              t_taskNumber);
+
+    Model operator()();
+
+  private:
+    const ObjLoader*                          m_loader;
+    LoaderState                               m_state;
+    std::chrono::duration<double, std::milli> m_cacheElapsed;
+    unsigned int                              m_taskNumber;
+  };
+
+  // reads or maps one file on a pool worker, see ReadFileAsync()
+  struct FileRead
+  {
+    std::filesystem::path path;
+    bool                  map = false; // FileBuffer::Map() instead of FileBuffer::Read()
+
+    FileBuffer operator()() const { return map ? FileBuffer::Map(path) : FileBuffer::Read(path); }
+  };
+
+  /*!
+   * @brief Awaitable file read for coroutines, the awaiting coroutine continues on the worker that read the file
+   * @param t_pool Pool whose worker reads the file
+   * @param t_path File to read
+   * @param t_map Memory-map the file instead of copying it
+   * @return Awaiter yielding the FileBuffer, rethrows the error if the file couldn't be opened
+   */
+  inline ThreadPool::AsyncAwaiter<FileRead> ReadFileAsync(ThreadPool&           t_pool,
+                                                          std::filesystem::path t_path,
+                                                          const bool            t_map = false) {
+    return t_pool.RunAsync(FileRead{.path = std::move(t_path), .map = t_map});
+  }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "obj/ObjHelpers.hpp"
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace obj
+{
+  /*!
+   * @brief Vertex and index data of one mesh in encoded form, for Flag::CompressCache files or for sending a processed
+   * mesh over the network. Everything else of a mesh is small enough to send as it is
+   */
+  struct EncodedMeshBuffers
+  {
+    std::uint64_t             vertexCount = 0;
+    std::uint64_t             indexCount  = 0;
+    std::uint8_t              indexSize   = 4;     // 2 if the indices came from Mesh::indices16
+    bool                      split       = false; // positions and attributes instead of interleaved vertices
+    std::vector<std::uint8_t> vertices;            // interleaved Vertex, or glm::vec3 positions if split
+    std::vector<std::uint8_t> attributes;          // VertexAttributes, split only
+    std::vector<std::uint8_t> indices;
+  };
+
+  /*!
+   * @brief Lossless codecs for vertex and index buffers, built to decode at memory speed rather than to compress best.
+   * \n Vertices are encoded in blocks of VERTEX_BLOCK_SIZE, every byte of the vertex struct as its own lane of deltas to
+   * the previous vertex, packed in groups of 16 into 0, 2, 4 or 8 bits each. Neighbouring vertices after
+   * Flag::OptimizeVertexCache mostly differ in their low bytes, which leaves the other lanes close to zero. Indices are
+   * zigzag deltas to the previous index as varints, one or two bytes each once the vertex cache order made them local.
+   * \n Decoders check every read against the input and throw std::runtime_error on corrupt or truncated data
+   */
+  class BufferCodec
+  {
+  public:
+    static constexpr size_t VERTEX_BLOCK_SIZE = 256;
+
+    static std::vector<std::uint8_t> EncodeVertices(const void* t_vertices, size_t t_count, size_t t_stride);
+    static void                      DecodeVertices(std::span<const std::uint8_t> t_encoded,
+                                                    void*                         t_vertices,
+                                                    size_t                        t_count,
+                                                    size_t                        t_stride);
+
+    static std::vector<std::uint8_t> EncodeIndices(std::span<const unsigned int> t_indices);
+    static std::vector<std::uint8_t> EncodeIndices(std::span<const std::uint16_t> t_indices);
+    static void                      DecodeIndices(std::span<const std::uint8_t> t_encoded, std::span<unsigned int> t_indices);
+    static void                      DecodeIndices(std::span<const std::uint8_t> t_encoded, std::span<std::uint16_t> t_indices);
+
+    static EncodedMeshBuffers EncodeMesh(const Mesh& t_mesh);
+    static void               DecodeMesh(const EncodedMeshBuffers& t_encoded, Mesh& t_mesh);
+
+    template <typename T>
+    static std::vector<std::uint8_t> EncodeVertices(const std::vector<T>& t_vertices) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      return EncodeVertices(t_vertices.data(), t_vertices.size(), sizeof(T));
+    }
+
+    template <typename T>
+    static void DecodeVertices(const std::span<const std::uint8_t> t_encoded, std::vector<T>& t_vertices, const size_t t_count) {
+      static_assert(std::is_trivially_copyable_v<T>);
+
+      // every lane spends at least a header byte per 64 vertices, which bounds what a corrupt count can allocate
+      if (t_count / 64 > t_encoded.size()) {
+        throw std::runtime_error("Corrupt encoded vertices");
+      }
+      t_vertices.resize(t_count);
+      DecodeVertices(t_encoded, t_vertices.data(), t_count, sizeof(T));
+    }
+  };
+}
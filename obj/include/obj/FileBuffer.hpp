@@ -0,0 +1,41 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace obj
+{
+  /*!
+   * @brief Read-only contents of a file, either copied into an owned std::string or memory-mapped straight from disk.
+   * \n Parsers only ever see the View(), so both modes are interchangeable
+   */
+  class FileBuffer
+  {
+  public:
+    //-------------------------------------------------------------------------------------------------------------------
+    // Constructors/operators
+    FileBuffer() = default;
+    ~FileBuffer();
+    FileBuffer(const FileBuffer& t_other)            = delete;
+    FileBuffer& operator=(const FileBuffer& t_other) = delete;
+    FileBuffer(FileBuffer&& t_other) noexcept;
+    FileBuffer& operator=(FileBuffer&& t_other) noexcept;
+    //-------------------------------------------------------------------------------------------------------------------
+
+    static FileBuffer Read(const std::filesystem::path& t_path);
+    static FileBuffer Map(const std::filesystem::path& t_path);
+
+    [[nodiscard]] std::string_view View() const noexcept { return {m_data, m_size}; }
+    [[nodiscard]] size_t           Size() const noexcept { return m_size; }
+    [[nodiscard]] bool             IsMapped() const noexcept { return m_mapped; }
+
+  private:
+    void Release() noexcept;
+
+    std::string m_buffer;           // owning storage when the file was read, empty when mapped
+    const char* m_data   = nullptr; // start of the file contents, points into m_buffer or the mapped view
+    size_t      m_size   = 0;       // size of the file contents in bytes
+    bool        m_mapped = false;   // whether m_data is a mapped view that has to be unmapped
+  };
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace obj
+{
+  struct Mesh;
+
+  /*!
+   * @brief Reorders the triangles and vertices of a mesh for the GPU without changing what gets drawn.
+   * \n OptimizeVertexCache is Forsyth's linear-speed vertex cache optimization, OptimizeOverdraw splits the result
+   * into clusters and sorts those outside-in, OptimizeVertexFetch then lays the vertices out in first-use order.
+   * \n Scratch storage is kept between meshes so a reused optimizer stops allocating
+   */
+  class IndexOptimizer
+  {
+  public:
+    void OptimizeVertexCache(Mesh& t_mesh);
+    void OptimizeOverdraw(Mesh& t_mesh, float t_threshold = DEFAULT_OVERDRAW_THRESHOLD);
+    void OptimizeVertexFetch(Mesh& t_mesh);
+
+    // how much worse than the vertex cache order the overdraw order may get, as a ratio of cache misses per triangle
+    static constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+  private:
+    static constexpr std::uint32_t EMPTY              = UINT32_MAX;
+    static constexpr unsigned int  CACHE_SIZE         = 32;      // modelled cache for scoring
+    static constexpr unsigned int  MAX_VALENCE        = 32;      // valence scores are clamped past this
+    static constexpr unsigned int  FIFO_CACHE_SIZE    = 16;      // simulated hardware cache for the overdraw clusters
+    static constexpr size_t        MAX_RETAINED_COUNT = 1 << 22; // scratch above this is released after a pass
+
+    struct Cluster
+    {
+      std::uint32_t begin   = 0; // first triangle
+      std::uint32_t end     = 0;
+      float         sortKey = 0.0f; // how far the cluster faces away from the mesh centre, drawn highest first
+    };
+
+    [[nodiscard]] float        VertexScore(std::uint32_t t_vertex) const noexcept;
+    [[nodiscard]] float        TriangleScore(const std::vector<unsigned int>& t_indices, std::uint32_t t_triangle) const noexcept;
+    [[nodiscard]] unsigned int SimulateFifo(const std::vector<unsigned int>& t_indices, std::uint32_t t_triangle);
+    void                       ResetFifo() noexcept { m_fifoTime += FIFO_CACHE_SIZE + 1; }
+    void                       ReleaseScratch(size_t t_count);
+
+    static const std::array<float, CACHE_SIZE>  CACHE_SCORES;
+    static const std::array<float, MAX_VALENCE> VALENCE_SCORES;
+
+    // vertex cache pass, per vertex
+    std::vector<std::uint32_t> m_adjacencyOffsets; // first entry of each vertex in m_adjacency
+    std::vector<std::uint32_t> m_adjacency;        // live triangles of each vertex, emitted ones are swapped out
+    std::vector<std::uint32_t> m_liveTriangles;    // triangles of each vertex not yet emitted
+    std::vector<std::int32_t>  m_cachePosition;    // -1 when not in the modelled cache
+    std::vector<float>         m_vertexScore;
+    std::vector<std::uint8_t>  m_emitted; // per triangle
+
+    // overdraw pass
+    std::vector<std::uint32_t> m_fifoTimestamps; // time each vertex last entered the simulated cache
+    std::uint32_t              m_fifoTime = 0;
+    std::vector<std::uint32_t> m_hardBoundaries; // first triangle of every cluster that starts with a cold cache
+    std::vector<Cluster>       m_clusters;
+
+    // vertex fetch pass
+    std::vector<std::uint32_t> m_remap;
+  };
+}
\ No newline at end of file
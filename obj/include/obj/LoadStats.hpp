@@ -0,0 +1,93 @@
+#pragma once
+
+#include "pool/Time/Timer.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string_view>
+
+namespace obj
+{
+  // timed steps of a load, in pipeline order
+  enum class Stage : uint8_t
+  {
+    Io,                // reading or mapping the obj and mtl files
+    ParseMtl,
+    ParseObj,
+    ConstructVertices,
+    JoinIdentical,
+    GenerateLods,
+    CalcTangentSpace,
+    OptimizeIndices,
+    BuildMeshlets,
+    SplitStreams,
+    CombineMeshes,
+    CompactIndices,
+    WriteBuffers,      // copying the final data into the memory of a BufferAllocator
+    CacheRead,         // looking up and reading a Flag::BinaryCache file, hit or miss
+    CacheWrite,
+    Count
+  };
+
+  inline constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::Count);
+
+  [[nodiscard]] std::string_view StageName(Stage t_stage);
+
+  /*!
+   * @brief Timings and sizes of one load, returned on the Model and handed to ObjLoader::SetStatsCallback().
+   * \n Lods are processed in parallel, so stage times are summed over lods and threads and may add up to more than
+   * total. Counts cover every lod that was loaded from a file, generated lods are only part of vertexCount and indexCount
+   */
+  struct LoadStats
+  {
+    using Duration = std::chrono::duration<double, std::milli>;
+
+    std::array<Duration, STAGE_COUNT> stages{};                // time spent in each Stage
+    Duration                          queueWait{};             // from LoadFile until a worker picked the load up
+    Duration                          total{};                 // from LoadFile until the Model was ready
+    std::uint64_t                     bytesRead              = 0; // obj and mtl bytes read or mapped
+    size_t                            cornerCount            = 0; // face corners parsed, vertices without any dedup
+    size_t                            constructedVertexCount = 0; // after ConstructVertices, Flag::JoinIndices dedups
+    size_t                            weldedVertexCount      = 0; // after Flag::JoinIdentical, or constructed without
+    size_t                            vertexCount            = 0; // every mesh of the Model, generated lods included
+    size_t                            indexCount             = 0; // every mesh of the Model, generated lods included
+    size_t                            peakTempBytes          = 0; // interim memory allocated from the task arena
+    bool                              fromCache              = false;
+
+    [[nodiscard]] Duration StageTime(const Stage t_stage) const { return stages[static_cast<size_t>(t_stage)]; }
+
+    LoadStats& operator+=(const LoadStats& t_other);
+  };
+
+  /*!
+   * @brief Writes load stages as complete events of the Chrome trace event format, viewable in chrome://tracing or
+   * Perfetto. Safe to use from every worker at once, the array is closed when the trace is destroyed
+   */
+  class ChromeTrace
+  {
+  public:
+    //-------------------------------------------------------------------------------------------------------------------
+    // Constructors/operators
+    explicit ChromeTrace(const std::filesystem::path& t_path);
+    ~ChromeTrace();
+    ChromeTrace(const ChromeTrace& t_other)            = delete;
+    ChromeTrace& operator=(const ChromeTrace& t_other) = delete;
+    ChromeTrace(ChromeTrace&& t_other)                 = delete;
+    ChromeTrace& operator=(ChromeTrace&& t_other)      = delete;
+    //-------------------------------------------------------------------------------------------------------------------
+
+    void AddEvent(std::string_view             t_name,
+                  const std::filesystem::path& t_file,
+                  Timer::TimePoint             t_start,
+                  LoadStats::Duration          t_duration);
+
+  private:
+    std::mutex       m_mutex;
+    std::ofstream    m_file;
+    Timer::TimePoint m_epoch = Timer::Clock::now(); // event timestamps are relative to the trace's creation
+    bool             m_first = true;
+  };
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "obj/ObjHelpers.hpp"
+
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace obj
+{
+  // materials of one parsed mtl, shared by every load that references the file
+  struct MaterialLibrary
+  {
+    std::vector<MaterialId>                     ids;    // one per newmtl, in file order
+    std::unordered_map<std::string, MaterialId> byName; // the last definition of a name wins, like ParseObj() always did
+  };
+
+  /*!
+   * @brief Loader-wide store of every material the loads of one ObjLoader came across, for Flag::SharedMaterials.
+   * \n Each mtl is parsed once per path and handed out as a shared MaterialLibrary, it is only parsed again once its size
+   * or write time changed. Identical materials are stored once no matter how many files define them, and ids stay
+   * valid for the life of the registry. Thread safe, lookups only take a shared lock
+   */
+  class MaterialRegistry
+  {
+  public:
+    [[nodiscard]] std::shared_ptr<const MaterialLibrary> Load(const std::filesystem::path& t_mtlPath,
+                                                              std::uint64_t*               t_bytesRead = nullptr);
+
+    [[nodiscard]] const Material& Get(MaterialId t_id) const;
+    [[nodiscard]] size_t          MaterialCount() const;
+    [[nodiscard]] size_t          LibraryCount() const;
+
+  private:
+    struct LoadedLibrary
+    {
+      std::filesystem::file_time_type        time{};
+      std::uintmax_t                         size = 0;
+      std::shared_ptr<const MaterialLibrary> library;
+    };
+
+    static std::string MaterialKey(const Material& t_material);
+
+    MaterialId Intern(Material t_material);
+
+    mutable std::shared_mutex                      m_mutex;
+    std::deque<Material>                           m_materials; // indexed by id, a deque never moves what it holds
+    std::unordered_map<std::string, MaterialId>    m_ids;       // by MaterialKey()
+    std::unordered_map<std::string, LoadedLibrary> m_libraries; // by normalized absolute mtl path
+  };
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+namespace obj
+{
+  struct Mesh;
+
+  /*!
+   * @brief Quadric error metric simplifier that reduces a welded mesh by repeatedly collapsing its cheapest edges.
+   * \n Collapses move one vertex onto a neighbour, so every remaining vertex keeps its original attributes. Vertices
+   * on uv or normal seams, open borders and non-manifold edges are locked in place, which keeps seams exact.
+   * \n Scratch storage is kept between meshes so a reused simplifier stops allocating
+   */
+  class MeshSimplifier
+  {
+  public:
+    void Simplify(Mesh& t_mesh, size_t t_targetIndexCount);
+
+  private:
+    static constexpr size_t MAX_RETAINED_COUNT = 1 << 22; // scratch above this is released after a simplify
+
+    struct Quadric
+    {
+      float a00 = 0.0f, a11 = 0.0f, a22 = 0.0f, a01 = 0.0f, a02 = 0.0f, a12 = 0.0f; // symmetric 3x3
+      float b0  = 0.0f, b1  = 0.0f, b2  = 0.0f;
+      float c   = 0.0f;
+
+      [[nodiscard]] static Quadric FromPlane(const glm::vec3& t_normal, float t_distance, float t_weight) noexcept;
+      [[nodiscard]] float          Error(const glm::vec3& t_position) const noexcept;
+      Quadric&                     operator+=(const Quadric& t_other) noexcept;
+    };
+
+    struct Collapse
+    {
+      std::uint32_t from;
+      std::uint32_t to;
+      float         error;
+    };
+
+    void               LockSeamsAndBorders(const Mesh& t_mesh);
+    void               BuildAdjacency(size_t t_vertexCount);
+    [[nodiscard]] bool IsCollapseValid(const Mesh& t_mesh, std::uint32_t t_from, std::uint32_t t_to);
+    void               ReleaseScratch(size_t t_count);
+
+    std::vector<unsigned int>  m_indices;          // current triangles, shrinking every pass
+    std::vector<Quadric>       m_quadrics;         // accumulated error of every vertex
+    std::vector<std::uint8_t>  m_locked;           // vertices that may only be collapsed onto, never moved
+    std::vector<std::uint8_t>  m_touched;          // vertices already affected by a collapse in this pass
+    std::vector<std::uint32_t> m_adjacencyOffsets; // first entry of each vertex in m_adjacency, one past the end last
+    std::vector<std::uint32_t> m_adjacency;        // triangles of each vertex
+    std::vector<std::uint32_t> m_sorted;           // vertex or edge order scratch
+    std::vector<std::uint64_t> m_edges;            // unique edges packed as min << 32 | max
+    std::vector<std::uint32_t> m_neighbours;       // one-ring scratch for the link check
+    std::vector<Collapse>      m_collapses;
+    std::vector<std::uint32_t> m_remap;
+  };
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace obj
+{
+  struct Mesh;
+  struct Meshlet;
+
+  /*!
+   * @brief Partitions the triangles of a mesh into meshlets for mesh shader and GPU culling pipelines.
+   * \n Triangles are taken in index order and a meshlet is closed as soon as the next one doesn't fit, so the
+   * meshlets are only as compact as the index order, which is why this pairs with Flag::OptimizeVertexCache.
+   * \n Scratch storage is kept between meshes so a reused builder stops allocating
+   */
+  class MeshletBuilder
+  {
+  public:
+    static constexpr unsigned int MAX_VERTICES  = 64;
+    static constexpr unsigned int MAX_TRIANGLES = 124;
+
+    void Build(Mesh& t_mesh);
+
+  private:
+    static constexpr std::uint8_t NOT_LOCAL          = 0xff;
+    static constexpr size_t       MAX_RETAINED_COUNT = 1 << 22; // scratch above this is released after a build
+
+    static void ComputeBounds(const Mesh& t_mesh, Meshlet& t_meshlet);
+
+    std::vector<std::uint8_t> m_localIndex; // index of every mesh vertex inside the open meshlet, NOT_LOCAL if absent
+  };
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace obj
+{
+  struct LoaderState;
+  struct Model;
+
+  // bump whenever the layout of the cache file or of any serialized struct changes
+  inline constexpr std::uint32_t MODEL_CACHE_VERSION = 6;
+
+  // identifies the cache file of one load, built before processing so it describes the source files that were read
+  struct ModelCacheEntry
+  {
+    std::filesystem::path path; // cache file, named after a hash of the model path and output flags
+    std::string           key;  // model path, output flags and size/write time of every source file
+    bool                  compressed = false; // Flag::CompressCache, only decides how the entry is written
+  };
+
+  ModelCacheEntry GetModelCacheEntry(const LoaderState& t_state);
+  bool            ReadModelCache(const ModelCacheEntry& t_entry, LoaderState& t_state);
+  void            WriteModelCache(const ModelCacheEntry& t_entry, const Model& t_model);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "obj/ObjHelpers.hpp"
+
+#include <filesystem>
+#include <map>
+#include <vector>
+
+namespace obj
+{
+  // what changed about one watched model since the previous Poll(), handed to ObjLoader::Reload()
+  struct ModelChange
+  {
+    std::filesystem::path     path;  // as passed to ModelWatcher::Watch()
+    Flag                      flags; // as passed to ModelWatcher::Watch()
+    std::vector<File>         files; // every obj and mtl of the model as of this change
+    std::vector<unsigned int> objLods;             // lods whose obj changed, their mtl is parsed again with them
+    std::vector<unsigned int> mtlLods;             // lods where only the mtl changed
+    bool                      lodsChanged = false; // lod files appeared or disappeared, only a full load is correct
+  };
+
+  /*!
+   * @brief Polls the files of watched models for changes, and tells which lods need parsing again.
+   * \n A file counts as changed when its size or write time does, a file that is missing while being saved is
+   * reported once it is back. With Flag::Lods the directory is only scanned again when its own write time changed.
+   * Not thread safe, Watch(), Unwatch() and Poll() are meant to be called from one thread, e.g. once per editor frame
+   */
+  class ModelWatcher
+  {
+  public:
+    void Watch(const std::filesystem::path& t_path, Flag t_flags = Flag::None);
+    void Unwatch(const std::filesystem::path& t_path);
+
+    [[nodiscard]] std::vector<ModelChange> Poll();
+
+  private:
+    struct Stamp
+    {
+      std::filesystem::file_time_type time{};
+      std::uintmax_t                  size   = 0;
+      bool                            exists = false;
+
+      bool operator==(const Stamp& t_other) const = default;
+    };
+
+    struct WatchedFile
+    {
+      Stamp obj;
+      Stamp mtl;
+    };
+
+    struct WatchedModel
+    {
+      Flag                     flags = Flag::None;
+      std::vector<File>        files;
+      std::vector<WatchedFile> stamps;    // parallel to files
+      Stamp                    directory; // Flag::Lods only
+    };
+
+    static Stamp             GetStamp(const std::filesystem::path& t_path);
+    static std::vector<File> FindFiles(const std::filesystem::path& t_path, Flag t_flags);
+    static void              StampFiles(WatchedModel& t_model);
+
+    std::map<std::filesystem::path, WatchedModel> m_models;
+  };
+}
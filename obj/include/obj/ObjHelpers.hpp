@@ -1,18 +1,36 @@
 #pragma once
 
+#include "LoadStats.hpp"
+
+#include "pool/CancellationToken.hpp"
+
 #include <array>
+#include <cfloat>
 #include <filesystem>
+#include <functional>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string_view>
 
 #include <glm/common.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
+class ThreadPool;
 
 namespace obj
 {
-  using Indices = std::vector<unsigned int>;
+  class MaterialRegistry;
+  struct MaterialLibrary;
+
+  using Indices    = std::vector<unsigned int>;
+  using MaterialId = std::uint32_t; // index into the MaterialRegistry of the loader, Flag::SharedMaterials only
+
+  inline constexpr MaterialId NO_MATERIAL = UINT32_MAX;
 
   struct Material
   {
@@ -27,6 +45,7 @@ namespace obj
 
   struct Vertex
   {
+    Vertex() = default; // left uninitialized, only for bulk-filled containers such as cache reads
     Vertex(const glm::vec3& t_pos, const glm::vec3& t_norm, const glm::vec2& t_uv) : position(t_pos),
                                                                                      packedNormal(PackNormal_2_10_10_10_REV(t_norm)),
                                                                                      texCoords(t_uv), tangent() {}
@@ -96,6 +115,14 @@ namespace obj
     }
   };
 
+  // everything but the position, the attribute stream of a mesh loaded with Flag::SplitStreams
+  struct VertexAttributes
+  {
+    std::uint32_t packedNormal;
+    glm::vec2     texCoords;
+    glm::vec4     tangent;
+  };
+
   struct VertexHasher
   {
     static constexpr float SCALE = 100000.0f;
@@ -136,6 +163,66 @@ namespace obj
     }
   };
 
+  // cluster of at most MeshletBuilder::MAX_VERTICES vertices and MAX_TRIANGLES triangles, referencing ranges of its mesh
+  struct Meshlet
+  {
+    std::uint32_t vertexOffset;   // first entry in Mesh::meshletVertices
+    std::uint32_t triangleOffset; // first byte in Mesh::meshletTriangles, three per triangle
+    std::uint32_t vertexCount;
+    std::uint32_t triangleCount;
+
+    glm::vec3 center; // bounding sphere
+    float     radius;
+
+    // backface culling cone, the whole meshlet faces away if dot(normalize(coneApex - eye), coneAxis) >= coneCutoff
+    glm::vec3 coneApex;
+    glm::vec3 coneAxis;
+    float     coneCutoff;
+  };
+
+  // part of a combined mesh that came from one source mesh, indices in the range are already rebased onto the
+  // combined vertices so it draws with a vertex offset of zero
+  struct DrawRange
+  {
+    std::uint32_t firstIndex;
+    std::uint32_t indexCount;
+    std::uint32_t firstVertex;
+    std::uint32_t vertexCount;
+    std::uint32_t materialIndex;
+    MaterialId    materialId = NO_MATERIAL; // Mesh::materialId of the source mesh, Flag::SharedMaterials only
+  };
+
+  // layout of the vertices a BufferAllocator receives, one per shipped format of VertexLayout.hpp
+  enum class VertexFormat : uint8_t
+  {
+    Full,             // obj::Vertex as the pipeline builds it
+    HalfUv,           // obj::HalfUvVertex
+    Compact,          // obj::CompactVertex
+    Quantized,        // obj::QuantizedVertex, decoded through MeshBuffer::quantization
+    Position,         // obj::PositionVertex
+    QuantizedPosition // obj::QuantizedPositionVertex, decoded through MeshBuffer::quantization
+  };
+
+  // quantized positions decode as bias + scale * unorm16, with scale and bias taken from the mesh bounds
+  struct PositionQuantization
+  {
+    glm::vec3 scale{1.0f};
+    glm::vec3 bias{0.0f};
+  };
+
+  // where the final data of a mesh went when its load had a BufferAllocator, the mesh's own vectors are left empty
+  struct MeshBuffer
+  {
+    std::uint64_t        handle      = 0; // BufferGrant::handle of the grant holding the data
+    size_t               firstVertex = 0; // into the grant, only non-zero inside a combined grant whose indices are rebased
+    size_t               firstIndex  = 0;
+    size_t               vertexCount = 0;
+    size_t               indexCount  = 0;
+    std::uint8_t         indexSize   = 4; // bytes per index, 2 for meshes with Mesh::indices16
+    VertexFormat         format      = VertexFormat::Full;
+    PositionQuantization quantization; // identity unless format quantizes positions, shared by a combined grant
+  };
+
   struct Mesh
   {
     //-------------------------------------------------------------------------------------------------------------------
@@ -151,43 +238,172 @@ namespace obj
     Mesh& operator=(const Mesh& t_other) = default;
     Mesh& operator=(Mesh&& t_other)      = default;
     //-------------------------------------------------------------------------------------------------------------------
+
+    // number of vertices, whether they are interleaved, split into streams or written to a caller's buffer
+    [[nodiscard]] size_t VertexCount() const noexcept {
+      return buffer ? buffer->vertexCount : vertices.empty() ? positions.size() : vertices.size();
+    }
+
+    // number of indices, whether they are 32 or 16-bit or written to a caller's buffer
+    [[nodiscard]] size_t IndexCount() const noexcept {
+      return buffer ? buffer->indexCount : indices16.empty() ? indices.size() : indices16.size();
+    }
+
     std::string  name;
-    Material     material;
+    Material     material; // only name, tiling and index with Flag::SharedMaterials, the rest is behind materialId
+    MaterialId   materialId = NO_MATERIAL; // Flag::SharedMaterials only, also if the usemtl named no known material
     unsigned int lodLevel   = 0;
     int          meshNumber = -1;
 
-    std::vector<Vertex> vertices; // this is fine as an AoS, we access the whole struct at any given time
-    Indices             indices;
+    std::vector<Vertex>        vertices;  // interleaved, moved into positions and attributes with Flag::SplitStreams
+    Indices                    indices;
+    std::vector<std::uint16_t> indices16; // Flag::CompactIndices, replaces indices if every index fits
+
+    // Flag::SplitStreams only, both indexed like vertices so depth-only passes can bind positions on their own
+    std::vector<glm::vec3>        positions;
+    std::vector<VertexAttributes> attributes;
+
+    // Flag::BuildMeshlets only, meshletVertices index vertices and meshletTriangles index meshletVertices
+    std::vector<Meshlet>       meshlets;
+    std::vector<std::uint32_t> meshletVertices;
+    std::vector<std::uint8_t>  meshletTriangles;
+
+    std::vector<DrawRange> drawRanges; // combined meshes only, one per source mesh in lod order
+
+    std::optional<MeshBuffer> buffer; // set instead of vertices and indices if the load had a BufferAllocator
 
     size_t baseVertex = 0;
     size_t baseIndex  = 0;
   };
 
-  enum class Flag : uint8_t
+  // final sizes of one mesh, handed to a BufferAllocator right before its vertices and indices are written
+  struct BufferRequest
+  {
+    const std::filesystem::path& path;           // model being loaded
+    const Mesh&                  mesh;           // everything but the vertex and index data is final
+    VertexFormat                 format;         // layout of the interleaved vertices, always Full with Flag::SplitStreams
+    size_t                       vertexBytes;    // interleaved vertices in format, or the glm::vec3 positions with Flag::SplitStreams
+    size_t                       attributeBytes; // VertexAttributes with Flag::SplitStreams, zero otherwise
+    size_t                       indexBytes;     // unsigned int indices, std::uint16_t if the mesh has indices16
+  };
+
+  /*!
+   * @brief Memory handed out by a BufferAllocator, e.g. ranges of a persistently mapped upload buffer.
+   * \n Every span must hold at least the bytes requested for it and be aligned to 4 bytes, the loader writes each
+   * byte once and never reads it back
+   */
+  struct BufferGrant
+  {
+    std::span<std::byte> vertices;
+    std::span<std::byte> attributes; // Flag::SplitStreams only
+    std::span<std::byte> indices;
+    std::uint64_t        handle = 0; // caller's own id of the grant, kept in Mesh::buffer
+  };
+
+  // called on a worker, possibly several at once, with every mesh whose data is written to the caller's memory
+  using BufferAllocator = std::function<BufferGrant(const BufferRequest& t_request)>;
+
+  enum class Flag : uint32_t
   {
-    None              = 0,
-    CalculateTangents = 1 << 0,
-    JoinIdentical     = 1 << 1,
-    CombineMeshes     = 1 << 2,
-    Lods              = 1 << 3
+    None                = 0,
+    CalculateTangents   = 1 << 0,
+    JoinIdentical       = 1 << 1,
+    CombineMeshes       = 1 << 2,
+    Lods                = 1 << 3,
+    MapFiles            = 1 << 4,  // memory-map files on the worker instead of reading them on the calling thread
+    ParallelParse       = 1 << 5,  // split large obj files into chunks that are parsed across the thread pool
+    BinaryCache         = 1 << 6,  // reuse or write a processed binary copy of the model in the loader's cache directory
+    JoinIndices         = 1 << 7,  // share vertices between face corners with the same (v, vt, vn) indices while constructing
+    SplitStreams        = 1 << 8,  // output separate position and attribute streams instead of interleaved vertices
+    OptimizeVertexCache = 1 << 9,  // reorder indices for the post-transform cache, then vertices for fetch locality
+    OptimizeOverdraw    = 1 << 10, // also sort triangle clusters outside-in to cut overdraw, implies OptimizeVertexCache
+    GenerateLods        = 1 << 11, // simplify lod 0 into every lod level that has no file of its own, see LoaderState::lodRatios
+    BuildMeshlets       = 1 << 12, // partition every mesh into meshlets with bounds and cones, best with OptimizeVertexCache
+    SharedMaterials     = 1 << 13, // parse every mtl once per loader and reference materials by Mesh::materialId
+    CompactIndices      = 1 << 14, // output 16-bit Mesh::indices16 for meshes with at most 65536 vertices, after CombineMeshes
+    CompressCache       = 1 << 15  // store Flag::BinaryCache vertex and index arrays through BufferCodec, smaller files
   };
 
   // Enable bitwise operations for the enum
   constexpr Flag operator|(Flag t_a, Flag t_b) {
-    return static_cast<Flag>(static_cast<uint8_t>(t_a) | static_cast<uint8_t>(t_b));
+    return static_cast<Flag>(static_cast<uint32_t>(t_a) | static_cast<uint32_t>(t_b));
   }
 
   constexpr Flag operator&(Flag t_a, Flag t_b) {
-    return static_cast<Flag>(static_cast<uint8_t>(t_a) & static_cast<uint8_t>(t_b));
+    return static_cast<Flag>(static_cast<uint32_t>(t_a) & static_cast<uint32_t>(t_b));
   }
 
+  // face index component of a corner that left out its vt or vn
+  inline constexpr unsigned int NO_INDEX = UINT32_MAX;
+
+  // face corners of a mesh without a vt or vn, which picks the ConstructVertices() path of the mesh
+  struct CornerCounts
+  {
+    size_t corners    = 0;
+    size_t noTexCoord = 0;
+    size_t noNormal   = 0;
+
+    CornerCounts& operator+=(const CornerCounts& t_other) {
+      corners += t_other.corners;
+      noTexCoord += t_other.noTexCoord;
+      noNormal += t_other.noNormal;
+      return *this;
+    }
+  };
+
+  // interim per-mesh parse data, allocated from the task arena of the LoaderState that created it
   struct TempMeshes
   {
-    std::vector<glm::vec3>    vertices;
-    std::vector<glm::vec2>    texCoords;
-    std::vector<glm::vec3>    normals;
-    std::vector<glm::uvec3>   faceIndices;
-    std::vector<unsigned int> indices;
+    explicit TempMeshes(std::pmr::memory_resource* t_arena = std::pmr::get_default_resource()) : vertices(t_arena),
+      texCoords(t_arena), normals(t_arena), faceIndices(t_arena), polygons(t_arena), indices(t_arena) {}
+
+    std::pmr::vector<glm::vec3>    vertices;
+    std::pmr::vector<glm::vec2>    texCoords;
+    std::pmr::vector<glm::vec3>    normals;
+    std::pmr::vector<glm::uvec3>   faceIndices; // triangles, absent vt and vn components are NO_INDEX
+    std::pmr::vector<glm::uvec2>   polygons;    // first face index and corner count of every face above 3 corners, to TriangulatePolygons()
+    std::pmr::vector<unsigned int> indices;
+    CornerCounts                   corners;
+  };
+
+  struct ObjChunk
+  {
+    // run of records inside a chunk that belongs to a single mesh, a new one starts at every o and usemtl line
+    struct Segment
+    {
+      enum class Start : uint8_t
+      {
+        Continue, // carries on with whatever mesh the previous chunk ended on
+        Object,
+        Material
+      };
+
+      Start        start = Start::Continue;
+      std::string  name; // object or material name depending on start
+      size_t       vertexBegin   = 0, vertexEnd   = 0;
+      size_t       texCoordBegin = 0, texCoordEnd = 0;
+      size_t       normalBegin   = 0, normalEnd   = 0;
+      size_t       faceBegin     = 0, faceEnd     = 0;
+      size_t       polygonBegin  = 0, polygonEnd  = 0;
+      CornerCounts corners;
+      glm::uvec3   maxIndex{0};
+      glm::vec2    uvMin{FLT_MAX};
+      glm::vec2    uvMax{-FLT_MAX};
+    };
+
+    explicit ObjChunk(std::pmr::memory_resource* t_arena = std::pmr::get_default_resource()) : vertices(t_arena),
+      texCoords(t_arena), normals(t_arena), faceIndices(t_arena), polygons(t_arena) {}
+
+    std::string_view             buffer; // lines of the file owned by this chunk, always ends on a line boundary
+    std::pmr::vector<glm::vec3>  vertices;
+    std::pmr::vector<glm::vec2>  texCoords;
+    std::pmr::vector<glm::vec3>  normals;
+    std::pmr::vector<glm::uvec3> faceIndices; // triangulated, still 1-based and not yet rebased to the mesh
+    std::pmr::vector<glm::uvec2> polygons;    // like TempMeshes::polygons, indexing faceIndices of the chunk
+    std::vector<Segment>         segments;
+    std::string                  mtlFileName;
+    glm::uvec3                   base{0};                 // v/vt/vn defined by the chunks before this one
+    bool                         relativeIndices = false; // set if any face used a relative index
   };
 
   struct File
@@ -203,11 +419,29 @@ namespace obj
     std::filesystem::path path;
     std::string           mtlFileName;
     Flag                  flags;
+    ThreadPool*           threadPool = nullptr; // pool of the owning loader, used to fan out work inside a task
+    std::filesystem::path cacheDirectory;       // where Flag::BinaryCache files live
+    std::pmr::memory_resource* arena = std::pmr::get_default_resource(); // backs tempMeshes and parse chunks
+    std::vector<float>    lodRatios;            // Flag::GenerateLods index ratio of lod i + 1 to lod 0, per entry i
+    CancellationToken     cancel;               // checked between pipeline stages, a cancelled load throws
+    LoadStats             stats;                // filled in as the load runs, handed to the Model
+    Timer::TimePoint      enqueueTime;          // when the load was handed to the pool, for LoadStats::queueWait
+    std::shared_ptr<ChromeTrace> trace;         // receives every timed stage if set
+    BufferAllocator       bufferAllocator;      // receives the final vertices and indices instead of the Model if set
+    VertexFormat          vertexFormat = VertexFormat::Full; // layout of the vertices written to bufferAllocator
+    MaterialRegistry*     materialRegistry = nullptr; // registry of the owning loader, used with Flag::SharedMaterials
+
+    // called with the finished stats of every successful load
+    std::function<void(const std::filesystem::path& t_path, const LoadStats& t_stats)> onStats;
+
+    // called as soon as the per-mesh stages of a lod are done, before the model is complete
+    std::function<void(unsigned int t_lodLevel, const std::vector<Mesh>& t_meshes)> onLodLoaded;
 
     std::vector<File>                               filePaths;      // interim file paths, discarded
     std::map<unsigned int, std::vector<Mesh>>       meshes;         // final calculated meshes, moved
     std::vector<Mesh>                               combinedMeshes; // final combined meshes, moved
     std::map<unsigned int, std::vector<Material>>   materials;      // interim .mtl materials, discarded
+    std::map<unsigned int, std::shared_ptr<const MaterialLibrary>> materialLibraries; // Flag::SharedMaterials, discarded
     std::map<unsigned int, std::vector<TempMeshes>> tempMeshes;     // interim storage, discarded
   };
 
@@ -216,7 +450,7 @@ namespace obj
     //-------------------------------------------------------------------------------------------------------------------
     // Constructors/operators
     explicit Model(LoaderState& t_state) : meshes(std::move(t_state.meshes)), combinedMeshes(std::move(t_state.combinedMeshes)),
-                                           path(std::move(t_state.path)) {}
+                                           path(std::move(t_state.path)), stats(t_state.stats) {}
 
     ~Model()                           = default;
     Model(const Model&)                = delete;
@@ -228,18 +462,49 @@ namespace obj
     std::map<unsigned int, std::vector<Mesh>> meshes;
     std::vector<Mesh>                         combinedMeshes;
     std::filesystem::path                     path;
+    LoadStats                                 stats;
   };
 
 
   std::string                     ReadFileToBuffer(const std::filesystem::path& t_path);
+  std::filesystem::path           GetModelDirectory(const std::filesystem::path& t_path);
+  std::vector<std::filesystem::path> ListDirectoryFiles(const std::filesystem::path& t_directory);
   void                            CacheFilePaths(LoaderState& t_state);
+  void                            CacheFilePaths(LoaderState& t_state, std::span<const std::filesystem::path> t_directoryFiles);
+  const char*                     FindLineEnd(const char* t_ptr, const char* t_end);
+  std::string_view                NextLine(const char*& t_ptr, const char* t_end);
   const char*                     ParseFloat(const char* t_ptr, const char* t_end, float& t_out);
-  void                            ParseObj(LoaderState& t_state, const std::string& t_buffer, unsigned int t_lodLevel = 0);
-  void                            ParseMtl(LoaderState& t_state, const std::string& t_buffer, const unsigned int& t_lodLevel);
+  const char*                     ParseIndex(const char* t_ptr, const char* t_end, std::int64_t& t_out);
+  unsigned int                    ParseFace(const char*              t_ptr,
+                                            const char*              t_end,
+                                            const glm::uvec3&        t_counts,
+                                            std::vector<glm::uvec3>& t_face,
+                                            bool&                    t_relative);
+  void                            AppendTriangulatedFace(std::pmr::vector<glm::uvec3>& t_faceIndices,
+                                                         std::pmr::vector<glm::uvec2>& t_polygons,
+                                                         std::span<const glm::uvec3>   t_face);
+  void                            TriangulatePolygons(TempMeshes& t_tempMesh);
+  void                            ParseObj(LoaderState& t_state, std::string_view t_buffer, unsigned int t_lodLevel = 0);
+  void                            ParseObjChunk(ObjChunk& t_chunk);
+  void                            ParseObjParallel(LoaderState& t_state, std::string_view t_buffer, unsigned int t_lodLevel = 0);
+  void                            ParseMtl(LoaderState& t_state, std::string_view t_buffer, const unsigned int& t_lodLevel);
+  void                            ReassignMaterials(std::vector<Mesh>& t_meshes, const std::vector<Material>& t_materials);
+  void                            ReassignMaterials(std::vector<Mesh>& t_meshes, const MaterialLibrary& t_library);
+  void                            LoadSharedMaterials(LoaderState& t_state);
+  void                            SyncDrawRangeMaterials(std::vector<Mesh>&       t_combinedMeshes,
+                                                         const std::vector<Mesh>& t_meshes,
+                                                         unsigned int             t_lodLevel);
   std::vector<Mesh>&              GetMeshContainer(LoaderState& t_state, unsigned int t_lodLevel = 0);
   std::pair<glm::vec3, glm::vec3> GetTangentCoords(const Vertex& t_v1, const Vertex& t_v2, const Vertex& t_v3);
+  void                            AssignBaseOffsets(LoaderState& t_state);
   void                            ConstructVertices(LoaderState& t_state);
   void                            CalcTangentSpace(LoaderState& t_state);
   void                            JoinIdenticalVertices(LoaderState& t_state);
+  void                            GenerateLods(LoaderState& t_state);
+  void                            OptimizeIndices(LoaderState& t_state);
+  void                            BuildMeshlets(LoaderState& t_state);
   void                            CombineMeshes(LoaderState& t_state);
+  void                            SplitVertexStreams(LoaderState& t_state);
+  void                            CompactIndices(LoaderState& t_state);
+  void                            WriteBuffers(LoaderState& t_state);
 }
@@ -3,12 +3,25 @@
 #include "pool/ThreadPool.hpp"
 
 #include <filesystem>
+#include <functional>
+#include <span>
 
 namespace obj
 {
-  enum class Flag : uint8_t;
+  enum class Flag : uint32_t;
+  enum class VertexFormat : uint8_t;
   struct Model;
+  struct Mesh;
+  struct ModelChange;
+  struct LoadStats;
   struct LoaderState;
+  struct FileRead;
+  struct BufferGrant;
+  struct BufferRequest;
+  class AsyncLoad;
+  class ChromeTrace;
+  class FileBuffer;
+  class MaterialRegistry;
 }
 
 class Logger;
@@ -16,9 +29,32 @@ class Logger;
 class ObjLoader
 {
 public:
+  struct LoadRequest
+  {
+    std::filesystem::path    path;
+    std::optional<obj::Flag> flags    = std::nullopt;
+    ThreadPool::Priority     priority = ThreadPool::Priority::Normal;
+    CancellationToken        cancel{}; // checked before the load starts and between its stages
+
+    // receives the final vertices and indices instead of the Model if set, see obj::BufferAllocator
+    std::function<obj::BufferGrant(const obj::BufferRequest&)> allocator{};
+    obj::VertexFormat vertexFormat{}; // layout of the vertices written to allocator, VertexFormat::Full if left out
+  };
+
+  // called on the worker that finished the request at t_index, get() on the ready future rethrows load errors
+  using LoadCallback = std::function<void(size_t t_index, std::future<obj::Model> t_model)>;
+
+  // called on a worker with every lod as soon as its per-mesh stages are done. CombineMeshes and the base offsets span
+  // all lods, so they are only final in the Model
+  using LodCallback = std::function<void(unsigned int t_lodLevel, const std::vector<obj::Mesh>& t_meshes)>;
+
+  // called on the worker with the stats of every load that succeeded, the same stats end up on the Model
+  using StatsCallback = std::function<void(const std::filesystem::path& t_path, const obj::LoadStats& t_stats)>;
+
   //-------------------------------------------------------------------------------------------------------------------
   // Constructors/operators
-  explicit ObjLoader(size_t t_maxThreads = 0);
+  explicit ObjLoader(size_t t_maxThreads = 0, ThreadPool::Scheduling t_scheduling = ThreadPool::Scheduling::SharedQueue);
+  ObjLoader(size_t t_maxThreads, const ThreadPool::PoolOptions& t_poolOptions);
   ~ObjLoader()                              = default;
   ObjLoader& operator=(ObjLoader& t_other)  = delete;
   ObjLoader& operator=(ObjLoader&& t_other) = delete;
@@ -27,21 +63,91 @@ public:
   //-------------------------------------------------------------------------------------------------------------------
 
   std::future<obj::Model> LoadFile(const std::filesystem::path& t_path, std::optional<obj::Flag> t_flags = std::nullopt);
+  std::future<obj::Model> LoadFile(const LoadRequest& t_request);
+  std::future<obj::Model> LoadFileStreaming(const std::filesystem::path& t_path,
+                                            LodCallback                  t_onLodLoaded,
+                                            std::optional<obj::Flag>     t_flags = std::nullopt);
+  std::future<obj::Model> LoadFileStreaming(const LoadRequest& t_request, LodCallback t_onLodLoaded);
+
+  std::vector<std::future<obj::Model>> LoadFiles(std::span<const LoadRequest> t_requests);
+  void                                 LoadFiles(std::span<const LoadRequest> t_requests, LoadCallback t_onLoaded);
+
+  std::future<obj::Model> Reload(obj::Model t_model, const obj::ModelChange& t_change);
+  std::future<obj::Model> Reload(obj::Model t_model, const obj::ModelChange& t_change, const LoadRequest& t_request);
+
+  // Awaitable counterparts of LoadFile() for coroutines, co_await needs obj/AsyncLoad.hpp
+  [[nodiscard]] ThreadPool::AsyncAwaiter<obj::AsyncLoad> LoadFileAsync(const std::filesystem::path& t_path,
+                                                                       std::optional<obj::Flag>     t_flags = std::nullopt);
+  [[nodiscard]] ThreadPool::AsyncAwaiter<obj::AsyncLoad> LoadFileAsync(const LoadRequest& t_request);
+  [[nodiscard]] ThreadPool::AsyncAwaiter<obj::FileRead>  ReadFileAsync(const std::filesystem::path& t_path, bool t_map = false);
+
+  // Continues the awaiting coroutine on one of the loader's workers, see ThreadPool::Schedule()
+  [[nodiscard]] ThreadPool::ScheduleAwaiter Schedule(const ThreadPool::Priority t_priority = ThreadPool::Priority::Normal) {
+    return m_threadPool.Schedule(t_priority);
+  }
 
   [[nodiscard]] constexpr size_t WorkerCount() const { return m_threadPool.ThreadCount(); }
 
+  // Waits for every load started so far, see ThreadPool::Drain()
+  void Drain() { m_threadPool.Drain(); }
+
+  // Stops the pool, see ThreadPool::Shutdown(). Loads started afterwards never complete
+  void Shutdown(const ThreadPool::ShutdownMode t_mode = ThreadPool::ShutdownMode::Drain) { m_threadPool.Shutdown(t_mode); }
+
+  // Directory for obj::Flag::BinaryCache files, only picked up by loads started after it is set
+  void SetCacheDirectory(const std::filesystem::path& t_directory) { m_cacheDirectory = t_directory; }
+
+  // Index count ratio to lod 0 of every level obj::Flag::GenerateLods creates, entry i is lod i + 1
+  void SetLodRatios(std::vector<float> t_ratios) { m_lodRatios = std::move(t_ratios); }
+
+  // Only picked up by loads started after it is set, like the setters above
+  void SetStatsCallback(StatsCallback t_onStats) { m_onStats = std::move(t_onStats); }
+  void SetTraceFile(const std::filesystem::path& t_path);
+
+  // Materials of every obj::Flag::SharedMaterials load of this loader, looked up by obj::Mesh::materialId
+  [[nodiscard]] const obj::MaterialRegistry& Materials() const { return *m_materials; }
+
 private:
-  size_t                    m_maxThreadsUser = 0; // User-defined maximum number of dispatched threads
-  std::atomic<unsigned int> m_totalTasks     = 0; // Global task counter
-  ThreadPool                m_threadPool;
-  Logger*                   m_logger = &Logger::Instance();
-
-  obj::Model ConstructTask(const obj::LoaderState&                              t_state,
-                           const std::unordered_map<unsigned int, std::string>& t_objBuffers,
-                           const std::unordered_map<unsigned int, std::string>& t_mtlBuffers,
-                           std::chrono::duration<double, std::milli>            t_cacheElapsed,
-                           unsigned int                                         t_taskNumber) const;
-  static obj::Model LoadFileInternal(obj::LoaderState&                                    t_state,
-                                     const std::unordered_map<unsigned int, std::string>& t_objBuffer,
-                                     const std::unordered_map<unsigned int, std::string>& t_mtlBuffer);
+  friend class obj::AsyncLoad;
+
+  struct BatchItem;
+
+  static constexpr std::uintmax_t SMALL_FILE_BYTES  = 256 * 1024;      // loads below this are grouped with others
+  static constexpr std::uintmax_t BATCH_GROUP_BYTES = 4 * 1024 * 1024; // upper bound of source bytes per grouped task
+
+  std::filesystem::path             m_cacheDirectory = "cache/";
+  std::vector<float>                m_lodRatios      = {0.5f, 0.25f, 0.125f};
+  StatsCallback                     m_onStats;
+  std::shared_ptr<obj::ChromeTrace> m_trace;              // shared with every load started while it was set
+  size_t                            m_maxThreadsUser = 0; // User-defined maximum number of dispatched threads
+  std::atomic<unsigned int>         m_totalTasks     = 0; // Global task counter
+  std::shared_ptr<obj::MaterialRegistry> m_materials;     // declared before the pool, so it outlives every task
+  ThreadPool                        m_threadPool;
+  Logger*                           m_logger = &Logger::Instance();
+
+  std::future<obj::Model> EnqueueLoad(const LoadRequest& t_request, LodCallback t_onLodLoaded);
+  obj::LoaderState CreateState(const std::filesystem::path&              t_path,
+                               std::optional<obj::Flag>                  t_flags,
+                               const std::vector<std::filesystem::path>* t_directoryFiles);
+  obj::LoaderState InitState(const std::filesystem::path& t_path, std::optional<obj::Flag> t_flags);
+  static void      ApplyRequest(obj::LoaderState& t_state, const LoadRequest& t_request);
+  void EnqueueBatch(std::span<const LoadRequest>               t_requests,
+                    std::vector<std::future<obj::Model>>*      t_futures,
+                    const std::shared_ptr<const LoadCallback>& t_onLoaded);
+  void ConstructBatchTask(std::vector<BatchItem>                    t_items,
+                          std::shared_ptr<const LoadCallback>       t_onLoaded,
+                          std::chrono::duration<double, std::milli> t_cacheElapsed) const;
+  obj::Model ConstructTask(const obj::LoaderState&                        t_state,
+                           std::unordered_map<unsigned int, obj::FileBuffer> t_objBuffers,
+                           std::unordered_map<unsigned int, obj::FileBuffer> t_mtlBuffers,
+                           std::chrono::duration<double, std::milli>      t_cacheElapsed,
+                           unsigned int                                   t_taskNumber) const;
+  obj::Model ReloadTask(obj::LoaderState t_state,
+                        obj::Model       t_model,
+                        obj::ModelChange t_change,
+                        unsigned int     t_taskNumber) const;
+  static obj::Model LoadFileInternal(obj::LoaderState&                                  t_state,
+                                     std::unordered_map<unsigned int, obj::FileBuffer>& t_objBuffer,
+                                     std::unordered_map<unsigned int, obj::FileBuffer>& t_mtlBuffer);
+  static void       ProcessMeshes(obj::LoaderState& t_state);
 };
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+
+namespace obj
+{
+  /*!
+   * @brief Monotonic arena for the interim containers of one load task, owned by the worker thread running the task.
+   * \n Allocations are served from one retained block that grows to fit the largest task the thread has seen, so after
+   * the first few loads a worker stops hitting the global heap. Subtasks on other threads may allocate from it too,
+   * which is why allocation takes a lock, deallocation is a no-op because everything is freed at once by Reset()
+   */
+  class TaskArena final : public std::pmr::memory_resource
+  {
+  public:
+    //-------------------------------------------------------------------------------------------------------------------
+    // Constructors/operators
+    explicit TaskArena(size_t t_blockSize = INITIAL_BLOCK_BYTES);
+    ~TaskArena() override                          = default;
+    TaskArena(const TaskArena& t_other)            = delete;
+    TaskArena& operator=(const TaskArena& t_other) = delete;
+    TaskArena(TaskArena&& t_other)                 = delete;
+    TaskArena& operator=(TaskArena&& t_other)      = delete;
+    //-------------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] static TaskArena& ForThisThread();
+
+    // owner thread only, once every container allocated from the arena was destroyed
+    void Reset();
+
+    [[nodiscard]] size_t BlockSize() const noexcept { return m_blockSize; }
+    [[nodiscard]] size_t BytesUsed();
+
+  private:
+    static constexpr size_t INITIAL_BLOCK_BYTES = 1 << 20;  // 1 MiB
+    static constexpr size_t MAX_BLOCK_BYTES     = 64 << 20; // retained per thread, larger tasks spill to the heap
+
+    void* do_allocate(size_t t_bytes, size_t t_alignment) override;
+    void  do_deallocate(void*, size_t, size_t) override {}
+    bool  do_is_equal(const memory_resource& t_other) const noexcept override { return this == &t_other; }
+
+    std::mutex                                         m_mutex;
+    std::unique_ptr<std::byte[]>                       m_block;
+    size_t                                             m_blockSize = 0;
+    size_t                                             m_used      = 0; // bytes handed out since the last reset
+    std::optional<std::pmr::monotonic_buffer_resource> m_resource;
+  };
+}
\ No newline at end of file
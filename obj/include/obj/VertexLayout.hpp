@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ObjHelpers.hpp"
+
+#include <concepts>
+
+namespace obj
+{
+  /*!
+   * @brief A compact output vertex format, built from the pipeline's full obj::Vertex by a static Pack().
+   * \n Any struct providing Pack() and QUANTIZED_POSITION can be passed to PackVertices, the formats below are the
+   * ones shipped with the loader
+   */
+  template <typename T>
+  concept VertexLayout = std::is_trivially_copyable_v<T> && requires(const Vertex& t_v, const PositionQuantization& t_q)
+  {
+    { T::Pack(t_v, t_q) } -> std::same_as<T>;
+    { T::QUANTIZED_POSITION } -> std::convertible_to<bool>;
+  };
+
+  // 36 bytes: obj::Vertex with half-float uvs
+  struct HalfUvVertex
+  {
+    glm::vec3     position;
+    std::uint32_t packedNormal;
+    std::uint32_t texCoords; // two halfs, x in the low bits
+    glm::vec4     tangent;
+
+    static constexpr bool QUANTIZED_POSITION = false;
+    static HalfUvVertex   Pack(const Vertex& t_v, const PositionQuantization& t_q);
+  };
+
+  // 24 bytes: float position, half-float uvs and a 2_10_10_10 tangent with the bitangent sign in w
+  struct CompactVertex
+  {
+    glm::vec3     position;
+    std::uint32_t packedNormal;
+    std::uint32_t texCoords;
+    std::uint32_t packedTangent;
+
+    static constexpr bool QUANTIZED_POSITION = false;
+    static CompactVertex  Pack(const Vertex& t_v, const PositionQuantization& t_q);
+  };
+
+  // 20 bytes: CompactVertex with 16-bit positions relative to the mesh bounds
+  struct QuantizedVertex
+  {
+    std::uint16_t position[3];
+    std::uint16_t padding = 0;
+    std::uint32_t packedNormal;
+    std::uint32_t texCoords;
+    std::uint32_t packedTangent;
+
+    static constexpr bool  QUANTIZED_POSITION = true;
+    static QuantizedVertex Pack(const Vertex& t_v, const PositionQuantization& t_q);
+  };
+
+  // 12 bytes: position only, for depth and shadow passes
+  struct PositionVertex
+  {
+    glm::vec3 position;
+
+    static constexpr bool QUANTIZED_POSITION = false;
+    static PositionVertex Pack(const Vertex& t_v, const PositionQuantization& t_q);
+  };
+
+  // 8 bytes: 16-bit position only, relative to the mesh bounds
+  struct QuantizedPositionVertex
+  {
+    std::uint16_t position[3];
+    std::uint16_t padding = 0;
+
+    static constexpr bool          QUANTIZED_POSITION = true;
+    static QuantizedPositionVertex Pack(const Vertex& t_v, const PositionQuantization& t_q);
+  };
+
+  template <VertexLayout Layout>
+  struct PackedVertices
+  {
+    std::vector<Layout>  vertices;     // same order as Mesh::vertices, so Mesh::indices still apply
+    PositionQuantization quantization; // identity unless Layout::QUANTIZED_POSITION
+  };
+
+  void                 RequireInterleaved(const Mesh& t_mesh);
+  PositionQuantization GetPositionQuantization(const Mesh& t_mesh);
+  std::uint32_t        PackHalf2(const glm::vec2& t_v);
+  std::uint32_t        PackTangent_2_10_10_10_REV(const glm::vec4& t_tangent);
+  void                 QuantizePosition(const glm::vec3& t_position, const PositionQuantization& t_q, std::uint16_t (&t_out)[3]);
+
+  template <VertexLayout Layout>
+  PackedVertices<Layout> PackVertices(const Mesh& t_mesh);
+
+  size_t               VertexFormatSize(VertexFormat t_format);
+  PositionQuantization PackVertices(const Mesh& t_mesh, VertexFormat t_format, std::byte* t_out);
+}
+
+#include "VertexLayout.inl"
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+namespace obj
+{
+  /*!
+   * @brief Converts the full vertices of a processed mesh into a compact output layout
+   * @tparam Layout Output vertex format, one of the shipped layouts or any type satisfying VertexLayout
+   * @param t_mesh Processed mesh with interleaved vertices, its indices stay valid for the packed vertices
+   * @return Packed vertices and the scale and bias needed to decode quantized positions
+   */
+  template <VertexLayout Layout>
+  PackedVertices<Layout> PackVertices(const Mesh& t_mesh) {
+    RequireInterleaved(t_mesh);
+
+    PackedVertices<Layout> packed;
+
+    if constexpr (Layout::QUANTIZED_POSITION) {
+      packed.quantization = GetPositionQuantization(t_mesh);
+    }
+
+    packed.vertices.reserve(t_mesh.vertices.size());
+    for (const Vertex& v : t_mesh.vertices) {
+      packed.vertices.push_back(Layout::Pack(v, packed.quantization));
+    }
+
+    return packed;
+  }
+}
\ No newline at end of file
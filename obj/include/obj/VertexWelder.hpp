@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace obj
+{
+  struct Mesh;
+  struct Vertex;
+
+  /*!
+   * @brief Flat open-addressing table that merges identical vertices of a mesh.
+   * \n Every vertex is quantized to a key once, lookups compare keys before the exact VertexEqual check,
+   * and the table, keys and remap storage are kept between meshes so a reused welder stops allocating
+   */
+  class VertexWelder
+  {
+  public:
+    void Weld(Mesh& t_mesh);
+
+  private:
+    using Key = std::array<std::int32_t, 10>;
+
+    static constexpr std::uint32_t EMPTY              = UINT32_MAX;
+    static constexpr size_t        MAX_RETAINED_SLOTS = 1 << 22; // scratch above this is released after a weld
+
+    [[nodiscard]] static Key           MakeKey(const Vertex& t_vertex) noexcept;
+    [[nodiscard]] static std::uint64_t HashKey(const Key& t_key) noexcept;
+
+    std::vector<std::uint32_t> m_slots; // unique vertex id per table slot, EMPTY when free
+    std::vector<Key>           m_keys;  // quantized key per unique vertex id
+    std::vector<std::uint32_t> m_remap; // unique vertex id per input vertex, EMPTY until first referenced
+  };
+}
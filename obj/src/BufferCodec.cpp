@@ -0,0 +1,314 @@
+#include "obj/BufferCodec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace obj
+{
+  namespace
+  {
+    constexpr size_t GROUP_SIZE = 16; // deltas sharing one bit width
+
+    // bit widths a group can be packed into, indexed by its 2-bit mode
+    constexpr std::array<unsigned int, 4> GROUP_BITS = {0, 2, 4, 8};
+
+    std::uint8_t ZigZag(const std::uint8_t t_delta) {
+      return static_cast<std::uint8_t>((t_delta << 1) ^ static_cast<std::uint8_t>(static_cast<std::int8_t>(t_delta) >> 7));
+    }
+
+    std::uint8_t UnZigZag(const std::uint8_t t_value) {
+      return static_cast<std::uint8_t>((t_value >> 1) ^ static_cast<std::uint8_t>(-(t_value & 1)));
+    }
+
+    [[noreturn]] void ThrowCorrupt(const char* t_what) {
+      throw std::runtime_error(std::string("Corrupt encoded ") + t_what);
+    }
+
+    // reads with a bounds check against the encoded input
+    class ByteReader
+    {
+    public:
+      explicit ByteReader(const std::span<const std::uint8_t> t_data, const char* t_what) : m_data(t_data), m_what(t_what) {}
+
+      const std::uint8_t* Take(const size_t t_size) {
+        if (t_size > m_data.size() - m_position) {
+          ThrowCorrupt(m_what);
+        }
+        const std::uint8_t* ptr = m_data.data() + m_position;
+        m_position += t_size;
+        return ptr;
+      }
+
+      [[nodiscard]] bool AtEnd() const { return m_position == m_data.size(); }
+
+    private:
+      std::span<const std::uint8_t> m_data;
+      const char*                   m_what;
+      size_t                        m_position = 0;
+    };
+
+    template <typename T>
+    std::vector<std::uint8_t> EncodeIndexDeltas(const std::span<const T> t_indices) {
+      std::vector<std::uint8_t> out;
+      out.reserve(t_indices.size() * 2);
+
+      std::int64_t previous = 0;
+      for (const T index : t_indices) {
+        const std::int64_t delta = static_cast<std::int64_t>(index) - previous;
+        previous                 = index;
+
+        auto value = static_cast<std::uint64_t>((delta << 1) ^ (delta >> 63));
+        while (value >= 0x80) {
+          out.push_back(static_cast<std::uint8_t>(value | 0x80));
+          value >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+      }
+
+      return out;
+    }
+
+    template <typename T>
+    void DecodeIndexDeltas(const std::span<const std::uint8_t> t_encoded, const std::span<T> t_indices) {
+      const std::uint8_t* ptr = t_encoded.data();
+      const std::uint8_t* end = ptr + t_encoded.size();
+
+      std::int64_t previous = 0;
+      for (T& index : t_indices) {
+        if (ptr == end) {
+          ThrowCorrupt("indices");
+        }
+
+        std::uint64_t value = *ptr++;
+
+        // most deltas fit into one byte, the loop only runs for jumps across the mesh
+        if (value >= 0x80) {
+          value &= 0x7f;
+          for (unsigned int shift = 7;; shift += 7) {
+            if (ptr == end || shift > 63) {
+              ThrowCorrupt("indices");
+            }
+            const std::uint8_t byte = *ptr++;
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (byte < 0x80) {
+              break;
+            }
+          }
+        }
+
+        previous += static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+        if (previous < 0 || static_cast<std::uint64_t>(previous) > std::numeric_limits<T>::max()) {
+          ThrowCorrupt("indices");
+        }
+        index = static_cast<T>(previous);
+      }
+
+      if (ptr != end) {
+        ThrowCorrupt("indices");
+      }
+    }
+  }
+
+  /*!
+   * @brief Encodes an array of trivially copyable vertices of any layout
+   * @param t_vertices First vertex
+   * @param t_count Number of vertices
+   * @param t_stride Size of one vertex in bytes
+   * @return Encoded bytes, decodable with the same count and stride
+   */
+  std::vector<std::uint8_t> BufferCodec::EncodeVertices(const void* t_vertices, const size_t t_count, const size_t t_stride) {
+    const auto* src = static_cast<const std::uint8_t*>(t_vertices);
+
+    std::vector<std::uint8_t> out;
+    out.reserve(t_count * t_stride / 2);
+
+    std::vector<std::uint8_t>                   previous(t_stride, 0);
+    std::array<std::uint8_t, VERTEX_BLOCK_SIZE> deltas{};
+
+    for (size_t first = 0; first < t_count; first += VERTEX_BLOCK_SIZE) {
+      const size_t count      = std::min(VERTEX_BLOCK_SIZE, t_count - first);
+      const size_t groupCount = (count + GROUP_SIZE - 1) / GROUP_SIZE;
+
+      for (size_t lane = 0; lane < t_stride; ++lane) {
+        deltas.fill(0);
+        for (size_t i = 0; i < count; ++i) {
+          const std::uint8_t byte = src[(first + i) * t_stride + lane];
+          deltas[i]               = ZigZag(static_cast<std::uint8_t>(byte - previous[lane]));
+          previous[lane]          = byte;
+        }
+
+        // four 2-bit modes per header byte, all headers of the lane come before its groups
+        const size_t header = out.size();
+        out.resize(out.size() + (groupCount + 3) / 4, 0);
+
+        for (size_t g = 0; g < groupCount; ++g) {
+          const std::uint8_t* group = deltas.data() + g * GROUP_SIZE;
+          const std::uint8_t  max   = *std::max_element(group, group + GROUP_SIZE);
+          const unsigned int  mode  = max == 0 ? 0 : max < 4 ? 1 : max < 16 ? 2 : 3;
+
+          out[header + g / 4] |= static_cast<std::uint8_t>(mode << (g % 4 * 2));
+
+          const unsigned int bits = GROUP_BITS[mode];
+          if (bits == 8) {
+            out.insert(out.end(), group, group + GROUP_SIZE);
+          }
+          else if (bits > 0) {
+            const unsigned int perByte = 8 / bits;
+            for (size_t i = 0; i < GROUP_SIZE; i += perByte) {
+              std::uint8_t packed = 0;
+              for (unsigned int j = 0; j < perByte; ++j) {
+                packed |= static_cast<std::uint8_t>(group[i + j] << (j * bits));
+              }
+              out.push_back(packed);
+            }
+          }
+        }
+      }
+    }
+
+    return out;
+  }
+
+  /*!
+   * @brief Decodes vertices written by EncodeVertices()
+   * @param t_encoded Encoded bytes, all of them have to be consumed
+   * @param t_vertices Destination of t_count vertices
+   * @param t_count Number of vertices that were encoded
+   * @param t_stride Size of one vertex in bytes, as encoded
+   */
+  void BufferCodec::DecodeVertices(const std::span<const std::uint8_t> t_encoded,
+                                   void* const                         t_vertices,
+                                   const size_t                        t_count,
+                                   const size_t                        t_stride) {
+    auto*      dst = static_cast<std::uint8_t*>(t_vertices);
+    ByteReader reader(t_encoded, "vertices");
+
+    std::vector<std::uint8_t>                   previous(t_stride, 0);
+    std::array<std::uint8_t, VERTEX_BLOCK_SIZE> deltas{};
+
+    for (size_t first = 0; first < t_count; first += VERTEX_BLOCK_SIZE) {
+      const size_t count      = std::min(VERTEX_BLOCK_SIZE, t_count - first);
+      const size_t groupCount = (count + GROUP_SIZE - 1) / GROUP_SIZE;
+
+      for (size_t lane = 0; lane < t_stride; ++lane) {
+        const std::uint8_t* header = reader.Take((groupCount + 3) / 4);
+
+        for (size_t g = 0; g < groupCount; ++g) {
+          std::uint8_t*      group = deltas.data() + g * GROUP_SIZE;
+          const unsigned int bits  = GROUP_BITS[(header[g / 4] >> (g % 4 * 2)) & 3];
+
+          if (bits == 0) {
+            std::fill_n(group, GROUP_SIZE, 0);
+          }
+          else if (bits == 8) {
+            std::memcpy(group, reader.Take(GROUP_SIZE), GROUP_SIZE);
+          }
+          else {
+            const unsigned int  perByte = 8 / bits;
+            const auto          mask    = static_cast<std::uint8_t>((1u << bits) - 1);
+            const std::uint8_t* packed  = reader.Take(GROUP_SIZE / perByte);
+            for (size_t i = 0; i < GROUP_SIZE; ++i) {
+              group[i] = (packed[i / perByte] >> (i % perByte * bits)) & mask;
+            }
+          }
+        }
+
+        std::uint8_t value = previous[lane];
+        for (size_t i = 0; i < count; ++i) {
+          value                              = static_cast<std::uint8_t>(value + UnZigZag(deltas[i]));
+          dst[(first + i) * t_stride + lane] = value;
+        }
+        previous[lane] = value;
+      }
+    }
+
+    if (!reader.AtEnd()) {
+      ThrowCorrupt("vertices");
+    }
+  }
+
+  std::vector<std::uint8_t> BufferCodec::EncodeIndices(const std::span<const unsigned int> t_indices) {
+    return EncodeIndexDeltas(t_indices);
+  }
+
+  std::vector<std::uint8_t> BufferCodec::EncodeIndices(const std::span<const std::uint16_t> t_indices) {
+    return EncodeIndexDeltas(t_indices);
+  }
+
+  void BufferCodec::DecodeIndices(const std::span<const std::uint8_t> t_encoded, const std::span<unsigned int> t_indices) {
+    DecodeIndexDeltas(t_encoded, t_indices);
+  }
+
+  void BufferCodec::DecodeIndices(const std::span<const std::uint8_t> t_encoded, const std::span<std::uint16_t> t_indices) {
+    DecodeIndexDeltas(t_encoded, t_indices);
+  }
+
+  /*!
+   * @brief Encodes the vertices and indices of a mesh, whichever of its containers hold them
+   * @param t_mesh Processed mesh, interleaved or split, with 32 or 16-bit indices
+   * @return Encoded buffers, the mesh itself is left as it is
+   */
+  EncodedMeshBuffers BufferCodec::EncodeMesh(const Mesh& t_mesh) {
+    EncodedMeshBuffers encoded;
+    encoded.split       = t_mesh.vertices.empty() && !t_mesh.positions.empty();
+    encoded.vertexCount = encoded.split ? t_mesh.positions.size() : t_mesh.vertices.size();
+
+    if (encoded.split) {
+      encoded.vertices   = EncodeVertices(t_mesh.positions);
+      encoded.attributes = EncodeVertices(t_mesh.attributes);
+    }
+    else {
+      encoded.vertices = EncodeVertices(t_mesh.vertices);
+    }
+
+    if (!t_mesh.indices16.empty()) {
+      encoded.indexSize  = 2;
+      encoded.indexCount = t_mesh.indices16.size();
+      encoded.indices    = EncodeIndices(std::span<const std::uint16_t>(t_mesh.indices16));
+    }
+    else {
+      encoded.indexCount = t_mesh.indices.size();
+      encoded.indices    = EncodeIndices(std::span<const unsigned int>(t_mesh.indices));
+    }
+
+    return encoded;
+  }
+
+  /*!
+   * @brief Decodes buffers written by EncodeMesh() back into the containers they came from
+   * @param t_encoded Encoded buffers of one mesh
+   * @param t_mesh Mesh to fill, its vertex and index containers are replaced
+   */
+  void BufferCodec::DecodeMesh(const EncodedMeshBuffers& t_encoded, Mesh& t_mesh) {
+    t_mesh.vertices.clear();
+    t_mesh.positions.clear();
+    t_mesh.attributes.clear();
+    t_mesh.indices.clear();
+    t_mesh.indices16.clear();
+
+    // every index takes at least a byte, which bounds what a corrupt count can make us allocate
+    if (t_encoded.indexCount > t_encoded.indices.size()) {
+      ThrowCorrupt("indices");
+    }
+
+    if (t_encoded.split) {
+      DecodeVertices(t_encoded.vertices, t_mesh.positions, t_encoded.vertexCount);
+      DecodeVertices(t_encoded.attributes, t_mesh.attributes, t_encoded.vertexCount);
+    }
+    else {
+      DecodeVertices(t_encoded.vertices, t_mesh.vertices, t_encoded.vertexCount);
+    }
+
+    if (t_encoded.indexSize == 2) {
+      t_mesh.indices16.resize(t_encoded.indexCount);
+      DecodeIndices(t_encoded.indices, std::span<std::uint16_t>(t_mesh.indices16));
+    }
+    else {
+      t_mesh.indices.resize(t_encoded.indexCount);
+      DecodeIndices(t_encoded.indices, std::span<unsigned int>(t_mesh.indices));
+    }
+  }
+}
@@ -0,0 +1,165 @@
+#include "obj/FileBuffer.hpp"
+
+#include "obj/ObjHelpers.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace obj
+{
+  FileBuffer::~FileBuffer() {
+    Release();
+  }
+
+  FileBuffer::FileBuffer(FileBuffer&& t_other) noexcept {
+    *this = std::move(t_other);
+  }
+
+  FileBuffer& FileBuffer::operator=(FileBuffer&& t_other) noexcept {
+    if (this == &t_other) {
+      return *this;
+    }
+
+    Release();
+
+    m_mapped = t_other.m_mapped;
+    m_size   = t_other.m_size;
+    m_buffer = std::move(t_other.m_buffer);
+    // small strings live inside the object, so an owned buffer has to be re-pointed after the move
+    m_data = m_mapped ? t_other.m_data : m_buffer.data();
+
+    t_other.m_data   = nullptr;
+    t_other.m_size   = 0;
+    t_other.m_mapped = false;
+
+    return *this;
+  }
+
+  /*!
+   * @brief Copies the whole file into an owned buffer using std::ifstream
+   * @param t_path Path to file including file extension
+   * @return Buffer owning a copy of the file contents
+   */
+  FileBuffer FileBuffer::Read(const std::filesystem::path& t_path) {
+    FileBuffer file;
+    file.m_buffer = ReadFileToBuffer(t_path);
+    file.m_data   = file.m_buffer.data();
+    file.m_size   = file.m_buffer.size();
+
+    return file;
+  }
+
+  /*!
+   * @brief Maps the whole file read-only into the address space, no copy of the contents is made
+   * @param t_path Path to file including file extension
+   * @return Buffer owning the mapping, which is released on destruction
+   */
+  FileBuffer FileBuffer::Map(const std::filesystem::path& t_path) {
+    FileBuffer file;
+
+#ifdef _WIN32
+    const HANDLE handle = CreateFileW(
+      t_path.c_str(),
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+      nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+      throw std::runtime_error("Failed to open file: " + t_path.string());
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+      CloseHandle(handle);
+      throw std::runtime_error("Failed to stat file: " + t_path.string());
+    }
+
+    // empty files can't be mapped, an empty view is all the parsers need
+    if (size.QuadPart == 0) {
+      CloseHandle(handle);
+      return file;
+    }
+
+    const HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // the mapping keeps its own reference to the file
+    CloseHandle(handle);
+    if (mapping == nullptr) {
+      throw std::runtime_error("Failed to map file: " + t_path.string());
+    }
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // the view keeps its own reference to the mapping
+    CloseHandle(mapping);
+    if (view == nullptr) {
+      throw std::runtime_error("Failed to map file: " + t_path.string());
+    }
+
+    file.m_size = static_cast<size_t>(size.QuadPart);
+#else
+    const int fd = open(t_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to open file: " + t_path.string());
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      throw std::runtime_error("Failed to stat file: " + t_path.string());
+    }
+
+    // empty files can't be mapped, an empty view is all the parsers need
+    if (st.st_size == 0) {
+      close(fd);
+      return file;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    close(fd);
+    if (view == MAP_FAILED) {
+      throw std::runtime_error("Failed to map file: " + t_path.string());
+    }
+
+    // parsers walk the file front to back, let the kernel read ahead aggressively
+    madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    file.m_size = static_cast<size_t>(st.st_size);
+#endif
+
+    file.m_data   = static_cast<const char*>(view);
+    file.m_mapped = true;
+
+    return file;
+  }
+
+  void FileBuffer::Release() noexcept {
+    if (m_mapped && m_data != nullptr) {
+#ifdef _WIN32
+      UnmapViewOfFile(m_data);
+#else
+      munmap(const_cast<char*>(m_data), m_size);
+#endif
+    }
+
+    m_buffer.clear();
+    m_data   = nullptr;
+    m_size   = 0;
+    m_mapped = false;
+  }
+}
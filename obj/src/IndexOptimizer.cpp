@@ -0,0 +1,345 @@
+#include "obj/IndexOptimizer.hpp"
+
+#include "obj/ObjHelpers.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/geometric.hpp>
+
+namespace obj
+{
+  // the three most recent vertices get a fixed score so the next triangle doesn't just reuse the last one's edge
+  const std::array<float, IndexOptimizer::CACHE_SIZE> IndexOptimizer::CACHE_SCORES = []
+  {
+    std::array<float, CACHE_SIZE> scores{};
+    for (unsigned int i = 0; i < CACHE_SIZE; ++i) {
+      scores[i] = i < 3 ? 0.75f : std::pow(1.0f - static_cast<float>(i - 3) / static_cast<float>(CACHE_SIZE - 3), 1.5f);
+    }
+    return scores;
+  }();
+
+  // vertices with few triangles left are boosted so they get finished off instead of leaving lone triangles behind
+  const std::array<float, IndexOptimizer::MAX_VALENCE> IndexOptimizer::VALENCE_SCORES = []
+  {
+    std::array<float, MAX_VALENCE> scores{};
+    for (unsigned int i = 1; i < MAX_VALENCE; ++i) {
+      scores[i] = 2.0f / std::sqrt(static_cast<float>(i));
+    }
+    return scores;
+  }();
+
+  /*!
+   * @brief Reorders the triangles of a mesh so consecutive triangles share as many vertices as possible, cutting the
+   * number of vertex shader invocations per triangle. Vertices are left untouched
+   * @param t_mesh Mesh whose indices are reordered in place
+   */
+  void IndexOptimizer::OptimizeVertexCache(Mesh& t_mesh) {
+    const auto triangleCount = static_cast<std::uint32_t>(t_mesh.indices.size() / 3);
+    const auto vertexCount   = static_cast<std::uint32_t>(t_mesh.vertices.size());
+
+    if (triangleCount == 0) {
+      return;
+    }
+
+    const Indices& indices = t_mesh.indices;
+
+    // triangle lists per vertex, laid out back to back
+    m_liveTriangles.assign(vertexCount, 0);
+    for (const auto idx : indices) {
+      ++m_liveTriangles[idx];
+    }
+
+    m_adjacencyOffsets.resize(vertexCount);
+    std::uint32_t offset = 0;
+    for (std::uint32_t v = 0; v < vertexCount; ++v) {
+      m_adjacencyOffsets[v] = offset;
+      offset += m_liveTriangles[v];
+    }
+
+    m_adjacency.resize(indices.size());
+    m_liveTriangles.assign(vertexCount, 0);
+    for (std::uint32_t t = 0; t < triangleCount; ++t) {
+      for (unsigned int c = 0; c < 3; ++c) {
+        const auto v = indices[t * 3 + c];
+        m_adjacency[m_adjacencyOffsets[v] + m_liveTriangles[v]++] = t;
+      }
+    }
+
+    m_cachePosition.assign(vertexCount, -1);
+    m_vertexScore.resize(vertexCount);
+    for (std::uint32_t v = 0; v < vertexCount; ++v) {
+      m_vertexScore[v] = VertexScore(v);
+    }
+
+    m_emitted.assign(triangleCount, 0);
+
+    std::uint32_t best      = EMPTY;
+    float         bestScore = -FLT_MAX;
+    for (std::uint32_t t = 0; t < triangleCount; ++t) {
+      const float score = TriangleScore(indices, t);
+      if (score > bestScore) {
+        best      = t;
+        bestScore = score;
+      }
+    }
+
+    Indices newIndices;
+    newIndices.reserve(indices.size());
+
+    std::array<std::uint32_t, CACHE_SIZE + 3> cache{};
+    std::array<std::uint32_t, CACHE_SIZE + 3> newCache{};
+    unsigned int                              cacheCount = 0;
+    std::uint32_t                             cursor     = 0; // every triangle before this one was emitted
+
+    while (newIndices.size() < indices.size()) {
+      // nothing in the cache has triangles left, restart from the first triangle not yet emitted
+      if (best == EMPTY) {
+        while (m_emitted[cursor]) {
+          ++cursor;
+        }
+        best = cursor;
+      }
+
+      const std::array triangle = {indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2]};
+      newIndices.insert(newIndices.end(), triangle.begin(), triangle.end());
+      m_emitted[best] = 1;
+
+      for (const auto v : triangle) {
+        // swap the emitted triangle out of the live part of the vertex's list
+        std::uint32_t* list = m_adjacency.data() + m_adjacencyOffsets[v];
+        std::uint32_t& live = m_liveTriangles[v];
+        std::swap(*std::find(list, list + live, best), list[live - 1]);
+        --live;
+      }
+
+      // the triangle's vertices move to the front, everything else shifts back
+      unsigned int newCount = 0;
+      for (const auto v : triangle) {
+        if (std::find(newCache.begin(), newCache.begin() + newCount, v) == newCache.begin() + newCount) {
+          newCache[newCount++] = v;
+        }
+      }
+      for (unsigned int i = 0; i < cacheCount; ++i) {
+        if (std::find(triangle.begin(), triangle.end(), cache[i]) == triangle.end()) {
+          newCache[newCount++] = cache[i];
+        }
+      }
+
+      for (unsigned int i = 0; i < newCount; ++i) {
+        m_cachePosition[newCache[i]] = i < CACHE_SIZE ? static_cast<std::int32_t>(i) : -1;
+        m_vertexScore[newCache[i]]   = VertexScore(newCache[i]);
+      }
+
+      // only triangles touching a vertex whose score just changed can become the next best
+      best      = EMPTY;
+      bestScore = 0.0f;
+      for (unsigned int i = 0; i < newCount; ++i) {
+        const std::uint32_t  v    = newCache[i];
+        const std::uint32_t* list = m_adjacency.data() + m_adjacencyOffsets[v];
+
+        for (std::uint32_t a = 0; a < m_liveTriangles[v]; ++a) {
+          const float score = TriangleScore(indices, list[a]);
+          if (score > bestScore) {
+            best      = list[a];
+            bestScore = score;
+          }
+        }
+      }
+
+      cacheCount = std::min(newCount, CACHE_SIZE);
+      std::swap(cache, newCache);
+    }
+
+    t_mesh.indices.swap(newIndices);
+    ReleaseScratch(vertexCount + triangleCount);
+  }
+
+  /*!
+   * @brief Splits the vertex cache ordered triangles into clusters and sorts them so the ones facing away from the
+   * mesh centre are drawn first, letting depth testing reject more of the fragments behind them.
+   * \n Clusters start wherever the cache is cold anyway, and are only split further where it costs no more than
+   * t_threshold times the cluster's own cache misses, so most of the vertex cache win is kept
+   * @param t_mesh Mesh whose indices are reordered in place, expected to be vertex cache optimized already
+   * @param t_threshold Allowed ratio of cache misses per triangle against the cache optimized order
+   */
+  void IndexOptimizer::OptimizeOverdraw(Mesh& t_mesh, const float t_threshold) {
+    const auto triangleCount = static_cast<std::uint32_t>(t_mesh.indices.size() / 3);
+
+    if (triangleCount == 0) {
+      return;
+    }
+
+    const Indices& indices = t_mesh.indices;
+
+    m_fifoTimestamps.assign(t_mesh.vertices.size(), 0);
+    m_fifoTime = FIFO_CACHE_SIZE + 1;
+    m_clusters.clear();
+
+    // hard boundaries, where a triangle misses on all three of its vertices
+    m_hardBoundaries.assign(1, 0);
+    (void)SimulateFifo(indices, 0);
+    for (std::uint32_t t = 1; t < triangleCount; ++t) {
+      if (SimulateFifo(indices, t) == 3) {
+        m_hardBoundaries.push_back(t);
+      }
+    }
+    m_hardBoundaries.push_back(triangleCount);
+
+    // soft boundaries inside each hard cluster, as soon as the running miss rate is close enough to the cluster's
+    for (size_t h = 0; h + 1 < m_hardBoundaries.size(); ++h) {
+      const std::uint32_t begin = m_hardBoundaries[h];
+      const std::uint32_t end   = m_hardBoundaries[h + 1];
+
+      ResetFifo();
+      unsigned int clusterMisses = 0;
+      for (std::uint32_t t = begin; t < end; ++t) {
+        clusterMisses += SimulateFifo(indices, t);
+      }
+      const float maxMissRate = t_threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+      ResetFifo();
+      std::uint32_t start  = begin;
+      unsigned int  misses = 0;
+      for (std::uint32_t t = begin; t < end; ++t) {
+        misses += SimulateFifo(indices, t);
+
+        if (t + 1 < end && static_cast<float>(misses) / static_cast<float>(t + 1 - start) <= maxMissRate) {
+          m_clusters.push_back({.begin = start, .end = t + 1});
+          start  = t + 1;
+          misses = 0;
+          ResetFifo();
+        }
+      }
+      m_clusters.push_back({.begin = start, .end = end});
+    }
+
+    // area weighted centroid and normal of every cluster
+    std::vector<std::pair<glm::vec3, glm::vec3>> clusterShapes(m_clusters.size());
+    glm::vec3                                    meshCentroid(0.0f);
+    float                                        meshArea = 0.0f;
+
+    for (size_t c = 0; c < m_clusters.size(); ++c) {
+      auto& [centroid, normal] = clusterShapes[c];
+      centroid                 = glm::vec3(0.0f);
+      normal                   = glm::vec3(0.0f);
+      float area               = 0.0f;
+
+      for (std::uint32_t t = m_clusters[c].begin; t < m_clusters[c].end; ++t) {
+        const glm::vec3& p0 = t_mesh.vertices[indices[t * 3]].position;
+        const glm::vec3& p1 = t_mesh.vertices[indices[t * 3 + 1]].position;
+        const glm::vec3& p2 = t_mesh.vertices[indices[t * 3 + 2]].position;
+
+        const glm::vec3 n = glm::cross(p1 - p0, p2 - p0); // length is twice the triangle area
+        const float     a = glm::length(n);
+
+        centroid += (p0 + p1 + p2) * (a / 3.0f);
+        normal += n;
+        area += a;
+      }
+
+      meshCentroid += centroid;
+      meshArea += area;
+      centroid = area > 0.0f ? centroid / area : t_mesh.vertices[indices[m_clusters[c].begin * 3]].position;
+    }
+
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : meshCentroid;
+
+    for (size_t c = 0; c < m_clusters.size(); ++c) {
+      const auto& [centroid, normal] = clusterShapes[c];
+      const float length             = glm::length(normal);
+      m_clusters[c].sortKey          = length > 0.0f ? glm::dot(centroid - meshCentroid, normal / length) : 0.0f;
+    }
+
+    std::ranges::stable_sort(m_clusters, std::ranges::greater{}, &Cluster::sortKey);
+
+    Indices newIndices;
+    newIndices.reserve(indices.size());
+    for (const auto& [begin, end, sortKey] : m_clusters) {
+      newIndices.insert(newIndices.end(), indices.begin() + begin * 3, indices.begin() + end * 3);
+    }
+
+    t_mesh.indices.swap(newIndices);
+    ReleaseScratch(t_mesh.vertices.size() + triangleCount);
+  }
+
+  /*!
+   * @brief Reorders the vertices of a mesh into the order the indices first reference them, so vertex fetches walk
+   * memory front to back. Vertices no index references are kept at the end
+   * @param t_mesh Mesh whose vertices are reordered and indices remapped in place
+   */
+  void IndexOptimizer::OptimizeVertexFetch(Mesh& t_mesh) {
+    const size_t vertexCount = t_mesh.vertices.size();
+
+    m_remap.assign(vertexCount, EMPTY);
+
+    std::vector<Vertex> newVertices;
+    newVertices.reserve(vertexCount);
+
+    for (auto& idx : t_mesh.indices) {
+      std::uint32_t& id = m_remap[idx];
+      if (id == EMPTY) {
+        id = static_cast<std::uint32_t>(newVertices.size());
+        newVertices.push_back(t_mesh.vertices[idx]);
+      }
+      idx = id;
+    }
+
+    // unreferenced vertices stay so the vertex count and every base offset remain valid
+    for (size_t v = 0; v < vertexCount; ++v) {
+      if (m_remap[v] == EMPTY) {
+        newVertices.push_back(t_mesh.vertices[v]);
+      }
+    }
+
+    t_mesh.vertices.swap(newVertices);
+    ReleaseScratch(vertexCount);
+  }
+
+  float IndexOptimizer::TriangleScore(const Indices& t_indices, const std::uint32_t t_triangle) const noexcept {
+    return m_vertexScore[t_indices[t_triangle * 3]] + m_vertexScore[t_indices[t_triangle * 3 + 1]] +
+           m_vertexScore[t_indices[t_triangle * 3 + 2]];
+  }
+
+  float IndexOptimizer::VertexScore(const std::uint32_t t_vertex) const noexcept {
+    const std::uint32_t live = m_liveTriangles[t_vertex];
+    if (live == 0) {
+      return -1.0f; // nothing left to draw with this vertex
+    }
+
+    const std::int32_t position = m_cachePosition[t_vertex];
+    return (position >= 0 ? CACHE_SCORES[position] : 0.0f) + VALENCE_SCORES[std::min(live, MAX_VALENCE - 1)];
+  }
+
+  /*!
+   * @brief Runs one triangle through a simulated FIFO cache
+   * @return Number of its vertices that missed the cache
+   */
+  unsigned int IndexOptimizer::SimulateFifo(const Indices& t_indices, const std::uint32_t t_triangle) {
+    unsigned int misses = 0;
+    for (unsigned int c = 0; c < 3; ++c) {
+      std::uint32_t& timestamp = m_fifoTimestamps[t_indices[t_triangle * 3 + c]];
+      if (m_fifoTime - timestamp > FIFO_CACHE_SIZE) {
+        timestamp = m_fifoTime++;
+        ++misses;
+      }
+    }
+    return misses;
+  }
+
+  void IndexOptimizer::ReleaseScratch(const size_t t_count) {
+    // don't let one huge mesh pin its scratch memory on this thread forever
+    if (t_count > MAX_RETAINED_COUNT) {
+      m_adjacencyOffsets = {};
+      m_adjacency        = {};
+      m_liveTriangles    = {};
+      m_cachePosition    = {};
+      m_vertexScore      = {};
+      m_emitted          = {};
+      m_fifoTimestamps   = {};
+      m_hardBoundaries   = {};
+      m_clusters         = {};
+      m_remap            = {};
+    }
+  }
+}
\ No newline at end of file
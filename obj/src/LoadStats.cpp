@@ -0,0 +1,102 @@
+#include "obj/LoadStats.hpp"
+
+#include <algorithm>
+#include <format>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+namespace obj
+{
+  std::string_view StageName(const Stage t_stage) {
+    switch (t_stage) {
+      case Stage::Io: return "Io";
+      case Stage::ParseMtl: return "ParseMtl";
+      case Stage::ParseObj: return "ParseObj";
+      case Stage::ConstructVertices: return "ConstructVertices";
+      case Stage::JoinIdentical: return "JoinIdentical";
+      case Stage::GenerateLods: return "GenerateLods";
+      case Stage::CalcTangentSpace: return "CalcTangentSpace";
+      case Stage::OptimizeIndices: return "OptimizeIndices";
+      case Stage::BuildMeshlets: return "BuildMeshlets";
+      case Stage::SplitStreams: return "SplitStreams";
+      case Stage::CombineMeshes: return "CombineMeshes";
+      case Stage::CompactIndices: return "CompactIndices";
+      case Stage::WriteBuffers: return "WriteBuffers";
+      case Stage::CacheRead: return "CacheRead";
+      case Stage::CacheWrite: return "CacheWrite";
+      default: return "Unknown";
+    }
+  }
+
+  /*!
+   * @brief Adds the stage times, bytes and counts of t_other, used to merge the stats of lods processed in parallel
+   */
+  LoadStats& LoadStats::operator+=(const LoadStats& t_other) {
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+      stages[i] += t_other.stages[i];
+    }
+
+    queueWait += t_other.queueWait;
+    total += t_other.total;
+    bytesRead += t_other.bytesRead;
+    cornerCount += t_other.cornerCount;
+    constructedVertexCount += t_other.constructedVertexCount;
+    weldedVertexCount += t_other.weldedVertexCount;
+    vertexCount += t_other.vertexCount;
+    indexCount += t_other.indexCount;
+    peakTempBytes = std::max(peakTempBytes, t_other.peakTempBytes);
+    fromCache     = fromCache && t_other.fromCache;
+    return *this;
+  }
+
+  /*!
+   * @brief Starts a trace file, truncating any existing one
+   * @param t_path File to write, conventionally with a .json extension
+   */
+  ChromeTrace::ChromeTrace(const std::filesystem::path& t_path) : m_file(t_path, std::ios::trunc) {
+    if (!m_file.is_open()) {
+      throw std::runtime_error(std::format("Failed to open trace file: {}", t_path.string()));
+    }
+    m_file << "[\n";
+  }
+
+  ChromeTrace::~ChromeTrace() {
+    m_file << "\n]\n";
+  }
+
+  /*!
+   * @brief Records one timed step on the calling thread
+   * @param t_name Event name, shown on the slice
+   * @param t_file Model the step belongs to, shown in the event's arguments
+   * @param t_start When the step started
+   * @param t_duration How long it took
+   */
+  void ChromeTrace::AddEvent(const std::string_view       t_name,
+                             const std::filesystem::path& t_file,
+                             const Timer::TimePoint       t_start,
+                             const LoadStats::Duration    t_duration) {
+    // json strings can't hold raw backslashes or quotes, which windows paths are full of
+    std::string file = t_file.generic_string();
+    for (size_t i = 0; i < file.size(); ++i) {
+      if (file[i] == '"' || file[i] == '\\') {
+        file.insert(i++, 1, '\\');
+      }
+    }
+
+    const auto   start    = std::chrono::duration<double, std::micro>(t_start - m_epoch).count();
+    const auto   duration = std::chrono::duration<double, std::micro>(t_duration).count();
+    const size_t threadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
+
+    std::lock_guard lock(m_mutex);
+    m_file << std::format(
+      R"({}{{"name":"{}","cat":"obj","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":1,"tid":{},"args":{{"file":"{}"}}}})",
+      m_first ? "" : ",\n",
+      t_name,
+      start,
+      duration,
+      threadId,
+      file);
+    m_first = false;
+  }
+}
\ No newline at end of file
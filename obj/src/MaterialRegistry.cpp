@@ -0,0 +1,114 @@
+#include "obj/MaterialRegistry.hpp"
+
+#include "obj/FileBuffer.hpp"
+
+#include <mutex>
+#include <stdexcept>
+
+namespace obj
+{
+  /*!
+   * @brief Returns the materials of an mtl, parsing it only if this registry hasn't seen the file as it is now
+   * \n The parse runs outside of the lock, two loads racing for the same new file may both parse it but only the
+   * first one's library is kept
+   * @param t_mtlPath Path to the mtl, any spelling of the same file shares one library
+   * @param t_bytesRead Increased by the size of the file if it had to be read
+   * @return Library shared with every other load of the same file
+   */
+  std::shared_ptr<const MaterialLibrary> MaterialRegistry::Load(const std::filesystem::path& t_mtlPath,
+                                                                std::uint64_t* const         t_bytesRead) {
+    const std::string key = std::filesystem::absolute(t_mtlPath).lexically_normal().generic_string();
+
+    std::error_code timeError;
+    std::error_code sizeError;
+    const auto      time = std::filesystem::last_write_time(t_mtlPath, timeError);
+    const auto      size = std::filesystem::file_size(t_mtlPath, sizeError);
+    const bool      stamped = !timeError && !sizeError;
+
+    {
+      std::shared_lock lock(m_mutex);
+      if (auto it = m_libraries.find(key); it != m_libraries.end() && stamped && it->second.time == time &&
+                                           it->second.size == size) {
+        return it->second.library;
+      }
+    }
+
+    const FileBuffer buffer = FileBuffer::Read(t_mtlPath);
+    if (t_bytesRead) {
+      *t_bytesRead += buffer.Size();
+    }
+
+    LoaderState state(Flag::None);
+    ParseMtl(state, buffer.View(), 0);
+
+    auto library = std::make_shared<MaterialLibrary>();
+
+    std::unique_lock lock(m_mutex);
+    if (auto it = m_libraries.find(key); it != m_libraries.end() && stamped && it->second.time == time &&
+                                         it->second.size == size) {
+      return it->second.library;
+    }
+
+    for (auto& material : state.materials[0]) {
+      std::string      name = material.name;
+      const MaterialId id   = Intern(std::move(material));
+
+      library->ids.push_back(id);
+      library->byName[std::move(name)] = id;
+    }
+
+    // a file without a stamp is parsed again by the next load, it may be mid-save
+    if (stamped) {
+      m_libraries[key] = {.time = time, .size = size, .library = library};
+    }
+    return library;
+  }
+
+  /*!
+   * @brief Returns a material by id, the reference stays valid for the life of the registry
+   */
+  const Material& MaterialRegistry::Get(const MaterialId t_id) const {
+    std::shared_lock lock(m_mutex);
+    if (t_id >= m_materials.size()) {
+      throw std::runtime_error("Invalid material id: " + std::to_string(t_id));
+    }
+    return m_materials[t_id];
+  }
+
+  size_t MaterialRegistry::MaterialCount() const {
+    std::shared_lock lock(m_mutex);
+    return m_materials.size();
+  }
+
+  size_t MaterialRegistry::LibraryCount() const {
+    std::shared_lock lock(m_mutex);
+    return m_libraries.size();
+  }
+
+  // every field joined, none of them can hold a line break
+  std::string MaterialRegistry::MaterialKey(const Material& t_material) {
+    std::string key;
+    key.reserve(t_material.name.size() + t_material.diffuseName.size() + t_material.specularName.size() +
+                t_material.normalName.size() + t_material.heightName.size() + 5);
+
+    for (const std::string* field : {&t_material.name, &t_material.diffuseName, &t_material.specularName,
+                                     &t_material.normalName, &t_material.heightName}) {
+      key += *field;
+      key += '\n';
+    }
+    return key;
+  }
+
+  // only called with the lock held exclusively
+  MaterialId MaterialRegistry::Intern(Material t_material) {
+    // tiling and index describe a mesh's use of a material, not the material
+    t_material.isTiled = false;
+    t_material.index   = 0;
+
+    const auto [it, inserted] = m_ids.try_emplace(MaterialKey(t_material), static_cast<MaterialId>(m_materials.size()));
+    if (inserted) {
+      m_materials.push_back(std::move(t_material));
+    }
+    return it->second;
+  }
+}
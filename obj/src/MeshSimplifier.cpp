@@ -0,0 +1,356 @@
+#include "obj/MeshSimplifier.hpp"
+
+#include "obj/ObjHelpers.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+#include <glm/geometric.hpp>
+
+namespace obj
+{
+  /*!
+   * @brief Collapses edges of the mesh, cheapest quadric error first, until it has at most t_targetIndexCount
+   * indices or no edge can be collapsed without breaking a seam, a border or the orientation of a triangle.
+   * \n Every pass only collapses edges whose neighbourhoods don't overlap, then the errors are re-evaluated
+   * @param t_mesh Welded mesh, simplified in place. Vertices no triangle references any more are removed
+   * @param t_targetIndexCount Index count to stop at
+   */
+  void MeshSimplifier::Simplify(Mesh& t_mesh, const size_t t_targetIndexCount) {
+    const size_t vertexCount = t_mesh.vertices.size();
+
+    if (t_mesh.indices.size() <= t_targetIndexCount || vertexCount == 0) {
+      return;
+    }
+
+    auto position = [&] (const std::uint32_t t_v) -> const glm::vec3& { return t_mesh.vertices[t_v].position; };
+
+    // degenerate triangles would only get in the way of the topology checks
+    m_indices.clear();
+    for (size_t t = 0; t + 2 < t_mesh.indices.size(); t += 3) {
+      const unsigned int a = t_mesh.indices[t], b = t_mesh.indices[t + 1], c = t_mesh.indices[t + 2];
+      if (a != b && b != c && a != c) {
+        m_indices.insert(m_indices.end(), {a, b, c});
+      }
+    }
+
+    LockSeamsAndBorders(t_mesh);
+
+    // area weighted plane quadrics of every triangle around a vertex
+    m_quadrics.assign(vertexCount, {});
+    for (size_t t = 0; t < m_indices.size(); t += 3) {
+      const glm::vec3& p0 = position(m_indices[t]);
+      const glm::vec3  n  = glm::cross(position(m_indices[t + 1]) - p0, position(m_indices[t + 2]) - p0);
+      const float      length = glm::length(n);
+
+      if (length > 0.0f) {
+        const glm::vec3 normal  = n / length;
+        const Quadric   quadric = Quadric::FromPlane(normal, -glm::dot(normal, p0), length * 0.5f);
+
+        for (size_t c = 0; c < 3; ++c) {
+          m_quadrics[m_indices[t + c]] += quadric;
+        }
+      }
+    }
+
+    m_remap.resize(vertexCount);
+
+    while (m_indices.size() > t_targetIndexCount) {
+      BuildAdjacency(vertexCount);
+
+      m_edges.clear();
+      for (size_t t = 0; t < m_indices.size(); t += 3) {
+        for (size_t c = 0; c < 3; ++c) {
+          const std::uint64_t a = m_indices[t + c];
+          const std::uint64_t b = m_indices[t + (c + 1) % 3];
+          m_edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+        }
+      }
+      std::ranges::sort(m_edges);
+      m_edges.erase(std::ranges::unique(m_edges).begin(), m_edges.end());
+
+      // both directions of every edge, as long as the vertex that moves isn't locked
+      m_collapses.clear();
+      for (const auto edge : m_edges) {
+        const auto a = static_cast<std::uint32_t>(edge >> 32);
+        const auto b = static_cast<std::uint32_t>(edge);
+
+        for (const auto& [from, to] : {std::pair{a, b}, std::pair{b, a}}) {
+          if (!m_locked[from]) {
+            Quadric quadric = m_quadrics[from];
+            quadric += m_quadrics[to];
+            m_collapses.push_back({.from = from, .to = to, .error = quadric.Error(position(to))});
+          }
+        }
+      }
+
+      if (m_collapses.empty()) {
+        break;
+      }
+
+      std::ranges::sort(m_collapses, {}, &Collapse::error);
+
+      // an interior collapse removes two triangles, don't overshoot the target by much
+      const size_t triangleCount = m_indices.size() / 3;
+      const size_t needed        = std::max<size_t>(1, (triangleCount - t_targetIndexCount / 3 + 1) / 2);
+      size_t       applied       = 0;
+
+      m_touched.assign(vertexCount, 0);
+      std::iota(m_remap.begin(), m_remap.end(), 0);
+
+      for (const auto& [from, to, error] : m_collapses) {
+        if (m_touched[from] || m_touched[to] || !IsCollapseValid(t_mesh, from, to)) {
+          continue;
+        }
+
+        m_remap[from] = to;
+        m_quadrics[to] += m_quadrics[from];
+
+        // every triangle around the moved vertex changes, keep other collapses of this pass away from all of them
+        for (std::uint32_t a = m_adjacencyOffsets[from]; a < m_adjacencyOffsets[from + 1]; ++a) {
+          const std::uint32_t t = m_adjacency[a];
+          m_touched[m_indices[t * 3]]     = 1;
+          m_touched[m_indices[t * 3 + 1]] = 1;
+          m_touched[m_indices[t * 3 + 2]] = 1;
+        }
+
+        if (++applied == needed) {
+          break;
+        }
+      }
+
+      if (applied == 0) {
+        break;
+      }
+
+      // move the collapsed vertices and drop the triangles that became degenerate
+      size_t write = 0;
+      for (size_t t = 0; t < m_indices.size(); t += 3) {
+        const unsigned int a = m_remap[m_indices[t]], b = m_remap[m_indices[t + 1]], c = m_remap[m_indices[t + 2]];
+        if (a != b && b != c && a != c) {
+          m_indices[write++] = a;
+          m_indices[write++] = b;
+          m_indices[write++] = c;
+        }
+      }
+      m_indices.resize(write);
+    }
+
+    // keep only the vertices that are still referenced, in first-use order
+    m_remap.assign(vertexCount, UINT32_MAX);
+
+    std::vector<Vertex> newVertices;
+    t_mesh.indices.resize(m_indices.size());
+
+    for (size_t i = 0; i < m_indices.size(); ++i) {
+      std::uint32_t& id = m_remap[m_indices[i]];
+      if (id == UINT32_MAX) {
+        id = static_cast<std::uint32_t>(newVertices.size());
+        newVertices.push_back(t_mesh.vertices[m_indices[i]]);
+      }
+      t_mesh.indices[i] = id;
+    }
+
+    t_mesh.vertices.swap(newVertices);
+    ReleaseScratch(vertexCount);
+  }
+
+  /*!
+   * @brief Locks every vertex that shares its position with another vertex, which is where uv and normal seams split
+   * a welded mesh, and every vertex of an edge that isn't shared by exactly two triangles
+   */
+  void MeshSimplifier::LockSeamsAndBorders(const Mesh& t_mesh) {
+    const size_t vertexCount = t_mesh.vertices.size();
+
+    m_locked.assign(vertexCount, 0);
+
+    m_sorted.resize(vertexCount);
+    std::iota(m_sorted.begin(), m_sorted.end(), 0);
+    std::ranges::sort(m_sorted,
+                      [&] (const std::uint32_t t_a, const std::uint32_t t_b)
+                      {
+                        const glm::vec3& a = t_mesh.vertices[t_a].position;
+                        const glm::vec3& b = t_mesh.vertices[t_b].position;
+                        return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+                      });
+
+    for (size_t i = 1; i < vertexCount; ++i) {
+      if (t_mesh.vertices[m_sorted[i]].position == t_mesh.vertices[m_sorted[i - 1]].position) {
+        m_locked[m_sorted[i]]     = 1;
+        m_locked[m_sorted[i - 1]] = 1;
+      }
+    }
+
+    m_edges.clear();
+    for (size_t t = 0; t < m_indices.size(); t += 3) {
+      for (size_t c = 0; c < 3; ++c) {
+        const std::uint64_t a = m_indices[t + c];
+        const std::uint64_t b = m_indices[t + (c + 1) % 3];
+        m_edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+      }
+    }
+    std::ranges::sort(m_edges);
+
+    for (size_t i = 0; i < m_edges.size();) {
+      size_t end = i + 1;
+      while (end < m_edges.size() && m_edges[end] == m_edges[i]) {
+        ++end;
+      }
+
+      if (end - i != 2) {
+        m_locked[m_edges[i] >> 32]                       = 1;
+        m_locked[static_cast<std::uint32_t>(m_edges[i])] = 1;
+      }
+      i = end;
+    }
+  }
+
+  void MeshSimplifier::BuildAdjacency(const size_t t_vertexCount) {
+    m_adjacencyOffsets.assign(t_vertexCount + 1, 0);
+    for (const auto idx : m_indices) {
+      ++m_adjacencyOffsets[idx];
+    }
+
+    std::uint32_t offset = 0;
+    for (size_t v = 0; v <= t_vertexCount; ++v) {
+      const std::uint32_t count = m_adjacencyOffsets[v];
+      m_adjacencyOffsets[v]     = offset;
+      offset += count;
+    }
+
+    // filling advances every offset to the start of the next vertex, shift them back afterwards
+    m_adjacency.resize(m_indices.size());
+    for (size_t i = 0; i < m_indices.size(); ++i) {
+      m_adjacency[m_adjacencyOffsets[m_indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+    }
+    for (size_t v = t_vertexCount; v > 0; --v) {
+      m_adjacencyOffsets[v] = m_adjacencyOffsets[v - 1];
+    }
+    m_adjacencyOffsets[0] = 0;
+  }
+
+  /*!
+   * @brief Checks that moving t_from onto t_to keeps the surface manifold and doesn't fold any triangle over
+   */
+  bool MeshSimplifier::IsCollapseValid(const Mesh& t_mesh, const std::uint32_t t_from, const std::uint32_t t_to) {
+    // link condition, the two vertices may only share the neighbours on either side of their edge
+    auto gatherRing = [&] (const std::uint32_t t_v)
+    {
+      const auto begin = static_cast<std::ptrdiff_t>(m_neighbours.size());
+      for (std::uint32_t a = m_adjacencyOffsets[t_v]; a < m_adjacencyOffsets[t_v + 1]; ++a) {
+        const std::uint32_t t = m_adjacency[a];
+        m_neighbours.insert(m_neighbours.end(), {m_indices[t * 3], m_indices[t * 3 + 1], m_indices[t * 3 + 2]});
+      }
+      std::sort(m_neighbours.begin() + begin, m_neighbours.end());
+      m_neighbours.erase(std::unique(m_neighbours.begin() + begin, m_neighbours.end()), m_neighbours.end());
+      return begin;
+    };
+
+    m_neighbours.clear();
+    gatherRing(t_from);
+    const auto toBegin = gatherRing(t_to);
+
+    // both rings contain both vertices themselves, on top of the two shared neighbours
+    auto         from   = m_neighbours.begin();
+    auto         to     = m_neighbours.begin() + toBegin;
+    const auto   split  = to;
+    unsigned int shared = 0;
+
+    while (from != split && to != m_neighbours.end()) {
+      if (*from < *to) {
+        ++from;
+      }
+      else if (*to < *from) {
+        ++to;
+      }
+      else {
+        if (++shared > 4) {
+          return false;
+        }
+        ++from;
+        ++to;
+      }
+    }
+
+    // every triangle that survives the collapse has to keep facing the same way
+    const glm::vec3& target = t_mesh.vertices[t_to].position;
+
+    for (std::uint32_t a = m_adjacencyOffsets[t_from]; a < m_adjacencyOffsets[t_from + 1]; ++a) {
+      const std::uint32_t t       = m_adjacency[a];
+      const unsigned int* corners = &m_indices[t * 3];
+
+      if (corners[0] == t_to || corners[1] == t_to || corners[2] == t_to) {
+        continue; // collapses to nothing
+      }
+
+      std::array<glm::vec3, 3> before{};
+      std::array<glm::vec3, 3> after{};
+      for (size_t c = 0; c < 3; ++c) {
+        before[c] = t_mesh.vertices[corners[c]].position;
+        after[c]  = corners[c] == t_from ? target : before[c];
+      }
+
+      const glm::vec3 oldNormal = glm::cross(before[1] - before[0], before[2] - before[0]);
+      const glm::vec3 newNormal = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+      if (glm::dot(oldNormal, newNormal) <= 0.0f) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  void MeshSimplifier::ReleaseScratch(const size_t t_count) {
+    // don't let one huge mesh pin its scratch memory on this thread forever
+    if (t_count > MAX_RETAINED_COUNT) {
+      m_indices          = {};
+      m_quadrics         = {};
+      m_locked           = {};
+      m_touched          = {};
+      m_adjacencyOffsets = {};
+      m_adjacency        = {};
+      m_sorted           = {};
+      m_edges            = {};
+      m_neighbours       = {};
+      m_collapses        = {};
+      m_remap            = {};
+    }
+  }
+
+  MeshSimplifier::Quadric MeshSimplifier::Quadric::FromPlane(const glm::vec3& t_normal,
+                                                             const float      t_distance,
+                                                             const float      t_weight) noexcept {
+    const glm::vec3 n = t_normal;
+    return {
+      .a00 = t_weight * n.x * n.x, .a11 = t_weight * n.y * n.y, .a22 = t_weight * n.z * n.z,
+      .a01 = t_weight * n.x * n.y, .a02 = t_weight * n.x * n.z, .a12 = t_weight * n.y * n.z,
+      .b0 = t_weight * n.x * t_distance, .b1 = t_weight * n.y * t_distance, .b2 = t_weight * n.z * t_distance,
+      .c = t_weight * t_distance * t_distance
+    };
+  }
+
+  // squared distance to every accumulated plane, weighted by triangle area
+  float MeshSimplifier::Quadric::Error(const glm::vec3& t_position) const noexcept {
+    const float x = t_position.x, y = t_position.y, z = t_position.z;
+
+    const float error = a00 * x * x + a11 * y * y + a22 * z * z + 2.0f * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                        2.0f * (b0 * x + b1 * y + b2 * z) + c;
+    return std::abs(error);
+  }
+
+  MeshSimplifier::Quadric& MeshSimplifier::Quadric::operator+=(const Quadric& t_other) noexcept {
+    a00 += t_other.a00;
+    a11 += t_other.a11;
+    a22 += t_other.a22;
+    a01 += t_other.a01;
+    a02 += t_other.a02;
+    a12 += t_other.a12;
+    b0 += t_other.b0;
+    b1 += t_other.b1;
+    b2 += t_other.b2;
+    c += t_other.c;
+    return *this;
+  }
+}
\ No newline at end of file
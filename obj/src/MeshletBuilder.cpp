@@ -0,0 +1,157 @@
+#include "obj/MeshletBuilder.hpp"
+
+#include "obj/ObjHelpers.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include <glm/geometric.hpp>
+
+namespace obj
+{
+  /*!
+   * @brief Fills the meshlets, meshletVertices and meshletTriangles of a mesh from its indices, leaving them untouched
+   * @param t_mesh Mesh to partition
+   */
+  void MeshletBuilder::Build(Mesh& t_mesh) {
+    static_assert(MAX_VERTICES < NOT_LOCAL, "local indices have to fit a byte");
+
+    t_mesh.meshlets.clear();
+    t_mesh.meshletVertices.clear();
+    t_mesh.meshletTriangles.clear();
+
+    const size_t triangleCount = t_mesh.indices.size() / 3;
+    if (triangleCount == 0) {
+      return;
+    }
+
+    // worst case is one meshlet per MAX_TRIANGLES, every triangle bringing three new vertices
+    t_mesh.meshlets.reserve((triangleCount + MAX_TRIANGLES - 1) / MAX_TRIANGLES);
+    t_mesh.meshletVertices.reserve(std::min(t_mesh.indices.size(), t_mesh.vertices.size() * 2));
+    t_mesh.meshletTriangles.reserve(t_mesh.indices.size());
+
+    m_localIndex.assign(t_mesh.vertices.size(), NOT_LOCAL);
+
+    Meshlet meshlet{};
+
+    auto close = [&]
+    {
+      ComputeBounds(t_mesh, meshlet);
+      t_mesh.meshlets.push_back(meshlet);
+
+      for (std::uint32_t v = meshlet.vertexOffset; v < meshlet.vertexOffset + meshlet.vertexCount; ++v) {
+        m_localIndex[t_mesh.meshletVertices[v]] = NOT_LOCAL;
+      }
+
+      meshlet                = {};
+      meshlet.vertexOffset   = static_cast<std::uint32_t>(t_mesh.meshletVertices.size());
+      meshlet.triangleOffset = static_cast<std::uint32_t>(t_mesh.meshletTriangles.size());
+    };
+
+    for (size_t t = 0; t < triangleCount; ++t) {
+      const unsigned int* corners = &t_mesh.indices[t * 3];
+
+      unsigned int newVertices = 0;
+      for (size_t c = 0; c < 3; ++c) {
+        newVertices += m_localIndex[corners[c]] == NOT_LOCAL;
+      }
+
+      if (meshlet.vertexCount + newVertices > MAX_VERTICES || meshlet.triangleCount == MAX_TRIANGLES) {
+        close();
+      }
+
+      for (size_t c = 0; c < 3; ++c) {
+        std::uint8_t& local = m_localIndex[corners[c]];
+        if (local == NOT_LOCAL) {
+          local = static_cast<std::uint8_t>(meshlet.vertexCount++);
+          t_mesh.meshletVertices.push_back(corners[c]);
+        }
+        t_mesh.meshletTriangles.push_back(local);
+      }
+
+      ++meshlet.triangleCount;
+    }
+
+    close();
+
+    // don't let one huge mesh pin its scratch memory on this thread forever
+    if (m_localIndex.size() > MAX_RETAINED_COUNT) {
+      m_localIndex = {};
+    }
+  }
+
+  /*!
+   * @brief Calculates the bounding sphere and the backface culling cone of a meshlet
+   * \n Meshlets whose triangles face more than 90 degrees apart get a cone that never culls
+   */
+  void MeshletBuilder::ComputeBounds(const Mesh& t_mesh, Meshlet& t_meshlet) {
+    auto position = [&] (const std::uint32_t t_local) -> const glm::vec3&
+    {
+      return t_mesh.vertices[t_mesh.meshletVertices[t_meshlet.vertexOffset + t_local]].position;
+    };
+    const std::uint8_t* triangles = &t_mesh.meshletTriangles[t_meshlet.triangleOffset];
+
+    // sphere around the box centre, not minimal but cheap and conservative
+    glm::vec3 min(FLT_MAX);
+    glm::vec3 max(-FLT_MAX);
+    for (std::uint32_t v = 0; v < t_meshlet.vertexCount; ++v) {
+      min = glm::min(min, position(v));
+      max = glm::max(max, position(v));
+    }
+
+    t_meshlet.center = (min + max) * 0.5f;
+    t_meshlet.radius = 0.0f;
+    for (std::uint32_t v = 0; v < t_meshlet.vertexCount; ++v) {
+      t_meshlet.radius = std::max(t_meshlet.radius, glm::length(position(v) - t_meshlet.center));
+    }
+
+    // cone axis is the average face normal, the cutoff comes from the normal furthest away from it
+    std::array<glm::vec3, MAX_TRIANGLES> normals{};
+    glm::vec3                            axis(0.0f);
+
+    for (std::uint32_t t = 0; t < t_meshlet.triangleCount; ++t) {
+      const glm::vec3& p0 = position(triangles[t * 3]);
+      const glm::vec3  n  = glm::cross(position(triangles[t * 3 + 1]) - p0, position(triangles[t * 3 + 2]) - p0);
+      const float      length = glm::length(n);
+
+      if (length > 0.0f) {
+        normals[t] = n / length;
+        axis += normals[t];
+      }
+    }
+
+    const float axisLength = glm::length(axis);
+
+    t_meshlet.coneApex   = t_meshlet.center;
+    t_meshlet.coneAxis   = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+    t_meshlet.coneCutoff = 1.0f; // never culls
+
+    if (axisLength == 0.0f) {
+      return;
+    }
+
+    float minDot = 1.0f;
+    for (std::uint32_t t = 0; t < t_meshlet.triangleCount; ++t) {
+      if (normals[t] != glm::vec3(0.0f)) {
+        minDot = std::min(minDot, glm::dot(normals[t], t_meshlet.coneAxis));
+      }
+    }
+
+    if (minDot <= 0.0f) {
+      return;
+    }
+
+    // move the apex back until every triangle plane lies in front of it, so the test holds from any eye position
+    float maxT = 0.0f;
+    for (std::uint32_t t = 0; t < t_meshlet.triangleCount; ++t) {
+      const float dn = glm::dot(normals[t], t_meshlet.coneAxis);
+      if (dn > 0.0f) {
+        const glm::vec3& p0 = position(triangles[t * 3]);
+        maxT = std::max(maxT, glm::dot(t_meshlet.center - p0, normals[t]) / dn);
+      }
+    }
+
+    t_meshlet.coneApex   = t_meshlet.center - t_meshlet.coneAxis * maxT;
+    t_meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+  }
+}
\ No newline at end of file
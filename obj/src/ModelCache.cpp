@@ -0,0 +1,369 @@
+#include "obj/ModelCache.hpp"
+
+#include "obj/BufferCodec.hpp"
+#include "obj/FileBuffer.hpp"
+#include "obj/ObjHelpers.hpp"
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace obj
+{
+  namespace
+  {
+    constexpr char          CACHE_MAGIC[4]  = {'O', 'B', 'J', 'C'};
+    constexpr std::uint64_t ARRAY_ALIGNMENT = 16; // vertex and index arrays start on this boundary inside the file
+
+    // only these flags change what ends up in the Model, the rest are I/O or scheduling choices
+    constexpr auto OUTPUT_FLAGS = static_cast<std::uint32_t>(
+      Flag::CalculateTangents | Flag::JoinIdentical | Flag::CombineMeshes | Flag::Lods | Flag::JoinIndices |
+      Flag::SplitStreams | Flag::OptimizeVertexCache | Flag::OptimizeOverdraw | Flag::GenerateLods |
+      Flag::BuildMeshlets | Flag::SharedMaterials | Flag::CompactIndices);
+
+    std::uint64_t Fnv1a(const std::string_view t_bytes) {
+      std::uint64_t hash = 0xcbf29ce484222325;
+      for (const char c : t_bytes) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3;
+      }
+      return hash;
+    }
+
+    class BinaryWriter
+    {
+    public:
+      explicit BinaryWriter(std::ostream& t_out) : m_out(t_out) {}
+
+      template <typename T>
+      void Write(const T& t_value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        WriteBytes(&t_value, sizeof(T));
+      }
+
+      void WriteString(const std::string_view t_string) {
+        Write(static_cast<std::uint32_t>(t_string.size()));
+        WriteBytes(t_string.data(), t_string.size());
+      }
+
+      template <typename T>
+      void WriteArray(const std::vector<T>& t_array) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Write(static_cast<std::uint64_t>(t_array.size()));
+        Align();
+        WriteBytes(t_array.data(), t_array.size() * sizeof(T));
+      }
+
+    private:
+      void WriteBytes(const void* t_data, const size_t t_size) {
+        m_out.write(static_cast<const char*>(t_data), static_cast<std::streamsize>(t_size));
+        m_position += t_size;
+      }
+
+      void Align() {
+        constexpr char padding[ARRAY_ALIGNMENT] = {};
+        WriteBytes(padding, (ARRAY_ALIGNMENT - m_position % ARRAY_ALIGNMENT) % ARRAY_ALIGNMENT);
+      }
+
+      std::ostream& m_out;
+      std::uint64_t m_position = 0;
+    };
+
+    // bounds-checked reads over a mapped cache file, any overrun means the file is truncated or corrupt
+    class BinaryReader
+    {
+    public:
+      explicit BinaryReader(const std::string_view t_data) : m_data(t_data) {}
+
+      template <typename T>
+      T Read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+        return value;
+      }
+
+      std::string_view ReadString() {
+        const auto size = Read<std::uint32_t>();
+        return {Take(size), size};
+      }
+
+      template <typename T>
+      void ReadArray(std::vector<T>& t_array) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto size = Read<std::uint64_t>();
+        Take((ARRAY_ALIGNMENT - m_position % ARRAY_ALIGNMENT) % ARRAY_ALIGNMENT);
+
+        if (size > (m_data.size() - m_position) / sizeof(T)) {
+          throw std::runtime_error("Model cache is truncated");
+        }
+
+        // one bulk copy straight out of the mapping, no per-element work
+        t_array.resize(size);
+        if (size > 0) {
+          std::memcpy(t_array.data(), Take(size * sizeof(T)), size * sizeof(T));
+        }
+      }
+
+    private:
+      const char* Take(const size_t t_size) {
+        if (t_size > m_data.size() - m_position) {
+          throw std::runtime_error("Model cache is truncated");
+        }
+        const char* ptr = m_data.data() + m_position;
+        m_position += t_size;
+        return ptr;
+      }
+
+      std::string_view m_data;
+      size_t           m_position = 0;
+    };
+
+    /*!
+     * @brief Builds the bytes that identify a processed model: its path, the output flags and the size and write time
+     * of every obj and mtl it was built from. A cache entry is only valid if its stored key matches byte for byte
+     */
+    std::string BuildCacheKey(const LoaderState& t_state) {
+      std::ostringstream key;
+      BinaryWriter       writer(key);
+
+      writer.WriteString(std::filesystem::absolute(t_state.path).generic_string());
+      writer.Write(static_cast<std::uint32_t>(t_state.flags) & OUTPUT_FLAGS);
+
+      // generated lods depend on the ratios too
+      if ((t_state.flags & Flag::GenerateLods) == Flag::GenerateLods) {
+        writer.Write(static_cast<std::uint32_t>(t_state.lodRatios.size()));
+        for (const float ratio : t_state.lodRatios) {
+          writer.Write(ratio);
+        }
+      }
+
+      writer.Write(static_cast<std::uint32_t>(t_state.filePaths.size()));
+
+      for (const auto& [objPath, mtlPath, lodLevel] : t_state.filePaths) {
+        writer.Write(lodLevel);
+
+        for (const auto& path : {objPath, mtlPath}) {
+          // missing files are part of the key too, creating one later invalidates the entry
+          std::error_code ec;
+          const auto      size = std::filesystem::file_size(path, ec);
+          const auto      time = std::filesystem::last_write_time(path, ec);
+
+          writer.WriteString(path.generic_string());
+          writer.Write(static_cast<std::uint64_t>(ec ? 0 : size));
+          writer.Write(static_cast<std::int64_t>(ec ? 0 : time.time_since_epoch().count()));
+        }
+      }
+
+      return key.str();
+    }
+
+    void WriteMesh(BinaryWriter& t_writer, const Mesh& t_mesh, const bool t_compressed) {
+      t_writer.WriteString(t_mesh.name);
+      t_writer.WriteString(t_mesh.material.name);
+      t_writer.WriteString(t_mesh.material.diffuseName);
+      t_writer.WriteString(t_mesh.material.specularName);
+      t_writer.WriteString(t_mesh.material.normalName);
+      t_writer.WriteString(t_mesh.material.heightName);
+      t_writer.Write(static_cast<std::uint8_t>(t_mesh.material.isTiled));
+      t_writer.Write(t_mesh.material.index);
+      t_writer.Write(t_mesh.lodLevel);
+      t_writer.Write(t_mesh.meshNumber);
+      t_writer.Write(static_cast<std::uint64_t>(t_mesh.baseVertex));
+      t_writer.Write(static_cast<std::uint64_t>(t_mesh.baseIndex));
+
+      if (t_compressed) {
+        const EncodedMeshBuffers encoded = BufferCodec::EncodeMesh(t_mesh);
+        t_writer.Write(encoded.vertexCount);
+        t_writer.Write(encoded.indexCount);
+        t_writer.Write(encoded.indexSize);
+        t_writer.Write(static_cast<std::uint8_t>(encoded.split));
+        t_writer.WriteArray(encoded.vertices);
+        t_writer.WriteArray(encoded.attributes);
+        t_writer.WriteArray(encoded.indices);
+      }
+      else {
+        t_writer.WriteArray(t_mesh.vertices);
+        t_writer.WriteArray(t_mesh.indices);
+        t_writer.WriteArray(t_mesh.indices16);
+        t_writer.WriteArray(t_mesh.positions);
+        t_writer.WriteArray(t_mesh.attributes);
+      }
+
+      t_writer.WriteArray(t_mesh.meshlets);
+      t_writer.WriteArray(t_mesh.meshletVertices);
+      t_writer.WriteArray(t_mesh.meshletTriangles);
+      t_writer.WriteArray(t_mesh.drawRanges);
+    }
+
+    Mesh ReadMesh(BinaryReader& t_reader, const bool t_compressed) {
+      Mesh mesh;
+      mesh.name                  = t_reader.ReadString();
+      mesh.material.name         = t_reader.ReadString();
+      mesh.material.diffuseName  = t_reader.ReadString();
+      mesh.material.specularName = t_reader.ReadString();
+      mesh.material.normalName   = t_reader.ReadString();
+      mesh.material.heightName   = t_reader.ReadString();
+      mesh.material.isTiled      = t_reader.Read<std::uint8_t>() != 0;
+      mesh.material.index        = t_reader.Read<unsigned int>();
+      mesh.lodLevel              = t_reader.Read<unsigned int>();
+      mesh.meshNumber            = t_reader.Read<int>();
+      mesh.baseVertex            = t_reader.Read<std::uint64_t>();
+      mesh.baseIndex             = t_reader.Read<std::uint64_t>();
+
+      if (t_compressed) {
+        EncodedMeshBuffers encoded;
+        encoded.vertexCount = t_reader.Read<std::uint64_t>();
+        encoded.indexCount  = t_reader.Read<std::uint64_t>();
+        encoded.indexSize   = t_reader.Read<std::uint8_t>();
+        encoded.split       = t_reader.Read<std::uint8_t>() != 0;
+        t_reader.ReadArray(encoded.vertices);
+        t_reader.ReadArray(encoded.attributes);
+        t_reader.ReadArray(encoded.indices);
+        BufferCodec::DecodeMesh(encoded, mesh);
+      }
+      else {
+        t_reader.ReadArray(mesh.vertices);
+        t_reader.ReadArray(mesh.indices);
+        t_reader.ReadArray(mesh.indices16);
+        t_reader.ReadArray(mesh.positions);
+        t_reader.ReadArray(mesh.attributes);
+      }
+
+      t_reader.ReadArray(mesh.meshlets);
+      t_reader.ReadArray(mesh.meshletVertices);
+      t_reader.ReadArray(mesh.meshletTriangles);
+      t_reader.ReadArray(mesh.drawRanges);
+      return mesh;
+    }
+  }
+
+  /*!
+   * @brief Returns where the cache entry for this load lives and the key it has to match
+   * @param t_state Internal state data with the model path, flags, file paths and cache directory
+   * @return Cache file path, which may not exist yet, and key
+   */
+  ModelCacheEntry GetModelCacheEntry(const LoaderState& t_state) {
+    const std::string name = std::filesystem::absolute(t_state.path).generic_string() + '|' + std::to_string(
+                               static_cast<std::uint32_t>(t_state.flags) & OUTPUT_FLAGS);
+
+    return {
+      .path = t_state.cacheDirectory / std::format("{}_{:016x}.objcache", t_state.path.stem().string(), Fnv1a(name)),
+      .key = BuildCacheKey(t_state),
+      .compressed = (t_state.flags & Flag::CompressCache) == Flag::CompressCache
+    };
+  }
+
+  /*!
+   * @brief Memory-maps the cache entry for this load and fills the state's final meshes straight from it if the
+   * entry is still valid for the current source files and flags
+   * @param t_entry Cache file and key of this load
+   * @param t_state Internal state data, its meshes and combinedMeshes are filled on a hit
+   * @return True on a cache hit, false if there is no entry or it is stale, truncated or from another version
+   */
+  bool ReadModelCache(const ModelCacheEntry& t_entry, LoaderState& t_state) {
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(t_entry.path, ec)) {
+      return false;
+    }
+
+    try {
+      const FileBuffer file = FileBuffer::Map(t_entry.path);
+      BinaryReader     reader(file.View());
+
+      if (reader.ReadString() != std::string_view(CACHE_MAGIC, sizeof(CACHE_MAGIC)) ||
+          reader.Read<std::uint32_t>() != MODEL_CACHE_VERSION ||
+          reader.Read<std::uint32_t>() != sizeof(Vertex) ||
+          reader.ReadString() != t_entry.key) {
+        return false;
+      }
+
+      // whoever wrote the entry chose the encoding, any load can read either
+      const bool compressed = reader.Read<std::uint8_t>() != 0;
+
+      std::map<unsigned int, std::vector<Mesh>> meshes;
+      std::vector<Mesh>                         combinedMeshes;
+
+      const auto lodCount = reader.Read<std::uint32_t>();
+      for (std::uint32_t i = 0; i < lodCount; ++i) {
+        const auto lodLevel  = reader.Read<unsigned int>();
+        const auto meshCount = reader.Read<std::uint32_t>();
+
+        std::vector<Mesh>& lod = meshes[lodLevel];
+        lod.reserve(meshCount);
+        for (std::uint32_t m = 0; m < meshCount; ++m) {
+          lod.push_back(ReadMesh(reader, compressed));
+        }
+      }
+
+      const auto combinedCount = reader.Read<std::uint32_t>();
+      combinedMeshes.reserve(combinedCount);
+      for (std::uint32_t i = 0; i < combinedCount; ++i) {
+        combinedMeshes.push_back(ReadMesh(reader, compressed));
+      }
+
+      // only touch the state once the whole entry was read successfully
+      t_state.meshes         = std::move(meshes);
+      t_state.combinedMeshes = std::move(combinedMeshes);
+      return true;
+    }
+    catch (const std::exception&) {
+      return false; // unreadable entries are simply rebuilt
+    }
+  }
+
+  /*!
+   * @brief Writes the processed model to its cache entry, through a temporary file so readers never see a partial entry
+   * @param t_entry Cache file and key of this load
+   * @param t_model Final processed model
+   */
+  void WriteModelCache(const ModelCacheEntry& t_entry, const Model& t_model) {
+    const auto& cachePath = t_entry.path;
+
+    std::filesystem::create_directories(cachePath.parent_path());
+
+    // unique per thread so concurrent loads of the same model don't write into the same temporary file
+    std::ostringstream id;
+    id << std::this_thread::get_id();
+    auto tempPath = cachePath;
+    tempPath += "." + id.str() + ".tmp";
+
+    {
+      std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+      if (!out.is_open()) {
+        throw std::runtime_error("Failed to open cache file: " + tempPath.string());
+      }
+
+      BinaryWriter writer(out);
+      writer.WriteString({CACHE_MAGIC, sizeof(CACHE_MAGIC)});
+      writer.Write(MODEL_CACHE_VERSION);
+      writer.Write(static_cast<std::uint32_t>(sizeof(Vertex)));
+      writer.WriteString(t_entry.key);
+      writer.Write(static_cast<std::uint8_t>(t_entry.compressed));
+
+      writer.Write(static_cast<std::uint32_t>(t_model.meshes.size()));
+      for (const auto& [lodLevel, lod] : t_model.meshes) {
+        writer.Write(lodLevel);
+        writer.Write(static_cast<std::uint32_t>(lod.size()));
+        for (const auto& mesh : lod) {
+          WriteMesh(writer, mesh, t_entry.compressed);
+        }
+      }
+
+      writer.Write(static_cast<std::uint32_t>(t_model.combinedMeshes.size()));
+      for (const auto& mesh : t_model.combinedMeshes) {
+        WriteMesh(writer, mesh, t_entry.compressed);
+      }
+
+      if (!out.good()) {
+        out.close();
+        std::filesystem::remove(tempPath);
+        throw std::runtime_error("Failed to write cache file: " + tempPath.string());
+      }
+    }
+
+    std::filesystem::rename(tempPath, cachePath);
+  }
+}
@@ -0,0 +1,127 @@
+#include "obj/ModelWatcher.hpp"
+
+#include <algorithm>
+
+namespace obj
+{
+  /*!
+   * @brief Starts watching a model with all of its lod and mtl files, replacing an earlier watch of the same path
+   * @param t_path Path of the obj, the same one given to ObjLoader::LoadFile()
+   * @param t_flags Flags the model was loaded with, Flag::Lods also watches for lod files appearing or disappearing
+   */
+  void ModelWatcher::Watch(const std::filesystem::path& t_path, const Flag t_flags) {
+    WatchedModel model;
+    model.flags     = t_flags;
+    model.files     = FindFiles(t_path, t_flags);
+    model.directory = GetStamp(GetModelDirectory(t_path));
+    StampFiles(model);
+
+    m_models[t_path] = std::move(model);
+  }
+
+  void ModelWatcher::Unwatch(const std::filesystem::path& t_path) {
+    m_models.erase(t_path);
+  }
+
+  /*!
+   * @brief Checks every watched model for changed files since the previous call
+   * @return One entry per model that changed, models without changes are left out
+   */
+  std::vector<ModelChange> ModelWatcher::Poll() {
+    std::vector<ModelChange> changes;
+
+    for (auto& [path, model] : m_models) {
+      ModelChange change{.path = path, .flags = model.flags, .files = {}, .objLods = {}, .mtlLods = {}};
+
+      // only a changed directory can hold new or removed lods, which spares the scan on most polls
+      if ((model.flags & Flag::Lods) == Flag::Lods) {
+        if (const Stamp directory = GetStamp(GetModelDirectory(path)); directory != model.directory) {
+          model.directory = directory;
+
+          std::vector<File> files = FindFiles(path, model.flags);
+          const bool        same  = std::ranges::equal(
+            files,
+            model.files,
+            [] (const File& t_a, const File& t_b)
+            {
+              return t_a.lodLevel == t_b.lodLevel && t_a.objPath == t_b.objPath && t_a.mtlPath == t_b.mtlPath;
+            });
+
+          if (!same) {
+            model.files = std::move(files);
+            StampFiles(model);
+
+            change.files       = model.files;
+            change.lodsChanged = true;
+            changes.push_back(std::move(change));
+            continue;
+          }
+        }
+      }
+
+      for (size_t i = 0; i < model.files.size(); ++i) {
+        const Stamp obj = GetStamp(model.files[i].objPath);
+        const Stamp mtl = GetStamp(model.files[i].mtlPath);
+
+        // mid-save, picked up by the poll after it was written back
+        if (!obj.exists || (!mtl.exists && model.stamps[i].mtl.exists)) {
+          continue;
+        }
+
+        if (obj != model.stamps[i].obj) {
+          change.objLods.push_back(model.files[i].lodLevel);
+        }
+        else if (mtl != model.stamps[i].mtl) {
+          change.mtlLods.push_back(model.files[i].lodLevel);
+        }
+
+        model.stamps[i] = {obj, mtl};
+      }
+
+      if (!change.objLods.empty() || !change.mtlLods.empty()) {
+        change.files = model.files;
+        changes.push_back(std::move(change));
+      }
+    }
+
+    return changes;
+  }
+
+  ModelWatcher::Stamp ModelWatcher::GetStamp(const std::filesystem::path& t_path) {
+    Stamp           stamp;
+    std::error_code error;
+
+    stamp.time = std::filesystem::last_write_time(t_path, error);
+    if (error) {
+      return {};
+    }
+
+    // directories have no size of their own
+    if (!std::filesystem::is_directory(t_path, error)) {
+      stamp.size = std::filesystem::file_size(t_path, error);
+      if (error) {
+        return {};
+      }
+    }
+
+    stamp.exists = true;
+    return stamp;
+  }
+
+  /*!
+   * @brief Finds every obj and mtl of a model the way a load does
+   */
+  std::vector<File> ModelWatcher::FindFiles(const std::filesystem::path& t_path, const Flag t_flags) {
+    LoaderState state(t_flags);
+    state.path = t_path;
+    CacheFilePaths(state);
+    return std::move(state.filePaths);
+  }
+
+  void ModelWatcher::StampFiles(WatchedModel& t_model) {
+    t_model.stamps.clear();
+    for (const auto& file : t_model.files) {
+      t_model.stamps.push_back({GetStamp(file.objPath), GetStamp(file.mtlPath)});
+    }
+  }
+}
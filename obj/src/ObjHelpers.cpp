@@ -1,14 +1,31 @@
 ﻿#include "obj/ObjHelpers.hpp"
 
+#include "obj/IndexOptimizer.hpp"
+#include "obj/MaterialRegistry.hpp"
+#include "obj/MeshSimplifier.hpp"
+#include "obj/MeshletBuilder.hpp"
 #include "obj/ObjLoader.hpp"
+#include "obj/VertexLayout.hpp"
+#include "obj/VertexWelder.hpp"
 
+#include <bit>
+#include <cstring>
 #include <fstream>
 #include <ranges>
+#include <unordered_map>
 
 #include <fast_float/fast_float.h>
 
 #include <glm/geometric.hpp>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OBJ_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define OBJ_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
 namespace obj
 {
   /*!
@@ -30,17 +47,58 @@ namespace obj
     return buffer;
   }
 
+  /*!
+   * @brief Returns the directory an obj and its mtl and lod files live in
+   * @param t_path Path to the obj file
+   * @return Parent directory, or the current directory if the path has none
+   */
+  std::filesystem::path GetModelDirectory(const std::filesystem::path& t_path) {
+    return t_path.parent_path().empty()
+             ? "." // current directory if none
+             : t_path.parent_path();
+  }
+
+  /*!
+   * @brief Lists every regular file inside a directory, so several models in one directory can share a single scan
+   * @param t_directory Directory to scan
+   * @return Paths of all regular files in directory order
+   */
+  std::vector<std::filesystem::path> ListDirectoryFiles(const std::filesystem::path& t_directory) {
+    std::vector<std::filesystem::path> files;
+
+    for (auto& entry : std::filesystem::directory_iterator(t_directory)) {
+      // skip if it is not a normal file
+      if (entry.is_regular_file()) {
+        files.push_back(entry.path());
+      }
+    }
+
+    return files;
+  }
+
   /*!
    * @brief Finds all lod files if any and their corresponding mtl files and stores them
    * @param t_state Internal state data to store the file paths in
    */
   void CacheFilePaths(LoaderState& t_state) {
+    if ((t_state.flags & Flag::Lods) == Flag::Lods) {
+      CacheFilePaths(t_state, ListDirectoryFiles(GetModelDirectory(t_state.path)));
+    }
+    else {
+      CacheFilePaths(t_state, {});
+    }
+  }
+
+  /*!
+   * @brief Finds all lod files if any and their corresponding mtl files and stores them
+   * @param t_state Internal state data to store the file paths in
+   * @param t_directoryFiles Regular files of the model's directory, from ListDirectoryFiles, only used with Flag::Lods
+   */
+  void CacheFilePaths(LoaderState& t_state, const std::span<const std::filesystem::path> t_directoryFiles) {
     // whole file path
     const std::filesystem::path basePath = t_state.path;
     // root directory of file
-    const std::filesystem::path dir = basePath.parent_path().empty()
-                                        ? "." // current directory if none
-                                        : basePath.parent_path();
+    const std::filesystem::path dir = GetModelDirectory(basePath);
     // just the filename minus the extension
     const std::filesystem::path fileName = basePath.stem();
 
@@ -54,14 +112,9 @@ namespace obj
 
     if ((t_state.flags & Flag::Lods) == Flag::Lods) {
       // find lods
-      for (auto& entry : std::filesystem::directory_iterator(dir)) {
-        // skip if it is not a normal file
-        if (!entry.is_regular_file()) {
-          continue;
-        }
-
-        const auto entryExtension = entry.path().extension(); // ".obj" or ".mtl"
-        const auto entryFileName  = entry.path().stem();      // filename without extension
+      for (const auto& entry : t_directoryFiles) {
+        const auto entryExtension = entry.extension(); // ".obj" or ".mtl"
+        const auto entryFileName  = entry.stem();      // filename without extension
 
         // Look for "_lod" substring inside filename (e.g., "rock_lod1")
         const auto pos = entryFileName.string().find(fileName.string() + "_lod");
@@ -74,17 +127,17 @@ namespace obj
         try {
           unsigned int lodIndex = std::stoi(lodNumStr);
 
-          // create element if it doesn't exist
-          if (lodIndex >= t_state.filePaths.size()) {
-            t_state.filePaths.emplace_back("", "", lodIndex);
+          // create every element up to it, directory order is not lod order
+          while (lodIndex >= t_state.filePaths.size()) {
+            t_state.filePaths.emplace_back("", "", static_cast<unsigned int>(t_state.filePaths.size()));
           }
 
           // Assign paths depending on file type
           if (entryExtension == ".obj") {
-            t_state.filePaths[lodIndex].objPath = entry.path().string();
+            t_state.filePaths[lodIndex].objPath = entry.string();
           }
           else if (entryExtension == ".mtl") {
-            t_state.filePaths[lodIndex].mtlPath = entry.path().string();
+            t_state.filePaths[lodIndex].mtlPath = entry.string();
           }
         }
         catch (...) {
@@ -94,6 +147,67 @@ namespace obj
     }
   }
 
+  /*!
+   * @brief Finds the end of the current line, 16 bytes at a time where SSE2 or NEON is available
+   * @param t_ptr Somewhere inside the line
+   * @param t_end End of the buffer
+   * @return Pointer to the first newline or carriage return at or after t_ptr, or t_end if there is none
+   */
+  const char* FindLineEnd(const char* t_ptr, const char* t_end) {
+#if defined(OBJ_SIMD_SSE2)
+    const __m128i newline        = _mm_set1_epi8('\n');
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+
+    while (t_end - t_ptr >= 16) {
+      const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_ptr));
+      const int     mask  = _mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(bytes, newline), _mm_cmpeq_epi8(bytes, carriageReturn)));
+
+      if (mask != 0) {
+        return t_ptr + std::countr_zero(static_cast<unsigned int>(mask));
+      }
+      t_ptr += 16;
+    }
+#elif defined(OBJ_SIMD_NEON)
+    const uint8x16_t newline        = vdupq_n_u8('\n');
+    const uint8x16_t carriageReturn = vdupq_n_u8('\r');
+
+    while (t_end - t_ptr >= 16) {
+      const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(t_ptr));
+      const uint8x16_t match = vorrq_u8(vceqq_u8(bytes, newline), vceqq_u8(bytes, carriageReturn));
+      // narrow every byte of the match to a nibble so the whole result fits one 64-bit lane
+      const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0);
+
+      if (mask != 0) {
+        return t_ptr + (std::countr_zero(mask) >> 2);
+      }
+      t_ptr += 16;
+    }
+#endif
+    // scalar tail, or the whole line without SIMD support
+    while (t_ptr < t_end && *t_ptr != '\n' && *t_ptr != '\r') {
+      ++t_ptr;
+    }
+    return t_ptr;
+  }
+
+  /*!
+   * @brief Returns the line starting at t_ptr and advances t_ptr past its line terminators
+   * @param t_ptr Start of the line, moved to the start of the next line
+   * @param t_end End of the buffer
+   * @return Line without its terminators
+   */
+  std::string_view NextLine(const char*& t_ptr, const char* t_end) {
+    const char* lineStart = t_ptr;
+    t_ptr                 = FindLineEnd(t_ptr, t_end);
+
+    const std::string_view line(lineStart, t_ptr - lineStart);
+    while (t_ptr < t_end && (*t_ptr == '\n' || *t_ptr == '\r')) {
+      ++t_ptr;
+    }
+    return line;
+  }
+
   const char* ParseFloat(const char* t_ptr, const char* t_end, float& t_out) {
     auto [ptr, ec] = fast_float::from_chars(t_ptr, t_end, t_out, fast_float::chars_format::skip_white_space);
     if (ec != std::errc{}) {
@@ -103,121 +217,426 @@ namespace obj
   }
 
   /*!
-   * @brief Pointer walks through the obj file and stores vertex data in LoaderState
-   * @param t_state Internal state data to store vertex data
-   * @param t_meshes List of meshes created by parsing
-   * @param t_buffer String buffer of current file
-   * @param t_lodLevel Specified lod level, if any
+   * @brief Decodes a signed decimal face index without strtoul; up to 8 digits are converted at once with SWAR arithmetic
+   * \n on little-endian targets, anything longer or closer than 8 bytes to t_end finishes in a scalar loop
+   * @param t_ptr Start of the index, an optional leading '-' marks a relative index
+   * @param t_end End of the line, nothing past it is read
+   * @param t_out Decoded value, 0 if there are no digits at t_ptr
+   * @return Pointer past the last digit, or t_ptr if there were no digits
    */
-  void ParseObj(LoaderState& t_state, const std::string& t_buffer, const unsigned int t_lodLevel) {
-    std::vector<Mesh>& meshes = GetMeshContainer(t_state, t_lodLevel);
+  const char* ParseIndex(const char* t_ptr, const char* t_end, std::int64_t& t_out) {
+    const bool  negative = t_ptr < t_end && *t_ptr == '-';
+    const char* digits   = t_ptr + (negative ? 1 : 0);
+    const char* ptr      = digits;
+
+    std::uint64_t value      = 0;
+    bool          scalarTail = true;
+
+    if constexpr (std::endian::native == std::endian::little) {
+      if (t_end - ptr >= 8) {
+        std::uint64_t word;
+        std::memcpy(&word, ptr, sizeof(word));
+
+        // a byte is a digit if its high nibble is 3 and adding 6 keeps it there, i.e. its low nibble is at most 9
+        constexpr std::uint64_t highNibbles = 0xF0F0F0F0F0F0F0F0;
+        constexpr std::uint64_t digitNibble = 0x3030303030303030;
+        constexpr std::uint64_t low7        = 0x7F7F7F7F7F7F7F7F;
+
+        const std::uint64_t nonDigit = ((word & highNibbles) ^ digitNibble) |
+                                       (((word + 0x0606060606060606) & highNibbles) ^ digitNibble);
+        // high bit set in every byte of nonDigit that is zero, without carries between bytes
+        const std::uint64_t digitBytes = ~(((nonDigit & low7) + low7) | nonDigit | low7);
+        const int           count      = std::countr_zero(~digitBytes & 0x8080808080808080) >> 3;
+
+        if (count > 0) {
+          // shift the digits to the top so the bytes below them read as leading zeros, then fold pairs of 1, 2, 4 digits
+          std::uint64_t v = word << (8 * (8 - count));
+          v               = (v & 0x0F0F0F0F0F0F0F0F) * 2561 >> 8;
+          v               = (v & 0x00FF00FF00FF00FF) * 6553601 >> 16;
+          value           = (v & 0x0000FFFF0000FFFF) * 42949672960001 >> 32;
+          ptr += count;
+        }
 
-    int meshCount = -1;
+        // a run shorter than the word already hit its terminator
+        scalarTail = count == 8;
+      }
+    }
 
-    const char* data = t_buffer.data();
-    const char* end  = data + t_buffer.size();
+    if (scalarTail) {
+      while (ptr < t_end && static_cast<unsigned char>(*ptr - '0') < 10) {
+        value = value * 10 + static_cast<unsigned char>(*ptr - '0');
+        ++ptr;
+      }
+    }
 
-    // --- First pass: count meshes and estimate sizes ---
-    size_t              meshEstimate = 0;
-    std::vector<size_t> verticesPerMesh;
-    std::vector<size_t> texPerMesh;
-    std::vector<size_t> normalsPerMesh;
-    std::vector<size_t> facesPerMesh;
+    if (ptr == digits) {
+      t_out = 0;
+      return t_ptr;
+    }
 
-    while (data < end) {
-      const char* lineStart = data;
-      while (data < end && *data != '\n' && *data != '\r') {
-        ++data;
+    t_out = negative ? -static_cast<std::int64_t>(value) : static_cast<std::int64_t>(value);
+    return ptr;
+  }
+
+  /*!
+   * @brief Reads the corners of a single face record in any of the v, v/vt, v//vn or v/vt/vn forms
+   * @param t_ptr Start of the corner data, just past the "f " prefix
+   * @param t_end End of the line, nothing past it is read
+   * @param t_counts Number of v/vt/vn elements defined so far in the file, relative indices count back from these
+   * @param t_face Replaced with the corners as 1-based v/vt/vn indices, components that are absent stay 0. Reused
+   * across faces by the parsers, so only the first face of a size allocates
+   * @param t_relative Set if any corner used a relative index
+   * @return Number of corners read
+   */
+  unsigned int ParseFace(const char*              t_ptr,
+                         const char*              t_end,
+                         const glm::uvec3&        t_counts,
+                         std::vector<glm::uvec3>& t_face,
+                         bool&                    t_relative) {
+    t_face.clear();
+
+    // -1 refers to the last element defined before this face
+    auto resolve = [&t_relative] (const std::int64_t t_index, const unsigned int t_count) -> unsigned int
+    {
+      if (t_index >= 0) {
+        return static_cast<unsigned int>(t_index);
       }
-      std::string_view line(lineStart, data - lineStart);
-      while (data < end && (*data == '\n' || *data == '\r')) {
-        ++data;
+
+      t_relative = true;
+      return static_cast<unsigned int>(std::max<std::int64_t>(0, t_count + t_index + 1));
+    };
+
+    while (true) {
+      // Skip spaces
+      while (t_ptr < t_end && (*t_ptr == ' ' || *t_ptr == '\t')) {
+        ++t_ptr;
       }
 
-      if (line.empty() || line[0] == '#') {
-        continue;
+      std::int64_t index = 0;
+      const char*  next  = ParseIndex(t_ptr, t_end, index);
+      if (next == t_ptr) {
+        break; // end of line or not a corner
       }
 
-      if (line.starts_with("o ")) {
-        meshEstimate++;
-        verticesPerMesh.push_back(0);
-        texPerMesh.push_back(0);
-        normalsPerMesh.push_back(0);
-        facesPerMesh.push_back(0);
+      glm::uvec3 u{};
+      t_ptr = next;
+      u.x   = resolve(index, t_counts.x);
+
+      if (t_ptr < t_end && *t_ptr == '/') {
+        t_ptr = ParseIndex(t_ptr + 1, t_end, index);
+        u.y   = resolve(index, t_counts.y);
       }
-      else if (line.starts_with("v ")) {
-        if (!verticesPerMesh.empty()) {
-          verticesPerMesh.back()++;
+      if (t_ptr < t_end && *t_ptr == '/') {
+        t_ptr = ParseIndex(t_ptr + 1, t_end, index);
+        u.z   = resolve(index, t_counts.z);
+      }
+
+      t_face.push_back(u);
+    }
+
+    return static_cast<unsigned int>(t_face.size());
+  }
+
+  /*!
+   * @brief Appends a parsed face as a triangle fan around its first corner, so quads are split along the v0 → v2
+   * diagonal. Faces above 3 corners are recorded in t_polygons, TriangulatePolygons() replaces the fan of any that
+   * isn't convex once the positions are known
+   * @param t_faceIndices Destination face index container
+   * @param t_polygons Destination of the polygon records
+   * @param t_face Corners of the face, faces below 3 corners are dropped
+   */
+  void AppendTriangulatedFace(std::pmr::vector<glm::uvec3>& t_faceIndices,
+                              std::pmr::vector<glm::uvec2>& t_polygons,
+                              const std::span<const glm::uvec3> t_face) {
+    if (t_face.size() < 3) {
+      return;
+    }
+
+    if (t_face.size() > 3) {
+      t_polygons.emplace_back(t_faceIndices.size(), t_face.size());
+    }
+
+    for (size_t i = 1; i + 1 < t_face.size(); ++i) {
+      t_faceIndices.push_back(t_face[0]);
+      t_faceIndices.push_back(t_face[i]);
+      t_faceIndices.push_back(t_face[i + 1]);
+    }
+  }
+
+  /*!
+   * @brief Ear clips every recorded polygon of a mesh that isn't convex, in place of its fan. Convex polygons, nearly
+   * all of them in practice, are only checked and keep the fan, which is already the right triangulation
+   * \n Polygons are projected onto the plane of their Newell normal, so faces that are only roughly planar still work.
+   * Quads, which CAD exports often leave far from planar, only switch diagonals when the fan would fold over
+   * @param t_tempMesh Mesh with mesh-local face indices
+   */
+  void TriangulatePolygons(TempMeshes& t_tempMesh) {
+    std::vector<glm::uvec3>   corners;
+    std::vector<glm::vec2>    points;
+    std::vector<unsigned int> remaining;
+
+    for (const glm::uvec2 polygon : t_tempMesh.polygons) {
+      glm::uvec3*  fan  = &t_tempMesh.faceIndices[polygon.x];
+      const size_t size = polygon.y;
+
+      // the fan holds every corner in order: its hub, then the second corner of each triangle, then the last corner
+      corners.resize(size);
+      corners[0] = fan[0];
+      for (size_t i = 1; i + 1 < size; ++i) {
+        corners[i] = fan[(i - 1) * 3 + 1];
+      }
+      corners[size - 1] = fan[(size - 3) * 3 + 2];
+
+      bool inRange = true;
+      for (const glm::uvec3& corner : corners) {
+        inRange &= corner.x < t_tempMesh.vertices.size();
+      }
+      if (!inRange) {
+        continue;
+      }
+
+      // a quad only needs the other diagonal when the v0 → v2 one folds it over, a twisted quad can take either
+      if (size == 4) {
+        const glm::vec3& p0 = t_tempMesh.vertices[corners[0].x];
+        const glm::vec3& p1 = t_tempMesh.vertices[corners[1].x];
+        const glm::vec3& p2 = t_tempMesh.vertices[corners[2].x];
+        const glm::vec3& p3 = t_tempMesh.vertices[corners[3].x];
+
+        const bool folds   = glm::dot(glm::cross(p1 - p0, p2 - p0), glm::cross(p2 - p0, p3 - p0)) < 0.0f;
+        const bool flatter = glm::dot(glm::cross(p2 - p1, p3 - p1), glm::cross(p3 - p1, p0 - p1)) > 0.0f;
+        if (folds && flatter) {
+          fan[0] = corners[1], fan[1] = corners[2], fan[2] = corners[3];
+          fan[3] = corners[1], fan[4] = corners[3], fan[5] = corners[0];
         }
+        continue;
       }
-      else if (line.starts_with("vt")) {
-        if (!texPerMesh.empty()) {
-          texPerMesh.back()++;
+
+      glm::vec3 normal(0.0f);
+      for (size_t i = 0; i < size; ++i) {
+        const glm::vec3& a = t_tempMesh.vertices[corners[i].x];
+        const glm::vec3& b = t_tempMesh.vertices[corners[(i + 1) % size].x];
+        normal += glm::vec3((a.y - b.y) * (a.z + b.z), (a.z - b.z) * (a.x + b.x), (a.x - b.x) * (a.y + b.y));
+      }
+      if (glm::dot(normal, normal) == 0.0f) {
+        continue; // degenerate, any triangulation is as good as the fan
+      }
+
+      // drop the dominant axis, flipping the other one keeps the winding counter-clockwise in 2D
+      const glm::vec3 absNormal = glm::abs(normal);
+      const int       axis      = absNormal.x > absNormal.y ? (absNormal.x > absNormal.z ? 0 : 2)
+                                                            : (absNormal.y > absNormal.z ? 1 : 2);
+      const int       u         = (axis + 1) % 3;
+      const int       v         = (axis + 2) % 3;
+      const float     flip      = normal[axis] < 0.0f ? -1.0f : 1.0f;
+
+      points.resize(size);
+      for (size_t i = 0; i < size; ++i) {
+        const glm::vec3& p = t_tempMesh.vertices[corners[i].x];
+        points[i]          = {p[u], p[v] * flip};
+      }
+
+      auto orient = [&] (const unsigned int t_a, const unsigned int t_b, const unsigned int t_c)
+      {
+        const glm::vec2 ab = points[t_b] - points[t_a];
+        const glm::vec2 ac = points[t_c] - points[t_a];
+        return ab.x * ac.y - ab.y * ac.x;
+      };
+
+      bool convex = true;
+      for (size_t i = 0; i < size && convex; ++i) {
+        convex = orient(i, (i + 1) % size, (i + 2) % size) >= 0.0f;
+      }
+      if (convex) {
+        continue;
+      }
+
+      remaining.resize(size);
+      for (unsigned int i = 0; i < size; ++i) {
+        remaining[i] = i;
+      }
+
+      // an ear is a convex corner whose triangle holds no other corner, cutting it off leaves a simple polygon
+      auto isEar = [&] (const size_t t_i)
+      {
+        const size_t       n    = remaining.size();
+        const unsigned int prev = remaining[(t_i + n - 1) % n];
+        const unsigned int cur  = remaining[t_i];
+        const unsigned int next = remaining[(t_i + 1) % n];
+
+        if (orient(prev, cur, next) <= 0.0f) {
+          return false;
+        }
+
+        for (const unsigned int other : remaining) {
+          if (other != prev && other != cur && other != next && orient(prev, cur, other) >= 0.0f &&
+              orient(cur, next, other) >= 0.0f && orient(next, prev, other) >= 0.0f) {
+            return false;
+          }
         }
+        return true;
+      };
+
+      size_t written = 0;
+      size_t i       = 0;
+      while (remaining.size() > 3) {
+        size_t tries = 0;
+        while (tries < remaining.size() && !isEar(i)) {
+          i = (i + 1) % remaining.size();
+          ++tries;
+        }
+
+        // self-intersecting input has no ear left, cutting the current corner still terminates
+        const size_t n = remaining.size();
+        fan[written++] = corners[remaining[(i + n - 1) % n]];
+        fan[written++] = corners[remaining[i]];
+        fan[written++] = corners[remaining[(i + 1) % n]];
+
+        remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>(i));
+        i = i % remaining.size();
       }
-      else if (line.starts_with("vn")) {
-        if (!normalsPerMesh.empty()) {
-          normalsPerMesh.back()++;
+
+      fan[written++] = corners[remaining[0]];
+      fan[written++] = corners[remaining[1]];
+      fan[written++] = corners[remaining[2]];
+    }
+  }
+
+  namespace
+  {
+    // 1-based face corner to a 0-based index into its mesh, a vt or vn the face left out becomes NO_INDEX
+    glm::uvec3 RebaseCorner(const glm::uvec3 t_corner, const glm::uvec3 t_offset) {
+      const glm::uvec3 rebased = t_corner - 1u - t_offset;
+      return {rebased.x, t_corner.y == 0 ? NO_INDEX : rebased.y, t_corner.z == 0 ? NO_INDEX : rebased.z};
+    }
+
+    // counts the corners of a face that left out their vt or vn
+    void CountCorners(CornerCounts& t_counts, const std::span<const glm::uvec3> t_face) {
+      if (t_face.size() < 3) {
+        return;
+      }
+
+      t_counts.corners += t_face.size();
+      for (const glm::uvec3& corner : t_face) {
+        t_counts.noTexCoord += corner.y == 0;
+        t_counts.noNormal += corner.z == 0;
+      }
+    }
+
+    /*!
+     * @brief Hashed usemtl lookup of one lod, built once per parse instead of scanning every material on every usemtl.
+     * \n Looks names up in the shared library of the lod with Flag::SharedMaterials, in its own materials otherwise
+     */
+    class MaterialLookup
+    {
+    public:
+      MaterialLookup(LoaderState& t_state, const unsigned int t_lodLevel) {
+        if (auto it = t_state.materialLibraries.find(t_lodLevel); it != t_state.materialLibraries.end() && it->second) {
+          m_library = it->second.get();
+          return;
+        }
+
+        m_materials = &t_state.materials[t_lodLevel];
+        m_byName.reserve(m_materials->size());
+
+        // the last definition of a name wins, as the scan this replaces did
+        for (size_t i = 0; i < m_materials->size(); ++i) {
+          m_byName[(*m_materials)[i].name] = i;
         }
       }
-      else if (line.starts_with("f ")) {
-        if (!facesPerMesh.empty()) {
-          facesPerMesh.back()++;
+
+      /*!
+       * @brief Gives a mesh the material a usemtl line names, a name without a material only sets tiling and index
+       */
+      void Assign(Mesh& t_mesh, const std::string_view t_name, const bool t_isTiled, const unsigned int t_index) const {
+        if (m_library) {
+          const auto it = m_library->byName.find(std::string(t_name));
+          if (it == m_library->byName.end()) {
+            return;
+          }
+          t_mesh.material      = Material{};
+          t_mesh.material.name = it->first;
+          t_mesh.materialId    = it->second;
+        }
+        else if (auto it = m_byName.find(t_name); it != m_byName.end()) {
+          t_mesh.material = (*m_materials)[it->second];
         }
+        else {
+          return;
+        }
+
+        t_mesh.material.isTiled = t_isTiled;
+        t_mesh.material.index   = t_index;
       }
-    }
 
-    // Pre-reserve tempMeshes and meshes vectors
-    t_state.tempMeshes[t_lodLevel].reserve(meshEstimate);
-    auto& tempMeshes = t_state.tempMeshes[t_lodLevel];
-    meshes.reserve(meshEstimate);
+    private:
+      const MaterialLibrary*                       m_library   = nullptr;
+      const std::vector<Material>*                 m_materials = nullptr;
+      std::unordered_map<std::string_view, size_t> m_byName; // views into m_materials
+    };
+  }
 
-    // --- Second pass: actual parsing ---
-    data = t_buffer.data();
-    std::string meshName;
-    float       x, y, z;
+  /*!
+   * @brief Pointer walks through the obj file in a single pass and stores vertex data in LoaderState.
+   * \n There is no separate counting pass, per-mesh containers grow geometrically instead
+   * @param t_state Internal state data to store vertex data
+   * @param t_buffer View over the contents of the current file, read or mapped
+   * @param t_lodLevel Specified lod level, if any
+   */
+  void ParseObj(LoaderState& t_state, const std::string_view t_buffer, const unsigned int t_lodLevel) {
+    std::vector<Mesh>&       meshes     = GetMeshContainer(t_state, t_lodLevel);
+    std::vector<TempMeshes>& tempMeshes = t_state.tempMeshes[t_lodLevel];
+
+    int meshCount = -1;
+
+    const char* data = t_buffer.data();
+    const char* end  = data + t_buffer.size();
+
+    float x, y, z;
 
     glm::uvec3 indexOffset{0};
     glm::uvec3 maxIndexSeen{0};
+    glm::uvec3 elementCount{0}; // v/vt/vn defined so far, for relative indices
 
     glm::vec2 uvMin(FLT_MAX);
     glm::vec2 uvMax(-FLT_MAX);
 
-    unsigned int mtlCount = 0;
+    unsigned int         mtlCount = 0;
+    bool                 relative = false; // only the chunked parser needs to know, elementCount is always exact here
+    const MaterialLookup materialLookup(t_state, t_lodLevel);
 
-    while (data < end) {
-      const char* lineStart = data;
-      while (data < end && *data != '\n' && *data != '\r') {
-        ++data;
-      }
-      std::string_view line(lineStart, data - lineStart);
-      while (data < end && (*data == '\n' || *data == '\r')) {
-        ++data;
+    std::vector<glm::uvec3> face; // corners of the current f line, reused across lines
+
+    auto beginMesh = [&] (std::string t_name)
+    {
+      meshCount++;
+
+      tempMeshes.emplace_back(t_state.arena);
+      meshes.emplace_back();
+      indexOffset = maxIndexSeen; // carry forward for next mesh
+
+      meshes[meshCount].name       = std::move(t_name);
+      meshes[meshCount].meshNumber = meshCount;
+      meshes[meshCount].lodLevel   = t_lodLevel;
+    };
+
+    // records before the first o line still need a mesh to live in, same as ParseObjParallel()
+    auto currentMesh = [&]
+    {
+      if (meshCount < 0) {
+        beginMesh({});
       }
+      return meshCount;
+    };
+
+    while (data < end) {
+      const std::string_view line = NextLine(data, end);
 
       if (line.empty() || line[0] == '#') {
         continue;
       }
 
       if (line.starts_with("o ")) {
-        meshName = std::string(line.substr(2));
-        meshCount++;
-
-        t_state.tempMeshes[t_lodLevel].emplace_back();
-        meshes.emplace_back();
-        indexOffset = maxIndexSeen; // carry forward for next mesh
-
-        // Pre-reserve per-mesh vectors based on first-pass counts
-        if (int size = static_cast<int>(verticesPerMesh.size()); meshCount < size) {
-          tempMeshes[meshCount].vertices.reserve(verticesPerMesh[meshCount]);
-          tempMeshes[meshCount].texCoords.reserve(texPerMesh[meshCount]);
-          tempMeshes[meshCount].normals.reserve(normalsPerMesh[meshCount]);
-          tempMeshes[meshCount].faceIndices.reserve(facesPerMesh[meshCount] * 3); // 3 indices per face
-        }
-
-        meshes[meshCount].name       = meshName;
-        meshes[meshCount].meshNumber = meshCount;
-        meshes[meshCount].lodLevel   = t_lodLevel;
+        beginMesh(std::string(line.substr(2)));
       }
       else if (line.starts_with("v ")) {
         const char* ptr    = line.data() + 2;
@@ -226,7 +645,8 @@ namespace obj
         ptr = ParseFloat(ptr, ptrEnd, x);
         ptr = ParseFloat(ptr, ptrEnd, y);
         ptr = ParseFloat(ptr, ptrEnd, z);
-        tempMeshes[meshCount].vertices.emplace_back(x, y, z);
+        tempMeshes[currentMesh()].vertices.emplace_back(x, y, z);
+        elementCount.x++;
       }
       else if (line.starts_with("vt")) {
         const char* ptr    = line.data() + 2;
@@ -235,7 +655,8 @@ namespace obj
         ptr = ParseFloat(ptr, ptrEnd, x);
         ptr = ParseFloat(ptr, ptrEnd, y);
 
-        tempMeshes[meshCount].texCoords.emplace_back(x, 1.0 - y);
+        tempMeshes[currentMesh()].texCoords.emplace_back(x, 1.0 - y);
+        elementCount.y++;
 
         uvMin = glm::min(uvMin, {x, y});
         uvMax = glm::max(uvMax, {x, y});
@@ -247,22 +668,15 @@ namespace obj
         ptr = ParseFloat(ptr, ptrEnd, x);
         ptr = ParseFloat(ptr, ptrEnd, y);
         ptr = ParseFloat(ptr, ptrEnd, z);
-        tempMeshes[meshCount].normals.emplace_back(x, y, z);
+        tempMeshes[currentMesh()].normals.emplace_back(x, y, z);
+        elementCount.z++;
       }
       else if (line.starts_with("usemtl")) {
-        auto name = std::string(line.substr(7));
-
         glm::vec2 uvRange = uvMax - uvMin;
         bool      isTiled = (uvRange.x > 1.0f || uvRange.y > 1.0f);
 
         // pull texture names from cached mtl data and construct ordered mesh materials
-        for (auto& mat : t_state.materials[t_lodLevel]) {
-          if (mat.name == name) {
-            meshes[meshCount].material         = mat;
-            meshes[meshCount].material.isTiled = isTiled;
-            meshes[meshCount].material.index   = mtlCount;
-          }
-        }
+        materialLookup.Assign(meshes[currentMesh()], line.substr(7), isTiled, mtlCount);
 
         // reset uv count
         uvMax = glm::vec2(-FLT_MAX);
@@ -274,442 +688,1458 @@ namespace obj
         t_state.mtlFileName = std::string(line.substr(7));
       }
       else if (line.starts_with("f ")) {
-        const char* ptr    = line.data() + 2;
-        const char* ptrEnd = line.data() + line.size();
+        ParseFace(line.data() + 2, line.data() + line.size(), elementCount, face, relative);
 
-        unsigned int              faceSize = 0;
-        std::array<glm::uvec3, 4> face;
-
-        while (ptr < ptrEnd && faceSize < 4) {
-          glm::uvec3 u{};
-          u.x = std::strtoul(ptr, const_cast<char**>(&ptr), 10);
-          if (*ptr == '/') {
-            ++ptr;
-            u.y = std::strtoul(ptr, const_cast<char**>(&ptr), 10);
-          }
-          if (*ptr == '/') {
-            ++ptr;
-            u.z = std::strtoul(ptr, const_cast<char**>(&ptr), 10);
-          }
+        TempMeshes& tempMesh = tempMeshes[currentMesh()];
+        CountCorners(tempMesh.corners, face);
 
+        for (glm::uvec3& corner : face) {
           // Track max values for this mesh
-          maxIndexSeen = glm::max(maxIndexSeen, u);
+          maxIndexSeen = glm::max(maxIndexSeen, corner);
 
           // Decrement for 0-based indices
-          --u;
-          u -= indexOffset;
-
-          face[faceSize++] = u;
-
-          // Skip spaces
-          while (ptr < ptrEnd && *ptr == ' ') {
-            ++ptr;
-          }
-        }
-
-        if (faceSize == 3) {
-          tempMeshes[meshCount].faceIndices.insert(tempMeshes[meshCount].faceIndices.end(), face.begin(), face.begin() + 3);
+          corner = RebaseCorner(corner, indexOffset);
         }
-        // triangulate
-        else if (faceSize == 4) {
-          // Split along v0 → v2 diagonal
-          tempMeshes[meshCount].faceIndices.push_back(face[0]);
-          tempMeshes[meshCount].faceIndices.push_back(face[1]);
-          tempMeshes[meshCount].faceIndices.push_back(face[2]);
 
-          tempMeshes[meshCount].faceIndices.push_back(face[0]);
-          tempMeshes[meshCount].faceIndices.push_back(face[2]);
-          tempMeshes[meshCount].faceIndices.push_back(face[3]);
-        }
+        AppendTriangulatedFace(tempMesh.faceIndices, tempMesh.polygons, face);
       }
     }
   }
 
   /*!
-   * @brief Pointer walks through the mtl file and stores texture info in LoaderState
-   * @param t_state Internal state data to store texture info
-   * @param t_buffer String buffer of current file
-   * @param t_lodLevel
+   * @brief Pointer walks through a single chunk of an obj file and stores its records chunk-locally.
+   * \n Indices are kept exactly as written and mesh boundaries are only recorded as segments,
+   * ParseObjParallel() resolves both once every chunk is done
+   * @param t_chunk Chunk to parse, its buffer must start and end on a line boundary
    */
-  void ParseMtl(LoaderState& t_state, const std::string& t_buffer, const unsigned int& t_lodLevel) {
-    // --- First pass: estimate number of materials ---
-    size_t      materialCount = 0;
-    const char* ptr           = t_buffer.data();
-    const char* end           = ptr + t_buffer.size();
+  void ParseObjChunk(ObjChunk& t_chunk) {
+    const char* data = t_chunk.buffer.data();
+    const char* end  = data + t_chunk.buffer.size();
+    float       x, y, z;
 
-    while (ptr < end) {
-      // skip leading whitespace
-      while (ptr < end && (*ptr == ' ' || *ptr == '\t')) {
-        ++ptr;
-      }
-      const char* lineStart = ptr;
-      while (ptr < end && *ptr != ' ' && *ptr != '\t' && *ptr != '\n' && *ptr != '\r') {
-        ++ptr;
+    // closes the current segment and starts a new one at the current end of every stream
+    auto beginSegment = [&] (const ObjChunk::Segment::Start t_start, std::string t_name)
+    {
+      if (!t_chunk.segments.empty()) {
+        ObjChunk::Segment& last = t_chunk.segments.back();
+        last.vertexEnd          = t_chunk.vertices.size();
+        last.texCoordEnd        = t_chunk.texCoords.size();
+        last.normalEnd          = t_chunk.normals.size();
+        last.faceEnd            = t_chunk.faceIndices.size();
+        last.polygonEnd         = t_chunk.polygons.size();
       }
-      std::string_view prefix(lineStart, ptr - lineStart);
 
-      if (prefix == "newmtl") {
-        materialCount++;
-      }
+      ObjChunk::Segment& segment = t_chunk.segments.emplace_back();
+      segment.start              = t_start;
+      segment.name               = std::move(t_name);
+      segment.vertexBegin        = t_chunk.vertices.size();
+      segment.texCoordBegin      = t_chunk.texCoords.size();
+      segment.normalBegin        = t_chunk.normals.size();
+      segment.faceBegin          = t_chunk.faceIndices.size();
+      segment.polygonBegin       = t_chunk.polygons.size();
+    };
 
-      // skip rest of line
-      while (ptr < end && *ptr != '\n') {
-        ++ptr;
-      }
-      if (ptr < end && *ptr == '\n') {
-        ++ptr;
-      }
-    }
+    std::vector<glm::uvec3> face; // corners of the current f line, reused across lines
 
-    // pre-allocate vector
-    t_state.materials[t_lodLevel].reserve(t_state.materials.size() + materialCount);
+    beginSegment(ObjChunk::Segment::Start::Continue, {});
 
-    // --- Second pass: actual parsing ---
-    ptr          = t_buffer.data();
-    int mtlCount = -1;
+    while (data < end) {
+      const std::string_view line = NextLine(data, end);
 
-    while (ptr < end) {
-      // Skip leading whitespace
-      while (ptr < end && (*ptr == ' ' || *ptr == '\t')) {
-        ++ptr;
+      if (line.empty() || line[0] == '#') {
+        continue;
       }
 
-      const char* lineStart = ptr;
-      while (ptr < end && *ptr != ' ' && *ptr != '\t' && *ptr != '\n' && *ptr != '\r') {
-        ++ptr;
+      if (line.starts_with("o ")) {
+        beginSegment(ObjChunk::Segment::Start::Object, std::string(line.substr(2)));
+      }
+      else if (line.starts_with("v ")) {
+        const char* ptr    = line.data() + 2;
+        const char* ptrEnd = line.data() + line.size();
+
+        ptr = ParseFloat(ptr, ptrEnd, x);
+        ptr = ParseFloat(ptr, ptrEnd, y);
+        ptr = ParseFloat(ptr, ptrEnd, z);
+        t_chunk.vertices.emplace_back(x, y, z);
       }
-      std::string_view prefix(lineStart, ptr - lineStart);
+      else if (line.starts_with("vt")) {
+        const char* ptr    = line.data() + 2;
+        const char* ptrEnd = line.data() + line.size();
 
-      if (prefix.empty() || prefix[0] == '#') {
-        while (ptr < end && *ptr != '\n') {
-          ++ptr;
-        }
-        if (ptr < end && *ptr == '\n') {
-          ++ptr;
-        }
-        continue;
+        ptr = ParseFloat(ptr, ptrEnd, x);
+        ptr = ParseFloat(ptr, ptrEnd, y);
+        t_chunk.texCoords.emplace_back(x, 1.0 - y);
+
+        ObjChunk::Segment& segment = t_chunk.segments.back();
+        segment.uvMin              = glm::min(segment.uvMin, {x, y});
+        segment.uvMax              = glm::max(segment.uvMax, {x, y});
       }
+      else if (line.starts_with("vn")) {
+        const char* ptr    = line.data() + 2;
+        const char* ptrEnd = line.data() + line.size();
 
-      while (ptr < end && (*ptr == ' ' || *ptr == '\t')) {
-        ++ptr;
+        ptr = ParseFloat(ptr, ptrEnd, x);
+        ptr = ParseFloat(ptr, ptrEnd, y);
+        ptr = ParseFloat(ptr, ptrEnd, z);
+        t_chunk.normals.emplace_back(x, y, z);
       }
-      const char* valueStart = ptr;
-      while (ptr < end && *ptr != ' ' && *ptr != '\t' && *ptr != '\n' && *ptr != '\r') {
-        ++ptr;
+      else if (line.starts_with("usemtl")) {
+        beginSegment(ObjChunk::Segment::Start::Material, std::string(line.substr(7)));
       }
-      std::string_view value(valueStart, ptr - valueStart);
-
-      if (prefix == "newmtl") {
-        t_state.materials[t_lodLevel].emplace_back(std::string(value));
-        mtlCount = static_cast<int>(t_state.materials[t_lodLevel].size() - 1);
+      else if (line.starts_with("mtllib")) {
+        t_chunk.mtlFileName = std::string(line.substr(7));
       }
-      else if (mtlCount >= 0) {
-        if (prefix == "map_Kd") {
-          t_state.materials[t_lodLevel][mtlCount].diffuseName = value;
-        }
-        else if (prefix == "map_Ks" || prefix == "map_Ns") {
-          t_state.materials[t_lodLevel][mtlCount].specularName = value;
-        }
-        else if (prefix == "map_Bump" || prefix == "bump") {
-          t_state.materials[t_lodLevel][mtlCount].normalName = value;
-        }
-        else if (prefix == "disp") {
-          t_state.materials[t_lodLevel][mtlCount].heightName = value;
+      else if (line.starts_with("f ")) {
+        // relative indices count back from the file-wide element count at this line
+        const glm::uvec3 elementCount = t_chunk.base + glm::uvec3(
+                                          t_chunk.vertices.size(),
+                                          t_chunk.texCoords.size(),
+                                          t_chunk.normals.size());
+
+        ParseFace(line.data() + 2, line.data() + line.size(), elementCount, face, t_chunk.relativeIndices);
+
+        ObjChunk::Segment& segment = t_chunk.segments.back();
+        CountCorners(segment.corners, face);
+        for (const glm::uvec3& corner : face) {
+          segment.maxIndex = glm::max(segment.maxIndex, corner);
         }
-      }
 
-      while (ptr < end && *ptr != '\n') {
-        ++ptr;
-      }
-      if (ptr < end && *ptr == '\n') {
-        ++ptr;
+        AppendTriangulatedFace(t_chunk.faceIndices, t_chunk.polygons, face);
       }
     }
+
+    // close the last segment
+    beginSegment(ObjChunk::Segment::Start::Continue, {});
+    t_chunk.segments.pop_back();
   }
 
   /*!
-   * @brief Returns the proper mesh container given a lod level or not
-   * @param t_state Internal state data to grab mesh container from
+   * @brief Splits the obj file at line boundaries and parses the chunks across the thread pool, then stitches the
+   * chunk-local records into meshes in file order, producing exactly what ParseObj() would.
+   * \n Falls back to ParseObj() for files too small to be worth splitting
+   * @param t_state Internal state data to store vertex data, its thread pool is used for the chunks
+   * @param t_buffer View over the contents of the current file, read or mapped
    * @param t_lodLevel Specified lod level, if any
-   * @return Reference to the appropriate container
    */
-  std::vector<Mesh>& GetMeshContainer(LoaderState& t_state, const unsigned int t_lodLevel) {
-    return t_state.meshes[t_lodLevel];
-  }
+  void ParseObjParallel(LoaderState& t_state, const std::string_view t_buffer, const unsigned int t_lodLevel) {
+    constexpr size_t minChunkSize = 1 << 20; // below this the per-chunk overhead outweighs the parallel speedup
 
-  /*!
-   * @brief Computes the tangent and bitangent vectors for a triangle face using its vertex positions, texture coordinates, and normal.
-   * @param t_v1 First vertex of the triangle.
-   * @param t_v2 Second vertex of the triangle.
-   * @param t_v3 Third vertex of the triangle.
-   * @return Pair of normalized tangent and bitangent vectors.
-   */
-  std::pair<glm::vec3, glm::vec3> GetTangentCoords(const Vertex& t_v1, const Vertex& t_v2, const Vertex& t_v3) {
-    // flat-shaded tangent
-    //clockwise
-    const glm::vec3 edge1    = t_v2.position - t_v1.position;
-    const glm::vec3 edge2    = t_v3.position - t_v1.position;
-    const glm::vec2 deltaUv1 = t_v2.texCoords - t_v1.texCoords;
-    const glm::vec2 deltaUv2 = t_v3.texCoords - t_v1.texCoords;
+    const size_t workers    = t_state.threadPool ? t_state.threadPool->MaxThreadCount() : 0;
+    const size_t chunkCount = std::min(workers + 1, t_buffer.size() / minChunkSize);
 
-    const float f = 1.0f / (deltaUv1.x * deltaUv2.y - deltaUv2.x * deltaUv1.y);
+    if (chunkCount < 2) {
+      ParseObj(t_state, t_buffer, t_lodLevel);
+      return;
+    }
 
-    glm::vec3 tangent   = f * (edge1 * deltaUv2.y - edge2 * deltaUv1.y);
-    glm::vec3 bitangent = f * (edge2 * deltaUv1.x - edge1 * deltaUv2.x);
+    // --- Split: every chunk ends just past a newline so no record straddles two chunks ---
+    std::vector<ObjChunk> chunks;
+    size_t                begin = 0;
 
-    // We should be storing the tangent on all three vertices of the face
+    chunks.reserve(chunkCount);
+    for (size_t i = 0; i < chunkCount; ++i) {
+      chunks.emplace_back(t_state.arena);
 
-    return {tangent, bitangent};
+      size_t end = t_buffer.size();
+      if (i + 1 < chunkCount) {
+        end = t_buffer.find('\n', std::max(begin, t_buffer.size() * (i + 1) / chunkCount));
+        end = end == std::string_view::npos ? t_buffer.size() : end + 1;
+      }
+
+      chunks[i].buffer = t_buffer.substr(begin, end - begin);
+      begin            = end;
+    }
+
+    // --- Parse: chunks are independent ---
+    t_state.threadPool->ParallelFor(chunkCount, [&] (const size_t t_i) { ParseObjChunk(chunks[t_i]); });
+
+    // relative indices can point into earlier chunks, whose sizes are only known now,
+    // so the chunks that used them are parsed again with their real file-wide element base
+    std::vector<size_t> reparse;
+    glm::uvec3          base{0};
+
+    for (size_t c = 0; c < chunkCount; ++c) {
+      if (chunks[c].relativeIndices && base != chunks[c].base) {
+        const std::string_view buffer = chunks[c].buffer;
+        chunks[c]                     = ObjChunk(t_state.arena);
+        chunks[c].buffer              = buffer;
+        chunks[c].base                = base;
+        reparse.push_back(c);
+      }
+
+      base += glm::uvec3(chunks[c].vertices.size(), chunks[c].texCoords.size(), chunks[c].normals.size());
+    }
+
+    t_state.threadPool->ParallelFor(reparse.size(), [&] (const size_t t_i) { ParseObjChunk(chunks[reparse[t_i]]); });
+
+    // --- Stitch: replay segment boundaries in file order, mirroring the state ParseObj() carries between lines ---
+    struct SegmentTarget
+    {
+      int        mesh = -1;
+      size_t     vertexOffset   = 0;
+      size_t     texCoordOffset = 0;
+      size_t     normalOffset   = 0;
+      size_t     faceOffset     = 0;
+      size_t     polygonOffset  = 0;
+      glm::uvec3 indexOffset{0};
+    };
+
+    std::vector<Mesh>&       meshes     = GetMeshContainer(t_state, t_lodLevel);
+    std::vector<TempMeshes>& tempMeshes = t_state.tempMeshes[t_lodLevel];
+
+    std::vector<std::vector<SegmentTarget>> targets(chunkCount);
+    std::vector<std::array<size_t, 5>>      meshSizes; // vertices, texCoords, normals, faceIndices, polygons
+
+    int        meshCount = -1;
+    glm::uvec3 indexOffset{0};
+    glm::uvec3 maxIndexSeen{0};
+    glm::vec2  uvMin(FLT_MAX);
+    glm::vec2  uvMax(-FLT_MAX);
+
+    unsigned int         mtlCount = 0;
+    const MaterialLookup materialLookup(t_state, t_lodLevel);
+
+    auto beginMesh = [&] (std::string t_name)
+    {
+      meshCount++;
+
+      tempMeshes.emplace_back(t_state.arena);
+      meshes.emplace_back();
+      meshSizes.emplace_back();
+      indexOffset = maxIndexSeen; // carry forward for next mesh
+
+      meshes[meshCount].name       = std::move(t_name);
+      meshes[meshCount].meshNumber = meshCount;
+      meshes[meshCount].lodLevel   = t_lodLevel;
+    };
+
+    for (size_t c = 0; c < chunkCount; ++c) {
+      if (!chunks[c].mtlFileName.empty()) {
+        t_state.mtlFileName = chunks[c].mtlFileName;
+      }
+
+      for (const ObjChunk::Segment& segment : chunks[c].segments) {
+        const bool hasData = segment.vertexEnd > segment.vertexBegin || segment.texCoordEnd > segment.texCoordBegin ||
+                             segment.normalEnd > segment.normalBegin || segment.faceEnd > segment.faceBegin;
+
+        if (segment.start == ObjChunk::Segment::Start::Object) {
+          beginMesh(segment.name);
+        }
+        // records before the first o line still need a mesh to live in
+        else if (meshCount < 0 && (hasData || segment.start == ObjChunk::Segment::Start::Material)) {
+          beginMesh({});
+        }
+
+        if (segment.start == ObjChunk::Segment::Start::Material) {
+          glm::vec2 uvRange = uvMax - uvMin;
+          bool      isTiled = (uvRange.x > 1.0f || uvRange.y > 1.0f);
+
+          // pull texture names from cached mtl data and construct ordered mesh materials
+          materialLookup.Assign(meshes[meshCount], segment.name, isTiled, mtlCount);
+
+          // reset uv count
+          uvMax = glm::vec2(-FLT_MAX);
+          uvMin = glm::vec2(FLT_MAX);
+
+          mtlCount++;
+        }
+
+        uvMin        = glm::min(uvMin, segment.uvMin);
+        uvMax        = glm::max(uvMax, segment.uvMax);
+        maxIndexSeen = glm::max(maxIndexSeen, segment.maxIndex);
+
+        SegmentTarget& target = targets[c].emplace_back();
+        if (meshCount < 0) {
+          continue; // nothing to place
+        }
+
+        // prefix sum of the segment sizes gives each segment its own disjoint range in the mesh
+        std::array<size_t, 5>& sizes = meshSizes[meshCount];
+        target.mesh                  = meshCount;
+        target.vertexOffset          = sizes[0];
+        target.texCoordOffset        = sizes[1];
+        target.normalOffset          = sizes[2];
+        target.faceOffset            = sizes[3];
+        target.polygonOffset         = sizes[4];
+        target.indexOffset           = indexOffset;
+
+        sizes[0] += segment.vertexEnd - segment.vertexBegin;
+        sizes[1] += segment.texCoordEnd - segment.texCoordBegin;
+        sizes[2] += segment.normalEnd - segment.normalBegin;
+        sizes[3] += segment.faceEnd - segment.faceBegin;
+        sizes[4] += segment.polygonEnd - segment.polygonBegin;
+
+        tempMeshes[meshCount].corners += segment.corners;
+      }
+    }
+
+    for (size_t m = 0; m < meshSizes.size(); ++m) {
+      tempMeshes[m].vertices.resize(meshSizes[m][0]);
+      tempMeshes[m].texCoords.resize(meshSizes[m][1]);
+      tempMeshes[m].normals.resize(meshSizes[m][2]);
+      tempMeshes[m].faceIndices.resize(meshSizes[m][3]);
+      tempMeshes[m].polygons.resize(meshSizes[m][4]);
+    }
+
+    // --- Copy: every segment writes its own range, so chunks can be moved into place in parallel ---
+    t_state.threadPool->ParallelFor(
+      chunkCount,
+      [&] (const size_t t_c)
+      {
+        const ObjChunk& chunk = chunks[t_c];
+
+        for (size_t i = 0; i < chunk.segments.size(); ++i) {
+          const ObjChunk::Segment& segment = chunk.segments[i];
+          const SegmentTarget&     target  = targets[t_c][i];
+          if (target.mesh < 0) {
+            continue;
+          }
+
+          TempMeshes& tempMesh = tempMeshes[target.mesh];
+
+          std::copy(
+            chunk.vertices.begin() + segment.vertexBegin,
+            chunk.vertices.begin() + segment.vertexEnd,
+            tempMesh.vertices.begin() + target.vertexOffset);
+          std::copy(
+            chunk.texCoords.begin() + segment.texCoordBegin,
+            chunk.texCoords.begin() + segment.texCoordEnd,
+            tempMesh.texCoords.begin() + target.texCoordOffset);
+          std::copy(
+            chunk.normals.begin() + segment.normalBegin,
+            chunk.normals.begin() + segment.normalEnd,
+            tempMesh.normals.begin() + target.normalOffset);
+
+          // Decrement for 0-based indices and rebase to the mesh
+          std::transform(
+            chunk.faceIndices.begin() + segment.faceBegin,
+            chunk.faceIndices.begin() + segment.faceEnd,
+            tempMesh.faceIndices.begin() + target.faceOffset,
+            [&] (const glm::uvec3 t_u) { return RebaseCorner(t_u, target.indexOffset); });
+
+          // polygons point into the chunk's faces, move them along with the faces
+          const auto faceShift = static_cast<unsigned int>(target.faceOffset - segment.faceBegin);
+          std::transform(
+            chunk.polygons.begin() + segment.polygonBegin,
+            chunk.polygons.begin() + segment.polygonEnd,
+            tempMesh.polygons.begin() + target.polygonOffset,
+            [faceShift] (const glm::uvec2 t_polygon) { return glm::uvec2(t_polygon.x + faceShift, t_polygon.y); });
+        }
+      });
   }
 
   /*!
-   * @brief Converts polygonal face data from the temporary loader state into fully defined triangles, populating each mesh with vertices and indices.
-   * @param t_state Internal state data used to grab vertex, normal, and texture coordinate data from temporary containers.
+   * @brief Pointer walks through the mtl file in a single pass and stores texture info in LoaderState
+   * @param t_state Internal state data to store texture info
+   * @param t_buffer View over the contents of the current file, read or mapped
+   * @param t_lodLevel
    */
-  void ConstructVertices(LoaderState& t_state) {
-    unsigned int baseVertex = 0;
-    unsigned int baseIndex  = 0;
-    unsigned int lodLevel   = 0;
+  void ParseMtl(LoaderState& t_state, const std::string_view t_buffer, const unsigned int& t_lodLevel) {
+    std::vector<Material>& materials = t_state.materials[t_lodLevel];
 
-    for (auto& meshes : t_state.meshes | std::views::values) {
-      for (unsigned int a = 0; a < meshes.size(); ++a) {
-        lodLevel             = meshes[a].lodLevel;
-        TempMeshes& tempMesh = t_state.tempMeshes[lodLevel][a];
-
-        for (unsigned int i = 0; i < t_state.tempMeshes[lodLevel][a].faceIndices.size(); ++i) {
-          // fetch each triangle from our face indices
-          meshes[a].vertices.emplace_back(
-            tempMesh.vertices[tempMesh.faceIndices[i].x],
-            tempMesh.normals[tempMesh.faceIndices[i].z],
-            tempMesh.texCoords[tempMesh.faceIndices[i].y]);
-          // store the indice of each triangle we create
-          meshes[a].indices.emplace_back(i);
+    const char* ptr      = t_buffer.data();
+    const char* end      = ptr + t_buffer.size();
+    int         mtlCount = -1;
+
+    // splits off the next whitespace separated token of a line
+    auto nextToken = [] (std::string_view& t_line)
+    {
+      const size_t start = std::min(t_line.find_first_not_of(" \t"), t_line.size());
+      const size_t stop  = std::min(t_line.find_first_of(" \t", start), t_line.size());
+
+      const std::string_view token = t_line.substr(start, stop - start);
+      t_line.remove_prefix(stop);
+      return token;
+    };
+
+    while (ptr < end) {
+      std::string_view       line   = NextLine(ptr, end);
+      const std::string_view prefix = nextToken(line);
+
+      if (prefix.empty() || prefix[0] == '#') {
+        continue;
+      }
+
+      const std::string_view value = nextToken(line);
+
+      if (prefix == "newmtl") {
+        materials.emplace_back(std::string(value));
+        mtlCount = static_cast<int>(materials.size() - 1);
+      }
+      else if (mtlCount >= 0) {
+        if (prefix == "map_Kd") {
+          materials[mtlCount].diffuseName = value;
+        }
+        else if (prefix == "map_Ks" || prefix == "map_Ns") {
+          materials[mtlCount].specularName = value;
+        }
+        else if (prefix == "map_Bump" || prefix == "bump") {
+          materials[mtlCount].normalName = value;
         }
+        else if (prefix == "disp") {
+          materials[mtlCount].heightName = value;
+        }
+      }
+    }
+  }
 
-        meshes[a].baseVertex = baseVertex;
-        meshes[a].baseIndex  = baseIndex;
+  /*!
+   * @brief Points the meshes at the textures of t_materials again, after their mtl was parsed anew without the obj
+   * \n Meshes keep their material name, index and tiling, which come from the obj. A material that is gone from the
+   * mtl leaves its meshes without textures, the same as a usemtl naming a material that doesn't exist
+   * @param t_meshes Meshes of one lod
+   * @param t_materials Materials of the same lod, as parsed by ParseMtl()
+   */
+  void ReassignMaterials(std::vector<Mesh>& t_meshes, const std::vector<Material>& t_materials) {
+    for (auto& mesh : t_meshes) {
+      if (mesh.material.name.empty()) {
+        continue;
+      }
 
-        baseVertex += meshes[a].vertices.size();
-        baseIndex += meshes[a].indices.size();
+      // the last definition wins, like the lookup in ParseObj()
+      const Material* found = nullptr;
+      for (const auto& material : t_materials) {
+        if (material.name == mesh.material.name) {
+          found = &material;
+        }
       }
+
+      Material material = found ? *found : Material{};
+
+      material.name    = mesh.material.name;
+      material.isTiled = mesh.material.isTiled;
+      material.index   = mesh.material.index;
+      mesh.material    = std::move(material);
     }
   }
 
   /*!
-   * @brief Calculates per-vertex tangent and bitangent vectors for all meshes, used in tangent-space normal mapping. Accumulates contributions from each face and normalizes the results.
-   * @param t_state
+   * @brief Points the meshes at the ids of a shared library again, the Flag::SharedMaterials version of the above
+   * @param t_meshes Meshes of one lod
+   * @param t_library Library of the same lod, as returned by MaterialRegistry::Load()
    */
-  void CalcTangentSpace(LoaderState& t_state) {
-    for (auto& meshes : t_state.meshes | std::views::values) {
-      for (auto& mesh : meshes) {
-        std::vector bitangents(mesh.vertices.size(), glm::vec3(0.0f));
+  void ReassignMaterials(std::vector<Mesh>& t_meshes, const MaterialLibrary& t_library) {
+    for (auto& mesh : t_meshes) {
+      if (mesh.material.name.empty()) {
+        continue;
+      }
+
+      const auto it   = t_library.byName.find(mesh.material.name);
+      mesh.materialId = it != t_library.byName.end() ? it->second : NO_MATERIAL;
+    }
+  }
+
+  /*!
+   * @brief Loads the library of every lod through the state's registry and points the meshes at it, used for meshes
+   * that didn't come from a parse, such as cache reads, since ids are only meaningful within one registry
+   * @param t_state Internal state data with file paths, meshes and the registry
+   */
+  void LoadSharedMaterials(LoaderState& t_state) {
+    if (!t_state.materialRegistry) {
+      return;
+    }
+
+    for (const auto& file : t_state.filePaths) {
+      const auto library = t_state.materialRegistry->Load(file.mtlPath, &t_state.stats.bytesRead);
+      if (auto it = t_state.meshes.find(file.lodLevel); it != t_state.meshes.end()) {
+        ReassignMaterials(it->second, *library);
+      }
+    }
+
+    for (const auto& [lodLevel, meshes] : t_state.meshes) {
+      SyncDrawRangeMaterials(t_state.combinedMeshes, meshes, lodLevel);
+    }
+  }
+
+  /*!
+   * @brief Copies the material ids of one lod's meshes to the draw ranges of its combined mesh, after they were
+   * reassigned. Draw ranges follow their lod's meshes in order, see CombineMeshes()
+   * @param t_combinedMeshes Combined meshes of the model, nothing happens if none is of t_lodLevel
+   * @param t_meshes Meshes of the lod
+   * @param t_lodLevel Lod of t_meshes
+   */
+  void SyncDrawRangeMaterials(std::vector<Mesh>& t_combinedMeshes, const std::vector<Mesh>& t_meshes, const unsigned int t_lodLevel) {
+    const auto combined = std::ranges::find(t_combinedMeshes, t_lodLevel, &Mesh::lodLevel);
+    if (combined == t_combinedMeshes.end()) {
+      return;
+    }
+
+    for (size_t i = 0; i < t_meshes.size() && i < combined->drawRanges.size(); ++i) {
+      combined->drawRanges[i].materialId = t_meshes[i].materialId;
+    }
+  }
+
+  /*!
+   * @brief Returns the proper mesh container given a lod level or not
+   * @param t_state Internal state data to grab mesh container from
+   * @param t_lodLevel Specified lod level, if any
+   * @return Reference to the appropriate container
+   */
+  std::vector<Mesh>& GetMeshContainer(LoaderState& t_state, const unsigned int t_lodLevel) {
+    return t_state.meshes[t_lodLevel];
+  }
+
+  /*!
+   * @brief Computes the tangent and bitangent vectors for a triangle face using its vertex positions, texture coordinates, and normal.
+   * @param t_v1 First vertex of the triangle.
+   * @param t_v2 Second vertex of the triangle.
+   * @param t_v3 Third vertex of the triangle.
+   * @return Pair of normalized tangent and bitangent vectors.
+   */
+  std::pair<glm::vec3, glm::vec3> GetTangentCoords(const Vertex& t_v1, const Vertex& t_v2, const Vertex& t_v3) {
+    // flat-shaded tangent
+    //clockwise
+    const glm::vec3 edge1    = t_v2.position - t_v1.position;
+    const glm::vec3 edge2    = t_v3.position - t_v1.position;
+    const glm::vec2 deltaUv1 = t_v2.texCoords - t_v1.texCoords;
+    const glm::vec2 deltaUv2 = t_v3.texCoords - t_v1.texCoords;
+
+    const float f = 1.0f / (deltaUv1.x * deltaUv2.y - deltaUv2.x * deltaUv1.y);
+
+    glm::vec3 tangent   = f * (edge1 * deltaUv2.y - edge2 * deltaUv1.y);
+    glm::vec3 bitangent = f * (edge2 * deltaUv1.x - edge1 * deltaUv2.x);
+
+    // We should be storing the tangent on all three vertices of the face
+
+    return {tangent, bitangent};
+  }
+
+  namespace
+  {
+    /*!
+     * @brief Calls t_f(mesh, meshIndex) for every mesh of every lod, spread across the state's thread pool if it has one.
+     * \n Meshes are independent, so every stage that only touches one mesh at a time can go through here
+     * @param t_state Internal state data with the meshes and thread pool
+     * @param t_f Callable taking the mesh and its index inside its lod
+     */
+    template <typename F>
+    void ForEachMesh(LoaderState& t_state, F&& t_f) {
+      std::vector<std::pair<Mesh*, unsigned int>> meshes;
+      for (auto& lod : t_state.meshes | std::views::values) {
+        for (unsigned int a = 0; a < lod.size(); ++a) {
+          meshes.emplace_back(&lod[a], a);
+        }
+      }
+
+      auto run = [&] (const size_t t_i) { t_f(*meshes[t_i].first, meshes[t_i].second); };
+
+      if (t_state.threadPool) {
+        t_state.threadPool->ParallelFor(meshes.size(), run);
+      }
+      else {
+        for (size_t i = 0; i < meshes.size(); ++i) {
+          run(i);
+        }
+      }
+    }
+
+    // area weighted normal of a triangle, its length is twice the area
+    glm::vec3 FaceNormal(const glm::vec3& t_a, const glm::vec3& t_b, const glm::vec3& t_c) {
+      return glm::cross(t_b - t_a, t_c - t_a);
+    }
+
+    glm::vec3 NormalizeOrZero(const glm::vec3& t_v) {
+      const float length = glm::length(t_v);
+      return length > 0.0f ? t_v / length : glm::vec3(0.0f);
+    }
+
+    /*!
+     * @brief Gives vertices without a normal the sum of the normals of their faces, a vertex of one face gets a flat
+     * normal, a corner shared by JoinIndices a smooth one
+     * @param t_mesh Mesh with vertices and indices
+     * @param t_onlyZero Only fill vertices whose normal is zero, the ones a face left without a vn, instead of all
+     */
+    void GenerateNormals(Mesh& t_mesh, const bool t_onlyZero) {
+      std::vector<glm::vec3> sums(t_mesh.vertices.size(), glm::vec3(0.0f));
+
+      for (size_t i = 0; i + 2 < t_mesh.indices.size(); i += 3) {
+        const unsigned int a = t_mesh.indices[i], b = t_mesh.indices[i + 1], c = t_mesh.indices[i + 2];
+        const glm::vec3    n = FaceNormal(t_mesh.vertices[a].position, t_mesh.vertices[b].position, t_mesh.vertices[c].position);
+        sums[a] += n;
+        sums[b] += n;
+        sums[c] += n;
+      }
+
+      for (size_t i = 0; i < sums.size(); ++i) {
+        if (!t_onlyZero || t_mesh.vertices[i].packedNormal == 0) {
+          t_mesh.vertices[i].packedNormal = Vertex::PackNormal_2_10_10_10_REV(NormalizeOrZero(sums[i]));
+        }
+      }
+    }
+
+    /*!
+     * @brief Points the corners that left out a vt or vn at a default element appended to the mesh, so a mesh where
+     * only some faces have them still goes through the path that reads them without a check per corner
+     */
+    void FillMissingCorners(TempMeshes& t_tempMesh, const bool t_texCoords, const bool t_normals) {
+      const auto texCoord = static_cast<unsigned int>(t_tempMesh.texCoords.size());
+      const auto normal   = static_cast<unsigned int>(t_tempMesh.normals.size());
+
+      if (t_texCoords) {
+        t_tempMesh.texCoords.emplace_back(0.0f);
+      }
+      if (t_normals) {
+        t_tempMesh.normals.emplace_back(0.0f); // packs to 0, which GenerateNormals() fills in later
+      }
+
+      for (glm::uvec3& corner : t_tempMesh.faceIndices) {
+        if (t_texCoords && corner.y == NO_INDEX) {
+          corner.y = texCoord;
+        }
+        if (t_normals && corner.z == NO_INDEX) {
+          corner.z = normal;
+        }
+      }
+    }
+
+    /*!
+     * @brief Builds the vertices and indices of one mesh, one instance per combination of attributes the mesh has so
+     * the loop over its corners never checks for them. Attributes a mesh lacks are zero, missing normals are generated
+     * flat per triangle on the fly, or smooth over the shared corners of JoinIndices
+     */
+    template <bool TexCoords, bool Normals>
+    void BuildMeshVertices(const TempMeshes& t_tempMesh, Mesh& t_mesh, const bool t_joinIndices) {
+      static constexpr unsigned int NO_CORNER = UINT32_MAX;
+
+      auto makeVertex = [&t_tempMesh] (const glm::uvec3& t_corner, const glm::vec3& t_normal)
+      {
+        if constexpr (TexCoords) {
+          return Vertex(t_tempMesh.vertices[t_corner.x], t_normal, t_tempMesh.texCoords[t_corner.y]);
+        }
+        else {
+          return Vertex(t_tempMesh.vertices[t_corner.x], t_normal, glm::vec2(0.0f));
+        }
+      };
+
+      auto normalOf = [&t_tempMesh] (const glm::uvec3& t_corner)
+      {
+        if constexpr (Normals) {
+          return t_tempMesh.normals[t_corner.z];
+        }
+        else {
+          return glm::vec3(0.0f);
+        }
+      };
+
+      const auto& faces = t_tempMesh.faceIndices;
+      t_mesh.indices.reserve(faces.size());
+
+      if (t_joinIndices) {
+        std::vector<unsigned int> firstCorner(t_tempMesh.vertices.size(), NO_CORNER); // most recent unique corner per position index
+        std::vector<unsigned int> nextCorner; // previous unique corner sharing the same position index
+        std::vector<glm::uvec3>   corners;    // face index triple of each unique corner
+
+        for (const auto& face : faces) {
+          // walk the few corners that share this position until the uv and normal match too
+          unsigned int id = firstCorner[face.x];
+          while (id != NO_CORNER && ((TexCoords && corners[id].y != face.y) || (Normals && corners[id].z != face.z))) {
+            id = nextCorner[id];
+          }
+
+          if (id == NO_CORNER) {
+            id = static_cast<unsigned int>(corners.size());
+            corners.push_back(face);
+            nextCorner.push_back(firstCorner[face.x]);
+            firstCorner[face.x] = id;
+
+            t_mesh.vertices.push_back(makeVertex(face, normalOf(face)));
+          }
+
+          t_mesh.indices.emplace_back(id);
+        }
+
+        if constexpr (!Normals) {
+          GenerateNormals(t_mesh, false);
+        }
+      }
+      else {
+        t_mesh.vertices.reserve(faces.size());
+
+        // fetch each triangle from our face indices
+        for (size_t i = 0; i + 2 < faces.size(); i += 3) {
+          if constexpr (Normals) {
+            t_mesh.vertices.push_back(makeVertex(faces[i], normalOf(faces[i])));
+            t_mesh.vertices.push_back(makeVertex(faces[i + 1], normalOf(faces[i + 1])));
+            t_mesh.vertices.push_back(makeVertex(faces[i + 2], normalOf(faces[i + 2])));
+          }
+          else {
+            const glm::vec3& a = t_tempMesh.vertices[faces[i].x];
+            const glm::vec3& b = t_tempMesh.vertices[faces[i + 1].x];
+            const glm::vec3& c = t_tempMesh.vertices[faces[i + 2].x];
+            const glm::vec3  n = NormalizeOrZero(FaceNormal(a, b, c));
+
+            t_mesh.vertices.push_back(makeVertex(faces[i], n));
+            t_mesh.vertices.push_back(makeVertex(faces[i + 1], n));
+            t_mesh.vertices.push_back(makeVertex(faces[i + 2], n));
+          }
+
+          // store the indice of each triangle we create
+          const auto first = static_cast<unsigned int>(i);
+          t_mesh.indices.insert(t_mesh.indices.end(), {first, first + 1, first + 2});
+        }
+      }
+    }
 
-        // accumulate
-        for (size_t i = 0; i < mesh.indices.size(); i += 3) {
-          Vertex& v0 = mesh.vertices[mesh.indices[i]];
-          Vertex& v1 = mesh.vertices[mesh.indices[i + 1]];
-          Vertex& v2 = mesh.vertices[mesh.indices[i + 2]];
+    /*!
+     * @brief Picks the BuildMeshVertices() path by which attributes the faces of a mesh refer to
+     * \n A mesh where only some faces have a vt or vn goes through the path with them, its other corners read a zero
+     * default, and zero normals are generated afterwards
+     */
+    void ConstructMeshVertices(TempMeshes& t_tempMesh, Mesh& t_mesh, const bool t_joinIndices) {
+      const CornerCounts& counts    = t_tempMesh.corners;
+      const bool          texCoords = counts.noTexCoord < counts.corners && !t_tempMesh.texCoords.empty();
+      const bool          normals   = counts.noNormal < counts.corners && !t_tempMesh.normals.empty();
+
+      const bool someTexCoords = texCoords && counts.noTexCoord > 0;
+      const bool someNormals   = normals && counts.noNormal > 0;
+      if (someTexCoords || someNormals) {
+        FillMissingCorners(t_tempMesh, someTexCoords, someNormals);
+      }
+
+      if (texCoords) {
+        normals ? BuildMeshVertices<true, true>(t_tempMesh, t_mesh, t_joinIndices)
+                : BuildMeshVertices<true, false>(t_tempMesh, t_mesh, t_joinIndices);
+      }
+      else {
+        normals ? BuildMeshVertices<false, true>(t_tempMesh, t_mesh, t_joinIndices)
+                : BuildMeshVertices<false, false>(t_tempMesh, t_mesh, t_joinIndices);
+      }
+
+      if (someNormals) {
+        GenerateNormals(t_mesh, true);
+      }
+    }
+
+    // four float lanes, SSE2 or AArch64 NEON when available and plain scalar code otherwise
+    struct Float4
+    {
+#if defined(OBJ_SIMD_SSE2)
+      __m128 v;
+
+      static Float4 Load(const float* t_p) { return {_mm_load_ps(t_p)}; }
+      static Float4 Set(const float t_f) { return {_mm_set1_ps(t_f)}; }
+      void          Store(float* t_p) const { _mm_store_ps(t_p, v); }
+
+      friend Float4 operator+(const Float4 t_a, const Float4 t_b) { return {_mm_add_ps(t_a.v, t_b.v)}; }
+      friend Float4 operator-(const Float4 t_a, const Float4 t_b) { return {_mm_sub_ps(t_a.v, t_b.v)}; }
+      friend Float4 operator*(const Float4 t_a, const Float4 t_b) { return {_mm_mul_ps(t_a.v, t_b.v)}; }
+      friend Float4 operator/(const Float4 t_a, const Float4 t_b) { return {_mm_div_ps(t_a.v, t_b.v)}; }
+      friend Float4 Sqrt(const Float4 t_a) { return {_mm_sqrt_ps(t_a.v)}; }
+#elif defined(OBJ_SIMD_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+      float32x4_t v;
+
+      static Float4 Load(const float* t_p) { return {vld1q_f32(t_p)}; }
+      static Float4 Set(const float t_f) { return {vdupq_n_f32(t_f)}; }
+      void          Store(float* t_p) const { vst1q_f32(t_p, v); }
+
+      friend Float4 operator+(const Float4 t_a, const Float4 t_b) { return {vaddq_f32(t_a.v, t_b.v)}; }
+      friend Float4 operator-(const Float4 t_a, const Float4 t_b) { return {vsubq_f32(t_a.v, t_b.v)}; }
+      friend Float4 operator*(const Float4 t_a, const Float4 t_b) { return {vmulq_f32(t_a.v, t_b.v)}; }
+      friend Float4 operator/(const Float4 t_a, const Float4 t_b) { return {vdivq_f32(t_a.v, t_b.v)}; }
+      friend Float4 Sqrt(const Float4 t_a) { return {vsqrtq_f32(t_a.v)}; }
+#else
+      std::array<float, 4> v;
+
+      static Float4 Load(const float* t_p) { return {{t_p[0], t_p[1], t_p[2], t_p[3]}}; }
+      static Float4 Set(const float t_f) { return {{t_f, t_f, t_f, t_f}}; }
+      void          Store(float* t_p) const { std::memcpy(t_p, v.data(), sizeof(v)); }
+
+      template <typename Op>
+      static Float4 Apply(const Float4 t_a, const Float4 t_b, Op t_op) {
+        return {{t_op(t_a.v[0], t_b.v[0]), t_op(t_a.v[1], t_b.v[1]), t_op(t_a.v[2], t_b.v[2]), t_op(t_a.v[3], t_b.v[3])}};
+      }
 
-          const auto&& [tangent, bitangent] = GetTangentCoords(v0, v1, v2);
+      friend Float4 operator+(const Float4 t_a, const Float4 t_b) { return Apply(t_a, t_b, std::plus<>()); }
+      friend Float4 operator-(const Float4 t_a, const Float4 t_b) { return Apply(t_a, t_b, std::minus<>()); }
+      friend Float4 operator*(const Float4 t_a, const Float4 t_b) { return Apply(t_a, t_b, std::multiplies<>()); }
+      friend Float4 operator/(const Float4 t_a, const Float4 t_b) { return Apply(t_a, t_b, std::divides<>()); }
+      friend Float4 Sqrt(const Float4 t_a) { return {{std::sqrt(t_a.v[0]), std::sqrt(t_a.v[1]), std::sqrt(t_a.v[2]), std::sqrt(t_a.v[3])}}; }
+#endif
+    };
+
+    // SoA lanes of one batch of values, aligned for Float4 loads and stores
+    struct alignas(16) Lanes
+    {
+      float x[4], y[4], z[4];
+
+      [[nodiscard]] Float4 X() const { return Float4::Load(x); }
+      [[nodiscard]] Float4 Y() const { return Float4::Load(y); }
+      [[nodiscard]] Float4 Z() const { return Float4::Load(z); }
+
+      void Store(const Float4 t_x, const Float4 t_y, const Float4 t_z) {
+        t_x.Store(x);
+        t_y.Store(y);
+        t_z.Store(z);
+      }
+    };
 
-          const float lenT = glm::length(tangent);
-          const float lenB = glm::length(bitangent);
+    Float4 Dot(const Float4 t_ax, const Float4 t_ay, const Float4 t_az, const Float4 t_bx, const Float4 t_by,
+               const Float4 t_bz) {
+      return t_ax * t_bx + t_ay * t_by + t_az * t_bz;
+    }
 
+    /*!
+     * @brief Vectorized equivalent of GetTangentCoords plus the per-vertex Gram-Schmidt pass, four triangles or
+     * vertices per step. Triangles are gathered into SoA lanes, their weighted tangents and bitangents scattered into
+     * SoA accumulators in triangle order, and every lane op mirrors the scalar glm math so results don't change
+     * @param t_mesh Mesh whose vertex tangents are calculated in place
+     */
+    void CalcMeshTangentSpace(Mesh& t_mesh) {
+      static constexpr size_t W = 4;
+
+      const size_t vertexCount = t_mesh.vertices.size();
+
+      // accumulators start from the current tangents, like the scalar += did
+      std::vector<float> tanX(vertexCount), tanY(vertexCount), tanZ(vertexCount), tanW(vertexCount);
+      std::vector<float> bitX(vertexCount, 0.0f), bitY(vertexCount, 0.0f), bitZ(vertexCount, 0.0f);
+
+      for (size_t i = 0; i < vertexCount; ++i) {
+        const glm::vec4& t = t_mesh.vertices[i].tangent;
+        tanX[i]            = t.x;
+        tanY[i]            = t.y;
+        tanZ[i]            = t.z;
+        tanW[i]            = t.w;
+      }
+
+      const size_t triangleCount = t_mesh.indices.size() / 3;
+
+      for (size_t tri = 0; tri < triangleCount; tri += W) {
+        const size_t lanes = std::min(W, triangleCount - tri);
+
+        Lanes        p0, p1, p2;
+        alignas(16) float u0[W], v0[W], u1[W], v1[W], u2[W], v2[W];
+
+        // gather, padding lanes repeat the first triangle and are never scattered
+        for (size_t l = 0; l < W; ++l) {
+          const size_t   base = (tri + (l < lanes ? l : 0)) * 3;
+          const Vertex&  a    = t_mesh.vertices[t_mesh.indices[base]];
+          const Vertex&  b    = t_mesh.vertices[t_mesh.indices[base + 1]];
+          const Vertex&  c    = t_mesh.vertices[t_mesh.indices[base + 2]];
+
+          p0.x[l] = a.position.x, p0.y[l] = a.position.y, p0.z[l] = a.position.z;
+          p1.x[l] = b.position.x, p1.y[l] = b.position.y, p1.z[l] = b.position.z;
+          p2.x[l] = c.position.x, p2.y[l] = c.position.y, p2.z[l] = c.position.z;
+          u0[l]   = a.texCoords.x, v0[l] = a.texCoords.y;
+          u1[l]   = b.texCoords.x, v1[l] = b.texCoords.y;
+          u2[l]   = c.texCoords.x, v2[l] = c.texCoords.y;
+        }
+
+        const Float4 e1x = p1.X() - p0.X(), e1y = p1.Y() - p0.Y(), e1z = p1.Z() - p0.Z();
+        const Float4 e2x = p2.X() - p0.X(), e2y = p2.Y() - p0.Y(), e2z = p2.Z() - p0.Z();
+        const Float4 du1 = Float4::Load(u1) - Float4::Load(u0), dv1 = Float4::Load(v1) - Float4::Load(v0);
+        const Float4 du2 = Float4::Load(u2) - Float4::Load(u0), dv2 = Float4::Load(v2) - Float4::Load(v0);
+
+        const Float4 f = Float4::Set(1.0f) / (du1 * dv2 - du2 * dv1);
+
+        const Float4 tx = f * (e1x * dv2 - e2x * dv1), ty = f * (e1y * dv2 - e2y * dv1), tz = f * (e1z * dv2 - e2z * dv1);
+        const Float4 bx = f * (e2x * du1 - e1x * du2), by = f * (e2y * du1 - e1y * du2), bz = f * (e2z * du1 - e1z * du2);
+
+        // cross(edge1, edge2)
+        const Float4 cx = e1y * e2z - e2y * e1z, cy = e1z * e2x - e2z * e1x, cz = e1x * e2y - e2x * e1y;
+
+        const Float4 area = Sqrt(Dot(cx, cy, cz, cx, cy, cz)) * Float4::Set(0.5f);
+
+        Lanes                weightedT, weightedB;
+        alignas(16) float    lenT[W], lenB[W], weightedW[W];
+        weightedT.Store(tx * area, ty * area, tz * area);
+        weightedB.Store(bx * area, by * area, bz * area);
+        (Float4::Set(0.0f) * area).Store(weightedW);
+        Sqrt(Dot(tx, ty, tz, tx, ty, tz)).Store(lenT);
+        Sqrt(Dot(bx, by, bz, bx, by, bz)).Store(lenB);
+
+        // scatter in triangle order so the accumulation order matches a scalar pass
+        for (size_t l = 0; l < lanes; ++l) {
           // skip degenerate tri
-          if (!std::isfinite(lenT) || lenT < 1e-10f || !std::isfinite(lenB) || lenB < 1e-10f) {
+          if (!std::isfinite(lenT[l]) || lenT[l] < 1e-10f || !std::isfinite(lenB[l]) || lenB[l] < 1e-10f) {
             continue;
           }
 
-          const float area = glm::length(glm::cross(v1.position - v0.position, v2.position - v0.position)) * 0.5f;
+          for (size_t corner = 0; corner < 3; ++corner) {
+            const unsigned int idx = t_mesh.indices[(tri + l) * 3 + corner];
 
-          v0.tangent += glm::vec4(tangent, 0.0f) * area;
-          bitangents[mesh.indices[i]] += bitangent * area;
-          v1.tangent += glm::vec4(tangent, 0.0f) * area;
-          bitangents[mesh.indices[i + 1]] += bitangent * area;
-          v2.tangent += glm::vec4(tangent, 0.0f) * area;
-          bitangents[mesh.indices[i + 2]] += bitangent * area;
+            tanX[idx] += weightedT.x[l];
+            tanY[idx] += weightedT.y[l];
+            tanZ[idx] += weightedT.z[l];
+            tanW[idx] += weightedW[l];
+            bitX[idx] += weightedB.x[l];
+            bitY[idx] += weightedB.y[l];
+            bitZ[idx] += weightedB.z[l];
+          }
         }
+      }
 
-        for (size_t i = 0; i < mesh.vertices.size(); ++i) {
-          auto& v = mesh.vertices[i];
+      // orthogonalize and pick handedness, four vertices per step
+      for (size_t first = 0; first < vertexCount; first += W) {
+        const size_t lanes = std::min(W, vertexCount - first);
 
-          glm::vec3 n = Vertex::UnpackNormal_2_10_10_10_REV(v.packedNormal);
+        Lanes             n, t, b;
+        alignas(16) float w[W];
+
+        for (size_t l = 0; l < W; ++l) {
+          const size_t    i      = first + (l < lanes ? l : 0);
+          const glm::vec3 normal = Vertex::UnpackNormal_2_10_10_10_REV(t_mesh.vertices[i].packedNormal);
+
+          n.x[l] = normal.x, n.y[l] = normal.y, n.z[l] = normal.z;
+          t.x[l] = tanX[i], t.y[l] = tanY[i], t.z[l] = tanZ[i], w[l] = tanW[i];
+          b.x[l] = bitX[i], b.y[l] = bitY[i], b.z[l] = bitZ[i];
+        }
 
-          glm::vec3 t(1, 0, 0);
+        const Float4 nx = n.X(), ny = n.Y(), nz = n.Z();
+        const Float4 tx = t.X(), ty = t.Y(), tz = t.Z(), tw = Float4::Load(w);
 
-          if (glm::length(v.tangent) > 1e-10f) {
-            // Gram-Schmidt orthogonalize
-            t = glm::normalize(glm::vec3(v.tangent) - n * glm::dot(n, glm::vec3(v.tangent)));
+        // Gram-Schmidt orthogonalize, normalize is x * inversesqrt(dot(x, x))
+        const Float4 d  = Dot(nx, ny, nz, tx, ty, tz);
+        const Float4 ox = tx - nx * d, oy = ty - ny * d, oz = tz - nz * d;
+        const Float4 inv = Float4::Set(1.0f) / Sqrt(Dot(ox, oy, oz, ox, oy, oz));
+
+        Lanes             ortho;
+        alignas(16) float lenTangent[W];
+        ortho.Store(ox * inv, oy * inv, oz * inv);
+        Sqrt(tx * tx + ty * ty + (tz * tz + tw * tw)).Store(lenTangent);
+
+        // vertices without any tangent contribution fall back to +x
+        for (size_t l = 0; l < W; ++l) {
+          if (!(lenTangent[l] > 1e-10f)) {
+            ortho.x[l] = 1.0f, ortho.y[l] = 0.0f, ortho.z[l] = 0.0f;
           }
+        }
+
+        const Float4 rx = ortho.X(), ry = ortho.Y(), rz = ortho.Z();
+
+        // Handedness from unnormalized bitangent
+        alignas(16) float side[W];
+        Dot(ny * rz - ry * nz, nz * rx - rz * nx, nx * ry - rx * ny, b.X(), b.Y(), b.Z()).Store(side);
 
-          // Handedness from unnormalized bitangent
-          const float handedness = (glm::dot(glm::cross(n, t), bitangents[i]) < 0.0f) ? -1.0f : 1.0f;
+        for (size_t l = 0; l < lanes; ++l) {
+          t_mesh.vertices[first + l].tangent = glm::vec4(ortho.x[l], ortho.y[l], ortho.z[l], side[l] < 0.0f ? -1.0f : 1.0f);
+        }
+      }
+    }
 
-          v.tangent = glm::vec4(t, handedness);
+    // where the final data of a mesh is written, its own vectors or a caller's grant
+    struct BufferTarget
+    {
+      Vertex*           vertices   = nullptr;
+      glm::vec3*        positions  = nullptr;
+      VertexAttributes* attributes = nullptr;
+      unsigned int*     indices    = nullptr;
+      std::uint16_t*    indices16  = nullptr; // instead of indices for meshes with Mesh::indices16
+      std::byte*        packed     = nullptr; // instead of vertices for any LoaderState::vertexFormat but Full
+    };
+
+    /*!
+     * @brief Asks the load's allocator for the memory of one mesh and checks that the grant can hold it
+     * @param t_state State with the allocator and flags of the load
+     * @param t_mesh Mesh whose data is about to be written, only its counts are still missing
+     * @param t_vertexCount Vertices to write, interleaved or split by the load's flags
+     * @param t_indexCount Indices to write
+     * @param t_indexSize Bytes per index, 4 or 2
+     * @param t_buffer Receives the handle and counts of the grant
+     * @return Pointers into the grant
+     */
+    BufferTarget RequestBuffers(const LoaderState& t_state,
+                                const Mesh&        t_mesh,
+                                const size_t       t_vertexCount,
+                                const size_t       t_indexCount,
+                                const size_t       t_indexSize,
+                                MeshBuffer&        t_buffer) {
+      const bool split = (t_state.flags & Flag::SplitStreams) == Flag::SplitStreams;
+      if (split && t_state.vertexFormat != VertexFormat::Full) {
+        throw std::runtime_error("Vertex formats other than Full need interleaved vertices, not Flag::SplitStreams");
+      }
+
+      const BufferRequest request{
+        .path = t_state.path,
+        .mesh = t_mesh,
+        .format = t_state.vertexFormat,
+        .vertexBytes = t_vertexCount * (split ? sizeof(glm::vec3) : VertexFormatSize(t_state.vertexFormat)),
+        .attributeBytes = split ? t_vertexCount * sizeof(VertexAttributes) : 0,
+        .indexBytes = t_indexCount * t_indexSize
+      };
+
+      const BufferGrant grant = t_state.bufferAllocator(request);
+
+      auto check = [&] (const std::span<std::byte> t_span, const size_t t_bytes)
+      {
+        if (t_span.size() < t_bytes || (t_bytes > 0 && reinterpret_cast<std::uintptr_t>(t_span.data()) % 4 != 0)) {
+          throw std::runtime_error("Buffer grant too small or misaligned for mesh: " + t_mesh.name);
         }
+        return t_bytes > 0 ? t_span.data() : nullptr;
+      };
+
+      std::byte* vertices   = check(grant.vertices, request.vertexBytes);
+      std::byte* attributes = check(grant.attributes, request.attributeBytes);
+      std::byte* indices    = check(grant.indices, request.indexBytes);
+
+      t_buffer = {.handle = grant.handle, .firstVertex = 0, .firstIndex = 0, .vertexCount = t_vertexCount,
+                  .indexCount = t_indexCount, .indexSize = static_cast<std::uint8_t>(t_indexSize),
+                  .format = t_state.vertexFormat, .quantization = {}};
+
+      // the caller's memory holds no objects yet, every element is constructed in place by the copies
+      BufferTarget target;
+      if (split) {
+        target.positions  = reinterpret_cast<glm::vec3*>(vertices);
+        target.attributes = reinterpret_cast<VertexAttributes*>(attributes);
+      }
+      else if (t_state.vertexFormat != VertexFormat::Full) {
+        target.packed = vertices;
       }
+      else {
+        target.vertices = reinterpret_cast<Vertex*>(vertices);
+      }
+      if (t_indexSize == sizeof(std::uint16_t)) {
+        target.indices16 = reinterpret_cast<std::uint16_t*>(indices);
+      }
+      else {
+        target.indices = reinterpret_cast<unsigned int*>(indices);
+      }
+      return target;
+    }
+
+    // drops the data of a mesh that was written elsewhere, its counts live on in Mesh::buffer
+    void ReleaseBuffers(Mesh& t_mesh) {
+      t_mesh.vertices   = {};
+      t_mesh.positions  = {};
+      t_mesh.attributes = {};
+      t_mesh.indices    = {};
+      t_mesh.indices16  = {};
     }
   }
 
   /*!
-   * @brief Deduplicates vertices with identical pos, uv and normal data
-   * @param t_state
+   * @brief Lays the meshes of every lod out back to back, in lod and mesh order, as if they shared one vertex and one
+   * index buffer, and stores where each one starts in its baseVertex and baseIndex
+   * @param t_state Internal state data with the meshes
    */
-  void JoinIdenticalVertices(LoaderState& t_state) {
-    unsigned int baseVertex = 0;
-    unsigned int baseIndex  = 0;
+  void AssignBaseOffsets(LoaderState& t_state) {
+    size_t baseVertex = 0;
+    size_t baseIndex  = 0;
 
     for (auto& meshes : t_state.meshes | std::views::values) {
       for (auto& mesh : meshes) {
-        if (mesh.vertices.empty()) {
-          continue;
-        }
+        mesh.baseVertex = baseVertex;
+        mesh.baseIndex  = baseIndex;
 
-        std::unordered_map<Vertex, unsigned int, VertexHasher, VertexEqual> uniqueVertices;
-        uniqueVertices.reserve(mesh.vertices.size());
+        baseVertex += mesh.VertexCount();
+        baseIndex += mesh.IndexCount();
+      }
+    }
+  }
 
-        std::vector<unsigned int> newIndices;
-        newIndices.reserve(mesh.indices.size());
+  /*!
+   * @brief Converts polygonal face data from the temporary loader state into fully defined triangles, populating each mesh with vertices and indices.
+   * \n Polygons that aren't convex are ear clipped first, faces without a vt or vn take a cheaper path per mesh.
+   * \n With Flag::JoinIndices every unique (v, vt, vn) corner is emitted once instead of once per face corner.
+   * \n Meshes are constructed in parallel across the thread pool
+   * @param t_state Internal state data used to grab vertex, normal, and texture coordinate data from temporary containers.
+   */
+  void ConstructVertices(LoaderState& t_state) {
+    const bool joinIndices = (t_state.flags & Flag::JoinIndices) == Flag::JoinIndices;
 
-        std::vector<Vertex> newVertices;
-        newVertices.reserve(mesh.indices.size());
+    ForEachMesh(
+      t_state,
+      [&] (Mesh& t_mesh, const unsigned int t_meshIndex)
+      {
+        // lookups only, no worker inserts into the map
+        TempMeshes& tempMesh = t_state.tempMeshes.at(t_mesh.lodLevel)[t_meshIndex];
 
-        for (const auto idx : mesh.indices) {
-          const Vertex& v  = mesh.vertices[idx];
-          auto          it = uniqueVertices.find(v);
+        if (!tempMesh.polygons.empty()) {
+          TriangulatePolygons(tempMesh);
+        }
+        ConstructMeshVertices(tempMesh, t_mesh, joinIndices);
+      });
 
-          if (it == uniqueVertices.end()) {
-            const unsigned int newIndex = static_cast<unsigned int>(newVertices.size());
-            uniqueVertices.emplace(v, newIndex);
-            newVertices.push_back(v);
-            newIndices.push_back(newIndex);
-          }
-          else {
-            newIndices.push_back(it->second);
-          }
+    AssignBaseOffsets(t_state);
+  }
+
+  /*!
+   * @brief Calculates per-vertex tangent and bitangent vectors for all meshes, used in tangent-space normal mapping. Accumulates contributions from each face and normalizes the results.
+   * \n Meshes are processed in parallel across the thread pool
+   * @param t_state
+   */
+  void CalcTangentSpace(LoaderState& t_state) {
+    ForEachMesh(t_state, [] (Mesh& t_mesh, unsigned int) { CalcMeshTangentSpace(t_mesh); });
+  }
+
+  /*!
+   * @brief Deduplicates vertices with identical pos, uv and normal data
+   * \n Meshes are welded independently across the thread pool, each worker reusing its own VertexWelder tables
+   * @param t_state
+   */
+  void JoinIdenticalVertices(LoaderState& t_state) {
+    ForEachMesh(
+      t_state,
+      [] (Mesh& t_mesh, unsigned int)
+      {
+        if (!t_mesh.vertices.empty()) {
+          thread_local VertexWelder welder;
+          welder.Weld(t_mesh);
         }
+      });
 
-        mesh.indices.swap(newIndices);
-        mesh.vertices.swap(newVertices);
+    AssignBaseOffsets(t_state);
+  }
 
-        // update offsets
-        mesh.baseVertex = baseVertex;
-        mesh.baseIndex  = baseIndex;
+  /*!
+   * @brief Generates a simplified copy of lod 0 for every entry of t_state.lodRatios, entry i filling lod level i + 1.
+   * \n Levels that were loaded from a file of their own are kept as they are. Every (mesh, level) pair is simplified
+   * as its own subtask on the thread pool, each worker reusing its own MeshSimplifier scratch
+   * @param t_state Internal state data with the constructed meshes, the generated lods are added to its meshes
+   */
+  void GenerateLods(LoaderState& t_state) {
+    const auto base = t_state.meshes.find(0);
+    if (base == t_state.meshes.end()) {
+      return;
+    }
+
+    auto hasFile = [&] (const unsigned int t_lodLevel)
+    {
+      return std::ranges::any_of(t_state.filePaths, [&] (const File& t_file) { return t_file.lodLevel == t_lodLevel; });
+    };
+
+    std::vector<std::pair<unsigned int, float>> levels;
+    for (unsigned int i = 0; i < t_state.lodRatios.size(); ++i) {
+      const float ratio = t_state.lodRatios[i];
+      if (!hasFile(i + 1) && !t_state.meshes.contains(i + 1) && ratio > 0.0f && ratio < 1.0f) {
+        levels.emplace_back(i + 1, ratio);
+      }
+    }
+
+    const std::vector<Mesh>&       source = base->second;
+    std::vector<std::vector<Mesh>> generated(levels.size(), std::vector<Mesh>(source.size()));
+
+    auto simplify = [&] (const size_t t_i)
+    {
+      const auto& [lodLevel, ratio] = levels[t_i / source.size()];
+      const Mesh& mesh              = source[t_i % source.size()];
+      Mesh&       lod               = generated[t_i / source.size()][t_i % source.size()];
+
+      lod          = Mesh(mesh.name, lodLevel, mesh.meshNumber);
+      lod.material   = mesh.material;
+      lod.materialId = mesh.materialId;
+      lod.vertices   = mesh.vertices;
+      lod.indices    = mesh.indices;
+
+      if (lod.vertices.empty()) {
+        return;
+      }
+
+      // the simplifier needs shared vertices to find edges, weld in case JoinIdentical didn't already
+      thread_local VertexWelder   welder;
+      thread_local MeshSimplifier simplifier;
+      welder.Weld(lod);
 
-        baseVertex += mesh.vertices.size();
-        baseIndex += mesh.indices.size();
-
-        //const size_t              n = mesh.vertices.size();
-        //std::vector<unsigned int> indexMap(n);
-        //std::iota(indexMap.begin(), indexMap.end(), 0);
-        //
-        //// Sort indices by vertex value
-        //std::ranges::sort(
-        //  indexMap,
-        //  [&] (const unsigned int t_a, const unsigned int t_b)
-        //  {
-        //    return mesh.vertices[t_a] < mesh.vertices[t_b]; // requires operator<
-        //  });
-        //
-        //std::vector<Vertex> newVertices;
-        //newVertices.reserve(n);
-        //std::vector<unsigned int> remap(n);
-        //
-        //// Deduplicate vertices while tracking new index mapping
-        //unsigned int nextIndex = 0;
-        //newVertices.emplace_back(mesh.vertices[indexMap[0]]);
-        //remap[indexMap[0]] = nextIndex;
-        //
-        //for (size_t i = 1; i < n; ++i) {
-        //  const Vertex& curr = mesh.vertices[indexMap[i]];
-        //  const Vertex& prev = mesh.vertices[indexMap[i - 1]];
-        //
-        //  if (curr != prev) {
-        //    ++nextIndex;
-        //    newVertices.emplace_back(curr);
-        //  }
-        //  remap[indexMap[i]] = nextIndex;
-        //}
-        //
-        //for (auto& idx : mesh.indices) {
-        //  idx = remap[idx];
-        //}
-        //
-        //// Resize newVertices to actual number of unique vertices
-        //newVertices.resize(nextIndex + 1);
-        //
-        //// Remap mesh.indices to the deduplicated set
-        //mesh.vertices.swap(newVertices);
-      }
-    }
-  }
-
-  /*!
-   * @brief 
-   * @param t_state 
-   */
-  // TODO: simple vector insert, use local mesh indices
+      const auto triangles = static_cast<size_t>(std::round(static_cast<float>(mesh.indices.size() / 3) * ratio));
+      simplifier.Simplify(lod, std::max<size_t>(1, triangles) * 3);
+    };
+
+    if (t_state.threadPool) {
+      t_state.threadPool->ParallelFor(levels.size() * source.size(), simplify);
+    }
+    else {
+      for (size_t i = 0; i < levels.size() * source.size(); ++i) {
+        simplify(i);
+      }
+    }
+
+    for (size_t l = 0; l < levels.size(); ++l) {
+      t_state.meshes[levels[l].first] = std::move(generated[l]);
+    }
+
+    AssignBaseOffsets(t_state);
+  }
+
+  /*!
+   * @brief Reorders the indices of every mesh for the post-transform vertex cache, optionally sorts the resulting
+   * triangle clusters to reduce overdraw, and finally reorders the vertices into first-use order for fetch locality.
+   * \n Vertex and index counts are unchanged, so base offsets stay valid. Meshes are processed in parallel across the
+   * thread pool, each worker reusing its own IndexOptimizer scratch
+   * @param t_state
+   */
+  void OptimizeIndices(LoaderState& t_state) {
+    const bool overdraw = (t_state.flags & Flag::OptimizeOverdraw) == Flag::OptimizeOverdraw;
+
+    ForEachMesh(
+      t_state,
+      [overdraw] (Mesh& t_mesh, unsigned int)
+      {
+        thread_local IndexOptimizer optimizer;
+        optimizer.OptimizeVertexCache(t_mesh);
+        if (overdraw) {
+          optimizer.OptimizeOverdraw(t_mesh);
+        }
+        optimizer.OptimizeVertexFetch(t_mesh);
+      });
+  }
+
+  /*!
+   * @brief Partitions every mesh into meshlets of at most MeshletBuilder::MAX_VERTICES vertices and MAX_TRIANGLES
+   * triangles, each with a bounding sphere and a backface culling cone
+   * \n Meshes are processed in parallel across the thread pool, each worker reusing its own MeshletBuilder scratch
+   * @param t_state
+   */
+  void BuildMeshlets(LoaderState& t_state) {
+    ForEachMesh(
+      t_state,
+      [] (Mesh& t_mesh, unsigned int)
+      {
+        thread_local MeshletBuilder builder;
+        builder.Build(t_mesh);
+      });
+  }
+
+  /*!
+   * @brief Combines the meshes of every lod into one mesh per lod, with indices rebased onto the combined vertices and
+   * one draw range per source mesh, so a whole lod can be drawn from one pair of buffers with multi-draw-indirect.
+   * \n Output sizes are summed up front and allocated once, then every source mesh is copied into its own disjoint
+   * range, across the thread pool once the lods are large enough to be worth it. Meshlets are carried over as well.
+   * With a BufferAllocator the vertices and indices are copied into the caller's grant instead of the combined mesh
+   * @param t_state Internal state data with the final meshes, the combined meshes are added to its combinedMeshes
+   */
   void CombineMeshes(LoaderState& t_state) {
+    constexpr size_t minParallelBytes = 1 << 20; // below this the copies are cheaper than waking workers
+
+    const bool compactIndices = (t_state.flags & Flag::CompactIndices) == Flag::CompactIndices;
+
+    struct Copy
+    {
+      const Mesh* source;
+      Mesh*       target;
+      size_t      output; // into outputs
+      DrawRange   range;
+      size_t      meshletOffset;
+      size_t      meshletVertexOffset;
+      size_t      meshletTriangleOffset;
+    };
+
+    std::vector<Copy>         copies;
+    std::vector<BufferTarget> outputs; // one per combined mesh
+    size_t                    totalBytes = 0;
+
+    t_state.combinedMeshes.reserve(t_state.combinedMeshes.size() + t_state.meshes.size());
+
     for (auto& lod : t_state.meshes | std::views::values) {
-      const unsigned int lodLevel = lod[0].lodLevel;
+      if (lod.empty()) {
+        continue;
+      }
 
-      t_state.combinedMeshes.emplace_back(
+      Mesh& combined = t_state.combinedMeshes.emplace_back(
         t_state.mtlFileName.substr(0, t_state.mtlFileName.length() - 4),
         lod[0].lodLevel,
         lod[0].meshNumber);
 
-      for (auto& mesh : lod) {
-        t_state.combinedMeshes[lodLevel].vertices.insert(
-          t_state.combinedMeshes[lodLevel].vertices.end(),
-          mesh.vertices.begin(),
-          mesh.vertices.end());
-        t_state.combinedMeshes[lodLevel].indices.insert(
-          t_state.combinedMeshes[lodLevel].indices.end(),
-          mesh.indices.begin(),
-          mesh.indices.end());
-      }
-    }
-
-
-    //auto initFrom = [&] (const Mesh& t_src, Mesh& t_dst)
-    //{
-    //  t_dst.name       = t_src.name;
-    //  t_dst.material   = t_src.material;
-    //  t_dst.meshNumber = t_src.meshNumber;
-    //  t_dst.lodLevel   = t_src.lodLevel;
-    //};
-    //
-    //for (auto& lod : t_state.meshes | std::views::values) {
-    //  unsigned int lodLevel   = lod[0].lodLevel;
-    //  size_t       totalVerts = 0, totalIndices = 0;
-    //  unsigned int baseVertex = 0;
-    //
-    //  t_state.combinedMeshes.emplace_back();
-    //  initFrom(lod[0], t_state.combinedMeshes[lodLevel]);
-    //
-    //  // check size for reserve
-    //  for (auto& mesh : lod) {
-    //    totalVerts += mesh.vertices.size();
-    //    totalIndices += mesh.indices.size();
-    //  }
-    //
-    //  t_state.combinedMeshes[lodLevel].vertices.reserve(totalVerts);
-    //  t_state.combinedMeshes[lodLevel].indices.reserve(totalIndices);
-    //
-    //  // combine meshes
-    //  for (auto& mesh : lod) {
-    //    // append indices with offset
-    //    for (const auto idx : mesh.indices) {
-    //      t_state.combinedMeshes[lodLevel].indices.push_back(idx + baseVertex);
-    //    }
-    //
-    //    t_state.combinedMeshes[lodLevel].vertices.insert(
-    //      t_state.combinedMeshes[lodLevel].vertices.end(),
-    //      mesh.vertices.begin(),
-    //      mesh.vertices.end());
-    //
-    //    baseVertex += static_cast<unsigned int>(mesh.vertices.size());
-    //  }
-    //}
+      size_t vertexCount = 0, interleavedCount = 0, indexCount = 0;
+      size_t meshletCount = 0, meshletVertexCount = 0, meshletTriangleCount = 0;
+
+      combined.drawRanges.reserve(lod.size());
+      for (const auto& mesh : lod) {
+        const DrawRange range{
+          .firstIndex = static_cast<std::uint32_t>(indexCount),
+          .indexCount = static_cast<std::uint32_t>(mesh.indices.size()),
+          .firstVertex = static_cast<std::uint32_t>(vertexCount),
+          .vertexCount = static_cast<std::uint32_t>(mesh.VertexCount()),
+          .materialIndex = mesh.material.index,
+          .materialId = mesh.materialId
+        };
+
+        combined.drawRanges.push_back(range);
+        copies.push_back({&mesh, &combined, outputs.size(), range, meshletCount, meshletVertexCount, meshletTriangleCount});
+
+        vertexCount += mesh.VertexCount();
+        interleavedCount += mesh.vertices.size();
+        indexCount += mesh.indices.size();
+        meshletCount += mesh.meshlets.size();
+        meshletVertexCount += mesh.meshletVertices.size();
+        meshletTriangleCount += mesh.meshletTriangles.size();
+      }
+
+      combined.meshlets.resize(meshletCount);
+      combined.meshletVertices.resize(meshletVertexCount);
+      combined.meshletTriangles.resize(meshletTriangleCount);
+
+      // with a BufferAllocator the lod is combined straight into the caller's memory, there is no copy in between,
+      // unless Flag::CompactIndices still has to decide on the index size or the vertices still have to be packed
+      if (t_state.bufferAllocator && !compactIndices && t_state.vertexFormat == VertexFormat::Full) {
+        MeshBuffer buffer;
+        outputs.push_back(RequestBuffers(t_state, combined, vertexCount, indexCount, sizeof(unsigned int), buffer));
+        combined.buffer = buffer;
+      }
+      else {
+        // with Flag::SplitStreams the meshes only have streams left, combine those instead
+        const size_t streamCount = vertexCount - interleavedCount;
+        combined.vertices.resize(interleavedCount);
+        combined.positions.resize(streamCount);
+        combined.attributes.resize(streamCount);
+        combined.indices.resize(indexCount);
+        outputs.push_back({combined.vertices.data(), combined.positions.data(), combined.attributes.data(),
+                           combined.indices.data()});
+      }
+
+      totalBytes += vertexCount * sizeof(Vertex) + indexCount * sizeof(unsigned int);
+    }
+
+    auto copy = [&] (const size_t t_i)
+    {
+      const auto& [source, target, output, range, meshletOffset, meshletVertexOffset, meshletTriangleOffset] = copies[t_i];
+      const BufferTarget& out = outputs[output];
+
+      if (!source->vertices.empty()) {
+        std::ranges::copy(source->vertices, out.vertices + range.firstVertex);
+      }
+      else {
+        std::ranges::copy(source->positions, out.positions + range.firstVertex);
+        std::ranges::copy(source->attributes, out.attributes + range.firstVertex);
+      }
+      std::ranges::transform(source->indices,
+                             out.indices + range.firstIndex,
+                             [base = range.firstVertex] (const unsigned int t_idx) { return t_idx + base; });
+
+      std::ranges::transform(source->meshlets,
+                             target->meshlets.begin() + static_cast<std::ptrdiff_t>(meshletOffset),
+                             [&] (Meshlet t_meshlet)
+                             {
+                               t_meshlet.vertexOffset += static_cast<std::uint32_t>(meshletVertexOffset);
+                               t_meshlet.triangleOffset += static_cast<std::uint32_t>(meshletTriangleOffset);
+                               return t_meshlet;
+                             });
+      std::ranges::transform(source->meshletVertices,
+                             target->meshletVertices.begin() + static_cast<std::ptrdiff_t>(meshletVertexOffset),
+                             [base = range.firstVertex] (const std::uint32_t t_idx) { return t_idx + base; });
+      std::ranges::copy(source->meshletTriangles,
+                        target->meshletTriangles.begin() + static_cast<std::ptrdiff_t>(meshletTriangleOffset));
+    };
+
+    if (t_state.threadPool && totalBytes >= minParallelBytes) {
+      t_state.threadPool->ParallelFor(copies.size(), copy);
+    }
+    else {
+      for (size_t i = 0; i < copies.size(); ++i) {
+        copy(i);
+      }
+    }
+  }
+
+  /*!
+   * @brief Moves the interleaved vertices of every mesh into a position stream and an attribute stream, so passes that
+   * only read positions stream 12 bytes per vertex instead of the whole struct.
+   * \n Runs after every other per-mesh stage, so welding, tangents and meshlets all work on interleaved vertices, and
+   * CombineMeshes copies the streams as they are
+   * @param t_state Internal state data with the final meshes
+   */
+  void SplitVertexStreams(LoaderState& t_state) {
+    ForEachMesh(
+      t_state,
+      [] (Mesh& t_mesh, unsigned int)
+      {
+        t_mesh.positions.resize(t_mesh.vertices.size());
+        t_mesh.attributes.resize(t_mesh.vertices.size());
+
+        for (size_t i = 0; i < t_mesh.vertices.size(); ++i) {
+          const Vertex& v      = t_mesh.vertices[i];
+          t_mesh.positions[i]  = v.position;
+          t_mesh.attributes[i] = {.packedNormal = v.packedNormal, .texCoords = v.texCoords, .tangent = v.tangent};
+        }
+
+        // the streams replace the interleaved copy rather than doubling the model's footprint
+        t_mesh.vertices = {};
+      });
+  }
+
+  /*!
+   * @brief Moves the indices of every mesh and combined mesh with at most 65536 vertices into Mesh::indices16, which
+   * halves what they take in memory, in the cache and on the GPU. Larger meshes keep their 32-bit indices
+   * @param t_state Internal state data with the final meshes
+   */
+  void CompactIndices(LoaderState& t_state) {
+    constexpr size_t maxVertices = size_t(UINT16_MAX) + 1;
+
+    auto compact = [] (Mesh& t_mesh)
+    {
+      if (t_mesh.VertexCount() > maxVertices || t_mesh.indices.empty()) {
+        return;
+      }
+
+      t_mesh.indices16.resize(t_mesh.indices.size());
+      std::ranges::transform(
+        t_mesh.indices,
+        t_mesh.indices16.begin(),
+        [] (const unsigned int t_index) { return static_cast<std::uint16_t>(t_index); });
+      t_mesh.indices = {};
+    };
+
+    ForEachMesh(t_state, [&] (Mesh& t_mesh, unsigned int) { compact(t_mesh); });
+    for (Mesh& combined : t_state.combinedMeshes) {
+      compact(combined);
+    }
+  }
+
+  /*!
+   * @brief Copies the final vertices and indices of every mesh into memory from the state's BufferAllocator, so the
+   * caller's upload buffers are filled without another copy through the Model. Vertices are packed into
+   * LoaderState::vertexFormat on the way, the Model and the cache always hold the full obj::Vertex.
+   * \n With combined meshes only they are written, the meshes of each lod point into the grant of their combined mesh
+   * at their draw range. Written meshes keep their counts in Mesh::buffer and drop their own vectors, meshlets stay
+   * @param t_state Internal state data with the final meshes, nothing happens without an allocator
+   */
+  void WriteBuffers(LoaderState& t_state) {
+    if (!t_state.bufferAllocator) {
+      return;
+    }
+
+    auto write = [&t_state] (Mesh& t_mesh)
+    {
+      const size_t       indexSize = t_mesh.indices16.empty() ? sizeof(unsigned int) : sizeof(std::uint16_t);
+      MeshBuffer         buffer;
+      const BufferTarget target = RequestBuffers(t_state, t_mesh, t_mesh.VertexCount(), t_mesh.IndexCount(), indexSize, buffer);
+
+      if (target.vertices) {
+        std::ranges::copy(t_mesh.vertices, target.vertices);
+      }
+      else if (target.packed) {
+        buffer.quantization = PackVertices(t_mesh, t_state.vertexFormat, target.packed);
+      }
+      else if (target.positions) {
+        std::ranges::copy(t_mesh.positions, target.positions);
+        std::ranges::copy(t_mesh.attributes, target.attributes);
+      }
+      if (target.indices) {
+        std::ranges::copy(t_mesh.indices, target.indices);
+      }
+      else if (target.indices16) {
+        std::ranges::copy(t_mesh.indices16, target.indices16);
+      }
+
+      t_mesh.buffer = buffer;
+      ReleaseBuffers(t_mesh);
+    };
+
+    if (t_state.combinedMeshes.empty()) {
+      ForEachMesh(t_state, [&] (Mesh& t_mesh, unsigned int) { write(t_mesh); });
+      return;
+    }
+
+    // CombineMeshes already wrote straight into a grant unless the Model had to keep a copy, e.g. for the cache or for
+    // a vertex format
+    for (Mesh& combined : t_state.combinedMeshes) {
+      if (!combined.buffer) {
+        write(combined);
+      }
+
+      const auto lod = t_state.meshes.find(combined.lodLevel);
+      if (lod == t_state.meshes.end()) {
+        continue;
+      }
+
+      for (size_t i = 0; i < lod->second.size() && i < combined.drawRanges.size(); ++i) {
+        const DrawRange& range = combined.drawRanges[i];
+        Mesh&            mesh  = lod->second[i];
+
+        mesh.buffer = MeshBuffer{.handle = combined.buffer->handle, .firstVertex = range.firstVertex,
+                                 .firstIndex = range.firstIndex, .vertexCount = range.vertexCount,
+                                 .indexCount = range.indexCount, .indexSize = combined.buffer->indexSize,
+                                 .format = combined.buffer->format, .quantization = combined.buffer->quantization};
+        ReleaseBuffers(mesh);
+      }
+    }
   }
 }
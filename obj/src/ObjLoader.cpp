@@ -1,17 +1,81 @@
 #include "obj/ObjLoader.hpp"
 
+#include "obj/AsyncLoad.hpp"
+#include "obj/FileBuffer.hpp"
+#include "obj/LoadStats.hpp"
+#include "obj/MaterialRegistry.hpp"
+#include "obj/ModelCache.hpp"
+#include "obj/ModelWatcher.hpp"
 #include "obj/ObjHelpers.hpp"
+#include "obj/TaskArena.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+namespace
+{
+  /*!
+   * @brief Runs t_f and adds its duration to the stage's time in t_state.stats, and to the trace if the state has one
+   * \n A stage that throws is not recorded, the load failed anyway
+   */
+  template <typename F>
+  void RunStage(obj::LoaderState& t_state, const obj::Stage t_stage, F&& t_f) {
+    const Timer::TimePoint start = Timer::Clock::now();
+    t_f();
+    const obj::LoadStats::Duration elapsed = Timer::Clock::now() - start;
+
+    t_state.stats.stages[static_cast<size_t>(t_stage)] += elapsed;
+    if (t_state.trace) {
+      t_state.trace->AddEvent(obj::StageName(t_stage), t_state.path, start, elapsed);
+    }
+  }
+
+  /*!
+   * @brief Sets the options of a load that decide what ends up in the caller's buffers, shared by the state of a request
+   * and the state a cache miss writes its buffers from, so both write the same layout
+   */
+  void ApplyOutputOptions(obj::LoaderState&       t_state,
+                          CancellationToken       t_cancel,
+                          obj::BufferAllocator    t_allocator,
+                          const obj::VertexFormat t_format) {
+    t_state.cancel          = std::move(t_cancel);
+    t_state.bufferAllocator = std::move(t_allocator);
+    t_state.vertexFormat    = t_format;
+  }
+}
 
 /*!
  * @brief Initializes the instance and dispatches an appropriate number of threads pre-emptively, ready to pick up tasks
  * @param t_maxThreads User desired maximum amount of threads to dispatch across the whole instance.
  * \n A small portion of this will be pre-dispatched
  * \n Note if files are small enough, the amount of dispatched threads may not actually reach this limit
+ * @param t_scheduling How the pool hands out tasks, WorkStealing suits many small loads that fan out subtasks
  */
-ObjLoader::ObjLoader(const size_t t_maxThreads) : m_maxThreadsUser(t_maxThreads), m_threadPool(ThreadPool(m_maxThreadsUser)) {
+ObjLoader::ObjLoader(const size_t t_maxThreads, const ThreadPool::Scheduling t_scheduling) : m_maxThreadsUser(t_maxThreads),
+                                                                                             m_materials(std::make_shared<obj::MaterialRegistry>()),
+                                                                                             m_threadPool(m_maxThreadsUser, t_scheduling) {
   //m_logger->DispatchWorkerThread();
 }
 
+/*!
+ * @brief Creates a loader whose pool places its workers, e.g. every worker started up front and kept on one NUMA node
+ * so a load's buffers are allocated and processed on the node of the worker that runs it
+ * @param t_maxThreads Maximum number of pool workers, 0 loads on the calling thread
+ * @param t_poolOptions Scheduling and placement of the pool's workers
+ */
+ObjLoader::ObjLoader(const size_t t_maxThreads, const ThreadPool::PoolOptions& t_poolOptions) :
+  m_maxThreadsUser(t_maxThreads), m_materials(std::make_shared<obj::MaterialRegistry>()),
+  m_threadPool(m_maxThreadsUser, t_poolOptions) {}
+
+/*!
+ * @brief Starts writing the stages of every load started from now on to a Chrome trace file, replacing any previous one
+ * \n The file is complete once this is called again and every load that used it finished, or the loader is destroyed
+ * @param t_path Trace file to write, empty to stop tracing
+ */
+void ObjLoader::SetTraceFile(const std::filesystem::path& t_path) {
+  m_trace = t_path.empty() ? nullptr : std::make_shared<obj::ChromeTrace>(t_path);
+}
+
 /*!
  * @brief Loads an obj + mtl file asynchronously
  * @param t_path Relative path to obj file, including file extension
@@ -19,40 +83,137 @@ ObjLoader::ObjLoader(const size_t t_maxThreads) : m_maxThreadsUser(t_maxThreads)
  * @return std::future<Model> of the created task that loads the file
  */
 std::future<obj::Model> ObjLoader::LoadFile(const std::filesystem::path& t_path, std::optional<obj::Flag> t_flags) {
+  return EnqueueLoad({.path = t_path, .flags = t_flags}, nullptr);
+}
+
+/*!
+ * @brief Loads an obj + mtl file asynchronously like LoadFile(t_path, t_flags), scheduled at t_request.priority
+ * \n Cancelling t_request.cancel stops the load at its next stage, or before it starts, and its future rethrows
+ * OperationCancelled. With t_request.allocator the final vertices and indices are written into its grants, packed
+ * into t_request.vertexFormat, the Model then only holds where they went in Mesh::buffer
+ * @param t_request Path, flags, priority, cancellation and output buffers of the load
+ * @return std::future<Model> of the created task that loads the file
+ */
+std::future<obj::Model> ObjLoader::LoadFile(const LoadRequest& t_request) {
+  return EnqueueLoad(t_request, nullptr);
+}
+
+/*!
+ * @brief Loads an obj + mtl file asynchronously like LoadFile(), handing every lod to t_onLodLoaded as soon as its own
+ * meshes are processed, so coarse lods can be uploaded while finer ones are still being parsed
+ * @param t_path Relative path to obj file, including file extension
+ * @param t_onLodLoaded Called on a worker once per lod, coarsest first within each file. An exception fails the load
+ * @param t_flags Processing flags, none if empty
+ * @return std::future<Model> of the whole model, ready after the last lod was reported
+ */
+std::future<obj::Model> ObjLoader::LoadFileStreaming(const std::filesystem::path& t_path,
+                                                     LodCallback                  t_onLodLoaded,
+                                                     std::optional<obj::Flag>     t_flags) {
+  return EnqueueLoad({.path = t_path, .flags = t_flags}, std::move(t_onLodLoaded));
+}
+
+/*!
+ * @brief Loads an obj + mtl file asynchronously like LoadFileStreaming(t_path, t_onLodLoaded, t_flags), with the
+ * priority and cancellation of LoadFile(t_request)
+ * @param t_request Path, flags, priority and cancellation of the load
+ * @param t_onLodLoaded Called on a worker once per lod, coarsest first within each file. An exception fails the load
+ * @return std::future<Model> of the whole model, ready after the last lod was reported
+ */
+std::future<obj::Model> ObjLoader::LoadFileStreaming(const LoadRequest& t_request, LodCallback t_onLodLoaded) {
+  return EnqueueLoad(t_request, std::move(t_onLodLoaded));
+}
+
+/*!
+ * @brief Loads an obj + mtl file inside a coroutine like LoadFile(t_path, t_flags), co_await the result
+ * @param t_path Relative path to obj file, including file extension
+ * @param t_flags Processing flags, none if empty
+ * @return Awaiter yielding the Model, see LoadFileAsync(t_request)
+ */
+ThreadPool::AsyncAwaiter<obj::AsyncLoad> ObjLoader::LoadFileAsync(const std::filesystem::path& t_path,
+                                                                  const std::optional<obj::Flag> t_flags) {
+  return LoadFileAsync({.path = t_path, .flags = t_flags});
+}
+
+/*!
+ * @brief Loads an obj + mtl file inside a coroutine like LoadFile(t_request). Nothing runs until the awaiter is
+ * co_awaited, the coroutine then resumes on the worker that finished the load, without a future in between
+ * \n Unlike LoadFile() every file is read on the worker, and queueing the load doesn't allocate, which is what sets
+ * this apart when a session starts tens of thousands of loads. The queue wait in the stats counts from this call
+ * @param t_request Path, flags, priority, cancellation and output buffers of the load
+ * @return Awaiter yielding the Model, rethrows load errors and OperationCancelled
+ */
+ThreadPool::AsyncAwaiter<obj::AsyncLoad> ObjLoader::LoadFileAsync(const LoadRequest& t_request) {
   const Timer      cacheTimer;
-  auto flag = obj::Flag::None;
+  obj::LoaderState state = CreateState(t_request.path, t_request.flags, nullptr);
+  ApplyRequest(state, t_request);
 
-  if (t_flags.has_value()) {
-    flag = t_flags.value();
-  }
+  const unsigned int taskNumber = ++m_totalTasks;
+  state.enqueueTime             = Timer::Clock::now();
 
-  obj::LoaderState state(flag);
+  return m_threadPool.RunAsyncWith({.priority = t_request.priority, .cancel = t_request.cancel},
+                                   obj::AsyncLoad(*this, std::move(state), cacheTimer.Elapsed(), taskNumber));
+}
 
-  std::unordered_map<unsigned int, std::string> mtlBuffers;
-  std::unordered_map<unsigned int, std::string> objBuffers;
+/*!
+ * @brief Reads or maps a file on one of the loader's workers inside a coroutine, see obj::ReadFileAsync()
+ */
+ThreadPool::AsyncAwaiter<obj::FileRead> ObjLoader::ReadFileAsync(const std::filesystem::path& t_path, const bool t_map) {
+  return obj::ReadFileAsync(m_threadPool, t_path, t_map);
+}
 
-  state.path = t_path;
+obj::AsyncLoad::AsyncLoad(const ObjLoader&                                t_loader,
+                          LoaderState                                     t_state,
+                          const std::chrono::duration<double, std::milli> t_cacheElapsed,
+                          const unsigned int                              t_taskNumber) :
+  m_loader(&t_loader), m_state(std::move(t_state)), m_cacheElapsed(t_cacheElapsed), m_taskNumber(t_taskNumber) {}
 
-  // get file paths of all obj, mtl and lods
-  CacheFilePaths(state);
+obj::Model obj::AsyncLoad::operator()() {
+  return m_loader->ConstructTask(m_state, {}, {}, m_cacheElapsed, m_taskNumber);
+}
 
-  // read all files to memory on main thread
-  for (const auto& [objPath, mtlPath, lodLevel] : state.filePaths) {
-    objBuffers[lodLevel] = obj::ReadFileToBuffer(objPath);
+std::future<obj::Model> ObjLoader::EnqueueLoad(const LoadRequest& t_request, LodCallback t_onLodLoaded) {
+  const Timer      cacheTimer;
+  obj::LoaderState state = CreateState(t_request.path, t_request.flags, nullptr);
+  state.onLodLoaded      = std::move(t_onLodLoaded);
+  ApplyRequest(state, t_request);
 
-    if (mtlPath.empty()) {
-      m_logger->Log<Logger::Warning>(std::format("No mtl found for file: {}", objPath.string()));
-    }
+  std::unordered_map<unsigned int, obj::FileBuffer> mtlBuffers;
+  std::unordered_map<unsigned int, obj::FileBuffer> objBuffers;
 
-    mtlBuffers[lodLevel] = obj::ReadFileToBuffer(mtlPath);
+  // a cache hit never needs the source files, so let the worker decide whether to open them
+  const bool deferRead = (state.flags & obj::Flag::MapFiles) == obj::Flag::MapFiles ||
+                         (state.flags & obj::Flag::BinaryCache) == obj::Flag::BinaryCache;
+
+  // the registry reads an mtl only if no earlier load already parsed it
+  const bool sharedMaterials = (state.flags & obj::Flag::SharedMaterials) == obj::Flag::SharedMaterials;
+
+  // read all files to memory on main thread, deferred files are opened later by the worker
+  if (!deferRead) {
+    RunStage(
+      state,
+      obj::Stage::Io,
+      [&]
+      {
+        for (const auto& [objPath, mtlPath, lodLevel] : state.filePaths) {
+          objBuffers[lodLevel] = obj::FileBuffer::Read(objPath);
+          state.stats.bytesRead += objBuffers[lodLevel].Size();
+
+          if (!sharedMaterials) {
+            mtlBuffers[lodLevel] = obj::FileBuffer::Read(mtlPath);
+            state.stats.bytesRead += mtlBuffers[lodLevel].Size();
+          }
+        }
+      });
   }
 
   // assign task number before creating task and pass by value
   unsigned int taskNumber = ++m_totalTasks; // atomic increment
+  state.enqueueTime       = Timer::Clock::now();
 
   //construct our threaded task
   // the time that it was created and the task number it was assigned
-  return m_threadPool.Enqueue(
+  return m_threadPool.EnqueueWith(
+    {.priority = t_request.priority, .cancel = t_request.cancel},
     &ObjLoader::ConstructTask,
     this,
     std::move(state),
@@ -62,75 +223,862 @@ std::future<obj::Model> ObjLoader::LoadFile(const std::filesystem::path& t_path,
     taskNumber);
 }
 
-obj::Model ObjLoader::ConstructTask(const obj::LoaderState&                              t_state,
-                                    const std::unordered_map<unsigned int, std::string>& t_objBuffers,
-                                    const std::unordered_map<unsigned int, std::string>& t_mtlBuffers,
-                                    const std::chrono::duration<double, std::milli>      t_cacheElapsed,
-                                    unsigned int                                         t_taskNumber) const {
-  std::string        log;
-  std::ostringstream id;
-  id << std::this_thread::get_id();
+/*!
+ * @brief Loads many obj + mtl files asynchronously, with one directory scan per distinct directory, largest loads
+ * scheduled first, and small loads grouped into shared tasks that read their files on the worker in path order
+ * @param t_requests Paths and flags of every model to load
+ * @return One std::future<Model> per request, in request order
+ */
+std::vector<std::future<obj::Model>> ObjLoader::LoadFiles(const std::span<const LoadRequest> t_requests) {
+  std::vector<std::future<obj::Model>> futures(t_requests.size());
+  EnqueueBatch(t_requests, &futures, nullptr);
+  return futures;
+}
+
+/*!
+ * @brief Loads many obj + mtl files asynchronously like LoadFiles(t_requests), reporting each model as it finishes
+ * @param t_requests Paths and flags of every model to load
+ * @param t_onLoaded Called once per request, from the worker that loaded it, with the request index and a ready future
+ */
+void ObjLoader::LoadFiles(const std::span<const LoadRequest> t_requests, LoadCallback t_onLoaded) {
+  EnqueueBatch(t_requests, nullptr, std::make_shared<const LoadCallback>(std::move(t_onLoaded)));
+}
+
+struct ObjLoader::BatchItem
+{
+  size_t                   index = 0; // position in the request span
+  obj::LoaderState         state;
+  ThreadPool::Priority     priority   = ThreadPool::Priority::Normal;
+  std::uintmax_t           bytes      = 0; // size of every obj and mtl of this load
+  unsigned int             taskNumber = 0;
+  std::exception_ptr       error = nullptr; // set if the files of this load could not even be located
+  std::promise<obj::Model> promise{};
+};
+
+/*!
+ * @brief Builds the state of every request, then enqueues loads at or above SMALL_FILE_BYTES as their own task and
+ * packs smaller loads of the same priority into tasks of up to BATCH_GROUP_BYTES, each with at most its share of the
+ * small loads per pool thread, so they never end up in fewer tasks than the pool has threads
+ * @param t_requests Paths and flags of every model to load
+ * @param t_futures Filled with one future per request if not null
+ * @param t_onLoaded Called with each finished request if not null
+ */
+void ObjLoader::EnqueueBatch(const std::span<const LoadRequest>        t_requests,
+                             std::vector<std::future<obj::Model>>*     t_futures,
+                             const std::shared_ptr<const LoadCallback>& t_onLoaded) {
+  const Timer cacheTimer;
+
+  // lod discovery shares one scan per directory instead of one per model
+  std::map<std::filesystem::path, std::vector<std::filesystem::path>> directories;
+
+  std::vector<BatchItem> items;
+  items.reserve(t_requests.size());
+
+  for (size_t i = 0; i < t_requests.size(); ++i) {
+    const LoadRequest& request = t_requests[i];
+    const auto&        path    = request.path;
+
+    BatchItem item{.index = i, .state = obj::LoaderState(request.flags.value_or(obj::Flag::None)), .priority = request.priority};
+
+    try {
+      const std::vector<std::filesystem::path>* directoryFiles = nullptr;
+
+      if ((item.state.flags & obj::Flag::Lods) == obj::Flag::Lods) {
+        const auto directory = obj::GetModelDirectory(path);
+        auto       it        = directories.find(directory);
+        if (it == directories.end()) {
+          it = directories.emplace(directory, obj::ListDirectoryFiles(directory)).first;
+        }
+        directoryFiles = &it->second;
+      }
+
+      item.state = CreateState(path, request.flags, directoryFiles);
+      ApplyRequest(item.state, request);
+
+      for (const auto& [objPath, mtlPath, lodLevel] : item.state.filePaths) {
+        for (const auto& filePath : {objPath, mtlPath}) {
+          std::error_code ec;
+          const auto      size = std::filesystem::file_size(filePath, ec);
+          item.bytes += ec ? 0 : size;
+        }
+      }
+    }
+    catch (...) {
+      // reported through the request's future like any other load error
+      item.error = std::current_exception();
+    }
+
+    if (t_futures) {
+      (*t_futures)[i] = item.promise.get_future();
+    }
+
+    item.taskNumber = ++m_totalTasks; // atomic increment
+    items.push_back(std::move(item));
+  }
+
+  // urgent loads first, within one priority large loads first and largest first so the long poles start early,
+  // small loads after them in path order so files of one directory are read back to back
+  const auto isLarge = [] (const BatchItem& t_item) { return t_item.bytes >= SMALL_FILE_BYTES; };
+  std::ranges::sort(
+    items,
+    [&isLarge] (const BatchItem& t_a, const BatchItem& t_b)
+    {
+      if (t_a.priority != t_b.priority) {
+        return t_a.priority > t_b.priority;
+      }
+      if (isLarge(t_a) != isLarge(t_b)) {
+        return isLarge(t_a);
+      }
+      return isLarge(t_a) ? t_a.bytes > t_b.bytes : t_a.state.path < t_b.state.path;
+    });
+
+  // small loads of one priority are spread over at least as many tasks as the pool has threads
+  std::map<ThreadPool::Priority, size_t> groupSizes;
+  for (const auto& item : items) {
+    groupSizes[item.priority] += isLarge(item) ? 0 : 1;
+  }
+
+  const size_t threads = std::max<size_t>(1, m_threadPool.MaxThreadCount());
+  for (auto& [priority, size] : groupSizes) {
+    size = std::max<size_t>(1, (size + threads - 1) / threads);
+  }
+
+  const auto elapsed = cacheTimer.Elapsed();
+
+  for (auto& item : items) {
+    item.state.enqueueTime = Timer::Clock::now();
+  }
+
+  std::vector<BatchItem> group;
+  std::uintmax_t         bytes = 0;
+
+  auto flush = [&]
+  {
+    if (group.empty()) {
+      return;
+    }
+    const ThreadPool::Priority priority = group.front().priority;
+    m_threadPool.EnqueueWith({.priority = priority}, &ObjLoader::ConstructBatchTask, this, std::move(group), t_onLoaded, elapsed);
+    group.clear();
+    bytes = 0;
+  };
+
+  for (auto& item : items) {
+    const bool large = isLarge(item);
+
+    // a group runs at one priority, so it never mixes loads of different ones
+    if (!group.empty() && group.front().priority != item.priority) {
+      flush();
+    }
+
+    bytes += item.bytes;
+    group.push_back(std::move(item));
+
+    if (large || group.size() >= groupSizes[group.back().priority] || bytes >= BATCH_GROUP_BYTES) {
+      flush();
+    }
+  }
+  flush();
+}
+
+/*!
+ * @brief Runs the loads of one LoadFiles task back to back, handing each result to its promise and callback
+ * @param t_items Loads of this task, their files are read or memory-mapped here
+ * @param t_onLoaded Called after each load if not null
+ * @param t_cacheElapsed Time spent preparing the batch on the calling thread
+ */
+void ObjLoader::ConstructBatchTask(std::vector<BatchItem>                          t_items,
+                                   const std::shared_ptr<const LoadCallback>       t_onLoaded,
+                                   const std::chrono::duration<double, std::milli> t_cacheElapsed) const {
+  for (auto& item : t_items) {
+    try {
+      if (item.error) {
+        std::rethrow_exception(item.error);
+      }
+      item.promise.set_value(ConstructTask(item.state, {}, {}, t_cacheElapsed, item.taskNumber));
+    }
+    catch (...) {
+      item.promise.set_exception(std::current_exception());
+    }
+
+    if (!t_onLoaded || !*t_onLoaded) {
+      continue;
+    }
 
+    // a throwing callback must not cost the rest of the group their results
+    try {
+      (*t_onLoaded)(item.index, item.promise.get_future());
+    }
+    catch (const std::exception& e) {
+      m_logger->Log<Logger::Error>("Load callback for task #{} threw: {}", item.taskNumber, e.what());
+    }
+    catch (...) {
+      m_logger->Log<Logger::Error>("Load callback for task #{} threw", item.taskNumber);
+    }
+  }
+}
+
+/*!
+ * @brief Parses only what t_change says changed and patches it into t_model asynchronously, far cheaper than LoadFile()
+ * when an artist saves one lod or one mtl
+ * \n Changed objs are parsed and processed again together with their mtl, a changed mtl on its own only re-points the
+ * meshes of its lod at their textures. Base offsets and combined meshes are patched to match. Falls back to a full
+ * LoadFile() when lod files appeared or disappeared, or when lod 0 changed and Flag::GenerateLods derives other lods from it
+ * @param t_model Model as last loaded or reloaded, moved into the task and handed back patched
+ * @param t_change Change reported by obj::ModelWatcher::Poll() for the model
+ * @return std::future<Model> of the patched model, whose stats only cover the reload
+ */
+std::future<obj::Model> ObjLoader::Reload(obj::Model t_model, const obj::ModelChange& t_change) {
+  return Reload(std::move(t_model), t_change, {.path = t_change.path, .flags = t_change.flags});
+}
+
+/*!
+ * @brief Reloads like Reload(t_model, t_change) with the options the model was first loaded with, so a model loaded
+ * into caller buffers gets its reparsed lods and combined meshes written through the same allocator and format
+ * @param t_model Model as last loaded or reloaded, moved into the task and handed back patched
+ * @param t_change Change reported by obj::ModelWatcher::Poll() for the model
+ * @param t_request Request of the original load, its path and flags are taken from t_change
+ * @return std::future<Model> of the patched model, whose stats only cover the reload
+ */
+std::future<obj::Model> ObjLoader::Reload(obj::Model t_model, const obj::ModelChange& t_change, const LoadRequest& t_request) {
+  auto objChanged = [&t_change] (const unsigned int t_lodLevel)
+  {
+    return std::ranges::find(t_change.objLods, t_lodLevel) != t_change.objLods.end();
+  };
+
+  // which lod levels exist changes, patching lods in place can't express that
+  if (t_change.lodsChanged ||
+      ((t_change.flags & obj::Flag::GenerateLods) == obj::Flag::GenerateLods && objChanged(0))) {
+    LoadRequest request = t_request;
+    request.path        = t_change.path;
+    request.flags       = t_change.flags;
+    return LoadFile(request);
+  }
+
+  obj::LoaderState state = InitState(t_change.path, t_change.flags);
+  ApplyRequest(state, t_request);
+
+  // the known files spare the directory scan of CreateState()
+  for (const auto& file : t_change.files) {
+    if (objChanged(file.lodLevel)) {
+      state.filePaths.push_back(file);
+    }
+  }
+
+  const unsigned int taskNumber = ++m_totalTasks;
+  state.enqueueTime             = Timer::Clock::now();
+
+  return m_threadPool.EnqueueWith(
+    {.priority = t_request.priority, .cancel = t_request.cancel},
+    &ObjLoader::ReloadTask,
+    this,
+    std::move(state),
+    std::move(t_model),
+    t_change,
+    taskNumber);
+}
+
+/*!
+ * @brief Reparses the files of one Reload() and patches them into the model
+ * @param t_state State holding only the lods whose obj changed
+ * @param t_model Model to patch
+ * @param t_change What changed, for the lods whose mtl changed on its own
+ * @param t_taskNumber Task number for logging
+ * @return The patched model
+ */
+obj::Model ObjLoader::ReloadTask(obj::LoaderState       t_state,
+                                 obj::Model             t_model,
+                                 const obj::ModelChange t_change,
+                                 const unsigned int     t_taskNumber) const {
   try {
-    const Timer processTime;
-    const auto  parent = t_state.path.parent_path().parent_path().parent_path(); // two levels up
-    log                = std::format(
-      "Started loading task #{} - {} on thread: {}",
+    t_state.cancel.ThrowIfCancelled();
+
+    const Timer reloadTime;
+    t_state.stats.queueWait = Timer::Clock::now() - t_state.enqueueTime;
+
+    // the entry covers every file of the model, the state only holds the changed ones
+    const bool           useCache = (t_state.flags & obj::Flag::BinaryCache) == obj::Flag::BinaryCache;
+    obj::ModelCacheEntry cacheEntry;
+    if (useCache) {
+      obj::LoaderState entryState(t_state.flags);
+      entryState.path           = t_state.path;
+      entryState.cacheDirectory = t_state.cacheDirectory;
+      entryState.lodRatios      = t_state.lodRatios;
+      entryState.filePaths      = t_change.files;
+      cacheEntry                = obj::GetModelCacheEntry(entryState);
+    }
+
+    // an mtl on its own only changes which textures the meshes point at
+    for (const unsigned int lodLevel : t_change.mtlLods) {
+      const auto file   = std::ranges::find(t_change.files, lodLevel, &obj::File::lodLevel);
+      const auto meshes = t_model.meshes.find(lodLevel);
+      if (file == t_change.files.end() || meshes == t_model.meshes.end()) {
+        continue;
+      }
+
+      if (t_state.materialRegistry) {
+        RunStage(
+          t_state,
+          obj::Stage::ParseMtl,
+          [&]
+          {
+            const auto library = t_state.materialRegistry->Load(file->mtlPath, &t_state.stats.bytesRead);
+            obj::ReassignMaterials(meshes->second, *library);
+            obj::SyncDrawRangeMaterials(t_model.combinedMeshes, meshes->second, lodLevel);
+          });
+        continue;
+      }
+
+      obj::FileBuffer buffer;
+      RunStage(
+        t_state,
+        obj::Stage::Io,
+        [&]
+        {
+          buffer = obj::FileBuffer::Read(file->mtlPath);
+          t_state.stats.bytesRead += buffer.Size();
+        });
+      RunStage(
+        t_state,
+        obj::Stage::ParseMtl,
+        [&]
+        {
+          obj::ParseMtl(t_state, buffer.View(), lodLevel);
+          obj::ReassignMaterials(meshes->second, t_state.materials[lodLevel]);
+          obj::SyncDrawRangeMaterials(t_model.combinedMeshes, meshes->second, lodLevel);
+        });
+    }
+
+    obj::LoadStats stats = t_state.stats;
+
+    if (!t_state.filePaths.empty()) {
+      std::unordered_map<unsigned int, obj::FileBuffer> objBuffers;
+      std::unordered_map<unsigned int, obj::FileBuffer> mtlBuffers;
+
+      obj::Model reloaded = LoadFileInternal(t_state, objBuffers, mtlBuffers);
+      stats               = reloaded.stats;
+
+      for (auto& [lodLevel, meshes] : reloaded.meshes) {
+        t_model.meshes[lodLevel] = std::move(meshes);
+      }
+
+      // offsets span every lod, so lods after a reparsed one move too
+      obj::LoaderState offsets(t_change.flags);
+      offsets.meshes = std::move(t_model.meshes);
+      obj::AssignBaseOffsets(offsets);
+      t_model.meshes = std::move(offsets.meshes);
+
+      // there is one combined mesh per lod, only the reparsed ones are replaced
+      for (auto& combined : reloaded.combinedMeshes) {
+        if (auto it = std::ranges::find(t_model.combinedMeshes, combined.lodLevel, &obj::Mesh::lodLevel);
+            it != t_model.combinedMeshes.end()) {
+          *it = std::move(combined);
+        }
+        else {
+          t_model.combinedMeshes.push_back(std::move(combined));
+        }
+      }
+      std::ranges::stable_sort(t_model.combinedMeshes, {}, &obj::Mesh::lodLevel);
+    }
+
+    for (const auto& meshes : t_model.meshes | std::views::values) {
+      for (const auto& mesh : meshes) {
+        stats.vertexCount += mesh.VertexCount();
+        stats.indexCount += mesh.IndexCount();
+      }
+    }
+    // lods loaded into caller buffers are gone from the Model, the next full load writes the entry instead
+    auto       inBuffer  = [] (const obj::Mesh& t_mesh) { return t_mesh.buffer.has_value(); };
+    const bool holdsData = std::ranges::none_of(t_model.meshes | std::views::values | std::views::join, inBuffer) &&
+                           std::ranges::none_of(t_model.combinedMeshes, inBuffer);
+    if (useCache && holdsData) {
+      // a failed cache write only costs the next load its head start, the model itself is fine
+      try {
+        const Timer cacheWriteTime;
+        obj::WriteModelCache(cacheEntry, t_model);
+        stats.stages[static_cast<size_t>(obj::Stage::CacheWrite)] += cacheWriteTime.Elapsed();
+      }
+      catch (const std::exception& e) {
+        m_logger->Log<Logger::Warning>("Failed to write cache for task #{}: {}", t_taskNumber, e.what());
+      }
+    }
+
+    stats.total   = stats.queueWait + reloadTime.Elapsed();
+    t_model.stats = stats;
+
+    m_logger->Log<Logger::Debug>(
+      "Reloaded task #{} ({} obj and {} mtl lods) in {:L}",
       t_taskNumber,
-      t_state.path.lexically_relative(parent).generic_string(),
-      id.str());
-    m_logger->Log<Logger::Debug>(log);
+      t_change.objLods.size(),
+      t_change.mtlLods.size(),
+      reloadTime.Elapsed());
+
+    // stats are only observed, a throwing callback must not cost the reload its result
+    if (t_state.onStats) {
+      try {
+        t_state.onStats(t_model.path, t_model.stats);
+      }
+      catch (const std::exception& e) {
+        m_logger->Log<Logger::Error>("Stats callback for task #{} threw: {}", t_taskNumber, e.what());
+      }
+      catch (...) {
+        m_logger->Log<Logger::Error>("Stats callback for task #{} threw", t_taskNumber);
+      }
+    }
+
+    return t_model;
+  }
+  catch (const std::exception& e) {
+    m_logger->Log<Logger::Error>("Error reloading task #{}: {}", t_taskNumber, e.what());
+    throw; // still propagate to future
+  }
+}
+
+/*!
+ * @brief Creates the loader state of one model and finds all of its obj, mtl and lod files
+ * @param t_path Relative path to obj file, including file extension
+ * @param t_flags Processing flags, none if empty
+ * @param t_directoryFiles Pre-scanned files of the model's directory for lod discovery, scanned here if null
+ * @return Loader state ready to be processed by ConstructTask
+ */
+obj::LoaderState ObjLoader::CreateState(const std::filesystem::path&              t_path,
+                                        const std::optional<obj::Flag>            t_flags,
+                                        const std::vector<std::filesystem::path>* t_directoryFiles) {
+  obj::LoaderState state = InitState(t_path, t_flags);
+
+  // get file paths of all obj, mtl and lods
+  if (t_directoryFiles) {
+    obj::CacheFilePaths(state, *t_directoryFiles);
+  }
+  else {
+    obj::CacheFilePaths(state);
+  }
+
+  for (const auto& file : state.filePaths) {
+    if (file.mtlPath.empty()) {
+      m_logger->Log<Logger::Warning>("No mtl found for file: {}", file.objPath.string());
+    }
+  }
+
+  return state;
+}
+
+/*!
+ * @brief Creates the loader state of one model with the loader's current settings, without looking for its files
+ * @param t_path Relative path to obj file, including file extension
+ * @param t_flags Processing flags, none if empty
+ * @return Loader state whose filePaths are still empty
+ */
+obj::LoaderState ObjLoader::InitState(const std::filesystem::path& t_path, const std::optional<obj::Flag> t_flags) {
+  obj::LoaderState state(t_flags.value_or(obj::Flag::None));
+
+  state.path           = t_path;
+  state.threadPool     = &m_threadPool;
+  state.cacheDirectory = m_cacheDirectory;
+  state.lodRatios      = m_lodRatios;
+  state.trace          = m_trace;
+  state.onStats        = m_onStats;
+
+  if ((state.flags & obj::Flag::SharedMaterials) == obj::Flag::SharedMaterials) {
+    state.materialRegistry = m_materials.get();
+  }
+
+  return state;
+}
+
+/*!
+ * @brief Hands the per-load options of a request to its state, everything but the path, flags and priority
+ * @param t_state State created for the request
+ * @param t_request Request the state was created for
+ */
+void ObjLoader::ApplyRequest(obj::LoaderState& t_state, const LoadRequest& t_request) {
+  ApplyOutputOptions(t_state, t_request.cancel, t_request.allocator, t_request.vertexFormat);
+}
+
+obj::Model ObjLoader::ConstructTask(const obj::LoaderState&                        t_state,
+                                    std::unordered_map<unsigned int, obj::FileBuffer> t_objBuffers,
+                                    std::unordered_map<unsigned int, obj::FileBuffer> t_mtlBuffers,
+                                    const std::chrono::duration<double, std::milli>   t_cacheElapsed,
+                                    unsigned int                                      t_taskNumber) const {
+  const std::thread::id threadId = std::this_thread::get_id();
+
+  try {
+    // a load cancelled while it was queued doesn't even touch its files
+    t_state.cancel.ThrowIfCancelled();
+
+    const Timer processTime;
 
     // since lambda is immutable, and we have to std::move the state,
     // un-const t_state to pass the method for modification
-    auto m = LoadFileInternal(const_cast<obj::LoaderState&>(t_state), t_objBuffers, t_mtlBuffers);
+    auto& state           = const_cast<obj::LoaderState&>(t_state);
+    state.stats.queueWait = Timer::Clock::now() - state.enqueueTime;
+
+    // the path and thread strings allocate, only build them if the message is printed
+    if (m_logger->IsEnabled<Logger::Debug>()) {
+      const auto parent = t_state.path.parent_path().parent_path().parent_path(); // two levels up
+      m_logger->Log<Logger::Debug>(
+        "Started loading task #{} - {} on thread: {}",
+        t_taskNumber,
+        t_state.path.lexically_relative(parent).generic_string(),
+        obj::QueuedTask::ThreadIdString(threadId));
+    }
+
+    const bool useCache = (state.flags & obj::Flag::BinaryCache) == obj::Flag::BinaryCache;
+
+    // interim containers come out of this worker's arena, they are dropped and the arena reset however the task ends
+    struct ArenaScope
+    {
+      obj::LoaderState& state;
+
+      ~ArenaScope() {
+        state.tempMeshes.clear();
+        obj::TaskArena::ForThisThread().Reset();
+      }
+    } arenaScope{state};
+
+    state.arena = &obj::TaskArena::ForThisThread();
+
+    // counts and totals are only known once the model is, whichever way it was made
+    auto finishStats = [&] (obj::Model& t_model)
+    {
+      for (const auto& meshes : t_model.meshes | std::views::values) {
+        for (const auto& mesh : meshes) {
+          t_model.stats.vertexCount += mesh.VertexCount();
+          t_model.stats.indexCount += mesh.IndexCount();
+        }
+      }
+
+      t_model.stats.peakTempBytes = obj::TaskArena::ForThisThread().BytesUsed();
+      t_model.stats.total         = t_cacheElapsed + t_model.stats.queueWait + processTime.Elapsed();
+
+      if (!state.onStats) {
+        return;
+      }
+
+      // stats are only observed, a throwing callback must not cost the load its result
+      try {
+        state.onStats(t_model.path, t_model.stats);
+      }
+      catch (const std::exception& e) {
+        m_logger->Log<Logger::Error>("Stats callback for task #{} threw: {}", t_taskNumber, e.what());
+      }
+      catch (...) {
+        m_logger->Log<Logger::Error>("Stats callback for task #{} threw", t_taskNumber);
+      }
+    };
+
+    obj::ModelCacheEntry cacheEntry;
+    bool                 cacheHit = false;
+    if (useCache) {
+      RunStage(
+        state,
+        obj::Stage::CacheRead,
+        [&]
+        {
+          cacheEntry = obj::GetModelCacheEntry(state);
+          cacheHit   = obj::ReadModelCache(cacheEntry, state);
+        });
+    }
+
+    if (cacheHit) {
+      // the cache can't hold ids, they only mean something to this loader's registry
+      if (state.materialRegistry) {
+        RunStage(state, obj::Stage::ParseMtl, [&] { obj::LoadSharedMaterials(state); });
+      }
+
+      // cached lods are all ready at once, still report them the way a fresh load would
+      if (state.onLodLoaded) {
+        for (const auto& [lodLevel, meshes] : state.meshes | std::views::reverse) {
+          state.onLodLoaded(lodLevel, meshes);
+        }
+      }
 
-    log = std::format("Successfully loaded task #{} in {:L}", t_taskNumber, processTime.Elapsed() + t_cacheElapsed);
-    m_logger->Log<Logger::Debug>(log);
+      RunStage(state, obj::Stage::WriteBuffers, [&] { obj::WriteBuffers(state); });
 
+      m_logger->Log<Logger::Debug>("Loaded task #{} from cache in {:L}", t_taskNumber, processTime.Elapsed() + t_cacheElapsed);
+
+      state.stats.fromCache = true;
+      obj::Model m(state);
+      finishStats(m);
+      return m;
+    }
+
+    // the cache is written from the Model, so the caller's buffers are only filled once that is done
+    obj::BufferAllocator allocator = useCache ? std::move(state.bufferAllocator) : nullptr;
+
+    auto m = LoadFileInternal(state, t_objBuffers, t_mtlBuffers);
+
+    if (useCache) {
+      // a failed cache write only costs the next load its head start, the model itself is fine
+      try {
+        const Timer cacheWriteTime;
+        obj::WriteModelCache(cacheEntry, m);
+        m.stats.stages[static_cast<size_t>(obj::Stage::CacheWrite)] += cacheWriteTime.Elapsed();
+      }
+      catch (const std::exception& e) {
+        m_logger->Log<Logger::Warning>("Failed to write cache for task #{}: {}", t_taskNumber, e.what());
+      }
+    }
+
+    if (allocator) {
+      obj::LoaderState output(state.flags);
+      output.path           = m.path;
+      output.threadPool     = state.threadPool;
+      output.trace          = state.trace;
+      output.meshes         = std::move(m.meshes);
+      output.combinedMeshes = std::move(m.combinedMeshes);
+      ApplyOutputOptions(output, state.cancel, std::move(allocator), state.vertexFormat);
+
+      RunStage(output, obj::Stage::WriteBuffers, [&] { obj::WriteBuffers(output); });
+
+      m.meshes         = std::move(output.meshes);
+      m.combinedMeshes = std::move(output.combinedMeshes);
+      m.stats.stages[static_cast<size_t>(obj::Stage::WriteBuffers)] += output.stats.StageTime(obj::Stage::WriteBuffers);
+    }
+
+    m_logger->Log<Logger::Debug>("Successfully loaded task #{} in {:L}", t_taskNumber, processTime.Elapsed() + t_cacheElapsed);
+
+    finishStats(m);
     return m;
   }
   catch (const std::exception& e) {
-    log = std::format("Error loading model on thread {}: {}", id.str(), e.what());
-    m_logger->Log<Logger::Error>(log);
+    m_logger->Log<Logger::Error>("Error loading model on thread {}: {}", obj::QueuedTask::ThreadIdString(threadId), e.what());
     throw; // still propagate to future
   }
   catch (...) {
-    log = std::format("Error loading model on thread {}", id.str());
-    m_logger->Log<Logger::Error>(log);
+    m_logger->Log<Logger::Error>("Error loading model on thread {}", obj::QueuedTask::ThreadIdString(threadId));
     throw; // still propagate to future
   }
 }
 
 /*!
  * @brief Parses and processes every file associated with the specified t_path given to LoadFile()
+ * \n Every lod is parsed and run through the per-mesh stages as its own subtask on the state's thread pool, reported
+ * through t_state.onLodLoaded when done, then the lods are merged and combined
  * @param t_state The instance-thread specific state data that houses temporary processing containers
- * @param t_objBuffer Map of every detected obj loaded into memory as a std::string
- * @param t_mtlBuffer Map of every detected mtl loaded into memory as a std::string
+ * @param t_objBuffer Map of every obj read by LoadFile, lods missing from it are read or memory-mapped here
+ * @param t_mtlBuffer Map of every mtl read by LoadFile, lods missing from it are read or memory-mapped here
  * @return Rvalue Model constructed with the processed data
  */
-obj::Model ObjLoader::LoadFileInternal(obj::LoaderState&                                    t_state,
-                                       const std::unordered_map<unsigned int, std::string>& t_objBuffer,
-                                       const std::unordered_map<unsigned int, std::string>& t_mtlBuffer) {
-  // Parse all files first
-  for (const auto& [objPath, mtlPath, lodLevel] : t_state.filePaths) {
-    obj::ParseMtl(t_state, t_mtlBuffer.at(lodLevel), lodLevel);
-    obj::ParseObj(t_state, t_objBuffer.at(lodLevel), lodLevel);
+obj::Model ObjLoader::LoadFileInternal(obj::LoaderState&                                  t_state,
+                                       std::unordered_map<unsigned int, obj::FileBuffer>& t_objBuffer,
+                                       std::unordered_map<unsigned int, obj::FileBuffer>& t_mtlBuffer) {
+  const bool mapFiles = (t_state.flags & obj::Flag::MapFiles) == obj::Flag::MapFiles;
+  auto       open     = [mapFiles] (const std::filesystem::path& t_path)
+  {
+    return mapFiles ? obj::FileBuffer::Map(t_path) : obj::FileBuffer::Read(t_path);
+  };
+
+  const size_t lodCount = t_state.filePaths.size();
+
+  // every lod parses into a state of its own, so parallel parses never insert into the same maps
+  std::vector<obj::LoaderState>               lodStates(lodCount, obj::LoaderState(t_state.flags));
+  std::vector<std::optional<obj::FileBuffer>> objBuffers(lodCount);
+  std::vector<std::optional<obj::FileBuffer>> mtlBuffers(lodCount);
+
+  for (size_t i = 0; i < lodCount; ++i) {
+    const unsigned int lodLevel = t_state.filePaths[i].lodLevel;
+    lodStates[i].threadPool     = t_state.threadPool;
+    lodStates[i].arena          = t_state.arena;
+    lodStates[i].cancel         = t_state.cancel;
+    lodStates[i].path           = t_state.path;
+    lodStates[i].trace          = t_state.trace;
+
+    lodStates[i].materialRegistry = t_state.materialRegistry;
+
+    if (auto it = t_objBuffer.find(lodLevel); it != t_objBuffer.end()) {
+      objBuffers[i] = std::move(it->second);
+    }
+    if (auto it = t_mtlBuffer.find(lodLevel); it != t_mtlBuffer.end()) {
+      mtlBuffers[i] = std::move(it->second);
+    }
   }
 
-  obj::ConstructVertices(t_state);
+  t_objBuffer.clear();
+  t_mtlBuffer.clear();
 
-  if ((t_state.flags & obj::Flag::JoinIdentical) == obj::Flag::JoinIdentical) {
-    obj::JoinIdenticalVertices(t_state);
+  // lod 0 keeps the file paths, so lod generation knows which levels already have a file of their own
+  if ((t_state.flags & obj::Flag::GenerateLods) == obj::Flag::GenerateLods) {
+    for (size_t i = 0; i < lodCount; ++i) {
+      if (t_state.filePaths[i].lodLevel == 0) {
+        lodStates[i].filePaths = t_state.filePaths;
+        lodStates[i].lodRatios = t_state.lodRatios;
+      }
+    }
   }
 
-  if ((t_state.flags & obj::Flag::CalculateTangents) == obj::Flag::CalculateTangents) {
-    obj::CalcTangentSpace(t_state);
+  auto loadLod = [&] (const size_t t_i)
+  {
+    const auto& [objPath, mtlPath, lodLevel] = t_state.filePaths[t_i];
+    obj::LoaderState& lodState               = lodStates[t_i];
+
+    // the registry opens its mtl files itself, and only the first time it sees them
+    const bool sharedMaterials = lodState.materialRegistry != nullptr;
+
+    lodState.cancel.ThrowIfCancelled();
+
+    if ((!mtlBuffers[t_i] && !sharedMaterials) || !objBuffers[t_i]) {
+      RunStage(
+        lodState,
+        obj::Stage::Io,
+        [&]
+        {
+          if (!mtlBuffers[t_i] && !sharedMaterials) {
+            mtlBuffers[t_i] = open(mtlPath);
+            lodState.stats.bytesRead += mtlBuffers[t_i]->Size();
+          }
+          if (!objBuffers[t_i]) {
+            objBuffers[t_i] = open(objPath);
+            lodState.stats.bytesRead += objBuffers[t_i]->Size();
+          }
+        });
+    }
+
+    RunStage(
+      lodState,
+      obj::Stage::ParseMtl,
+      [&]
+      {
+        if (sharedMaterials) {
+          lodState.materialLibraries[lodLevel] = lodState.materialRegistry->Load(mtlPath, &lodState.stats.bytesRead);
+        }
+        else {
+          obj::ParseMtl(lodState, mtlBuffers[t_i]->View(), lodLevel);
+        }
+      });
+    RunStage(
+      lodState,
+      obj::Stage::ParseObj,
+      [&]
+      {
+        if ((lodState.flags & obj::Flag::ParallelParse) == obj::Flag::ParallelParse) {
+          obj::ParseObjParallel(lodState, objBuffers[t_i]->View(), lodLevel);
+        }
+        else {
+          obj::ParseObj(lodState, objBuffers[t_i]->View(), lodLevel);
+        }
+      });
+
+    // nothing references the file contents after parsing, release the memory or mapping early
+    mtlBuffers[t_i].reset();
+    objBuffers[t_i].reset();
+    lodState.cancel.ThrowIfCancelled();
+
+    ProcessMeshes(lodState);
+    lodState.tempMeshes.clear();
+
+    // coarsest first, that is what a streaming renderer can show soonest
+    if (t_state.onLodLoaded) {
+      for (const auto& [level, meshes] : lodState.meshes | std::views::reverse) {
+        t_state.onLodLoaded(level, meshes);
+      }
+    }
+  };
+
+  // one subtask per lod that parses and processes it on its own, so small lods finish without waiting for big ones
+  if (t_state.threadPool) {
+    t_state.threadPool->ParallelFor(lodCount, loadLod);
+  }
+  else {
+    for (size_t i = 0; i < lodCount; ++i) {
+      loadLod(i);
+    }
   }
 
+  // merge in file order, so the last mtllib wins just like it would in one serial pass
+  for (auto& lodState : lodStates) {
+    for (auto& [lodLevel, meshes] : lodState.meshes) {
+      t_state.meshes[lodLevel] = std::move(meshes);
+    }
+    for (auto& [lodLevel, materials] : lodState.materials) {
+      t_state.materials[lodLevel] = std::move(materials);
+    }
+    if (!lodState.mtlFileName.empty()) {
+      t_state.mtlFileName = std::move(lodState.mtlFileName);
+    }
+    t_state.stats += lodState.stats;
+  }
+
+  lodStates.clear();
+
+  // offsets span every lod, which only the merged state knows about
+  obj::AssignBaseOffsets(t_state);
+  t_state.cancel.ThrowIfCancelled();
+
   if ((t_state.flags & obj::Flag::CombineMeshes) == obj::Flag::CombineMeshes) {
-    obj::CombineMeshes(t_state);
+    RunStage(t_state, obj::Stage::CombineMeshes, [&] { obj::CombineMeshes(t_state); });
+  }
+
+  // after combining, so the combined mesh of a lod gets 16-bit indices only if all of it fits
+  if ((t_state.flags & obj::Flag::CompactIndices) == obj::Flag::CompactIndices) {
+    RunStage(t_state, obj::Stage::CompactIndices, [&] { obj::CompactIndices(t_state); });
+  }
+
+  if (t_state.bufferAllocator) {
+    RunStage(t_state, obj::Stage::WriteBuffers, [&] { obj::WriteBuffers(t_state); });
   }
 
   return obj::Model(t_state);
 }
+
+/*!
+ * @brief Runs every per-mesh stage enabled by the state's flags over its meshes, each stage fanning out per mesh
+ * @param t_state State of one lod, or of lod 0 and the lods generated from it
+ */
+void ObjLoader::ProcessMeshes(obj::LoaderState& t_state) {
+  auto countVertices = [&t_state]
+  {
+    size_t count = 0;
+    for (const auto& meshes : t_state.meshes | std::views::values) {
+      for (const auto& mesh : meshes) {
+        count += mesh.VertexCount();
+      }
+    }
+    return count;
+  };
+
+  // each stage joins before the next one starts, cancellation is checked in between
+  RunStage(t_state, obj::Stage::ConstructVertices, [&] { obj::ConstructVertices(t_state); });
+  t_state.cancel.ThrowIfCancelled();
+
+  for (const auto& meshes : t_state.meshes | std::views::values) {
+    for (const auto& mesh : meshes) {
+      t_state.stats.cornerCount += mesh.indices.size();
+    }
+  }
+  t_state.stats.constructedVertexCount = countVertices();
+  t_state.stats.weldedVertexCount      = t_state.stats.constructedVertexCount;
+
+  if ((t_state.flags & obj::Flag::JoinIdentical) == obj::Flag::JoinIdentical) {
+    RunStage(t_state, obj::Stage::JoinIdentical, [&] { obj::JoinIdenticalVertices(t_state); });
+    t_state.cancel.ThrowIfCancelled();
+    t_state.stats.weldedVertexCount = countVertices();
+  }
+
+  // lods are generated before tangents, so they get tangents of their own rather than welded copies of lod 0's
+  if ((t_state.flags & obj::Flag::GenerateLods) == obj::Flag::GenerateLods) {
+    RunStage(t_state, obj::Stage::GenerateLods, [&] { obj::GenerateLods(t_state); });
+    t_state.cancel.ThrowIfCancelled();
+  }
+
+  if ((t_state.flags & obj::Flag::CalculateTangents) == obj::Flag::CalculateTangents) {
+    RunStage(t_state, obj::Stage::CalcTangentSpace, [&] { obj::CalcTangentSpace(t_state); });
+    t_state.cancel.ThrowIfCancelled();
+  }
+
+  if ((t_state.flags & obj::Flag::OptimizeVertexCache) == obj::Flag::OptimizeVertexCache ||
+      (t_state.flags & obj::Flag::OptimizeOverdraw) == obj::Flag::OptimizeOverdraw) {
+    RunStage(t_state, obj::Stage::OptimizeIndices, [&] { obj::OptimizeIndices(t_state); });
+    t_state.cancel.ThrowIfCancelled();
+  }
+
+  // meshlets follow the final index order, build them after it was optimized
+  if ((t_state.flags & obj::Flag::BuildMeshlets) == obj::Flag::BuildMeshlets) {
+    RunStage(t_state, obj::Stage::BuildMeshlets, [&] { obj::BuildMeshlets(t_state); });
+    t_state.cancel.ThrowIfCancelled();
+  }
+
+  if ((t_state.flags & obj::Flag::SplitStreams) == obj::Flag::SplitStreams) {
+    RunStage(t_state, obj::Stage::SplitStreams, [&] { obj::SplitVertexStreams(t_state); });
+  }
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "obj/TaskArena.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace obj
+{
+  /*!
+   * @param t_blockSize Size of the retained block the arena starts out with
+   */
+  TaskArena::TaskArena(const size_t t_blockSize) : m_block(new std::byte[t_blockSize]), m_blockSize(t_blockSize) {
+    m_resource.emplace(m_block.get(), m_blockSize, std::pmr::new_delete_resource());
+  }
+
+  /*!
+   * @brief Returns the arena of the calling thread, created on first use and kept for the lifetime of the thread
+   */
+  TaskArena& TaskArena::ForThisThread() {
+    thread_local TaskArena arena;
+    return arena;
+  }
+
+  /*!
+   * @brief Frees everything allocated since the last reset. If the task spilled past the retained block, the block is
+   * grown so the next task of the same size fits in it
+   */
+  void TaskArena::Reset() {
+    std::lock_guard lock(m_mutex);
+
+    if (m_used > m_blockSize && m_blockSize < MAX_BLOCK_BYTES) {
+      m_resource.reset();
+      m_blockSize = std::min(std::bit_ceil(m_used), MAX_BLOCK_BYTES);
+      m_block     = std::unique_ptr<std::byte[]>(new std::byte[m_blockSize]); // left uninitialized, unlike make_unique
+      m_resource.emplace(m_block.get(), m_blockSize, std::pmr::new_delete_resource());
+    }
+    else {
+      m_resource->release();
+    }
+
+    m_used = 0;
+  }
+
+  /*!
+   * @brief Bytes handed out since the last reset, deallocations don't count against it, so this is the task's peak
+   */
+  size_t TaskArena::BytesUsed() {
+    std::lock_guard lock(m_mutex);
+    return m_used;
+  }
+
+  void* TaskArena::do_allocate(const size_t t_bytes, const size_t t_alignment) {
+    std::lock_guard lock(m_mutex);
+    m_used += t_bytes;
+    return m_resource->allocate(t_bytes, t_alignment);
+  }
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "obj/VertexLayout.hpp"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace obj
+{
+  namespace
+  {
+    template <VertexLayout Layout>
+    PositionQuantization PackInto(const Mesh& t_mesh, std::byte* t_out) {
+      PositionQuantization quantization;
+      if constexpr (Layout::QUANTIZED_POSITION) {
+        quantization = GetPositionQuantization(t_mesh);
+      }
+
+      // the caller's memory holds no objects and may be unaligned for the layout, so every vertex is copied in
+      for (const Vertex& v : t_mesh.vertices) {
+        const Layout packed = Layout::Pack(v, quantization);
+        std::memcpy(t_out, &packed, sizeof(Layout));
+        t_out += sizeof(Layout);
+      }
+      return quantization;
+    }
+  }
+
+  /*!
+   * @brief Throws unless the mesh still has its interleaved vertices, the only input the layouts pack from
+   * @param t_mesh Mesh about to be packed
+   */
+  void RequireInterleaved(const Mesh& t_mesh) {
+    if (t_mesh.buffer || (t_mesh.vertices.empty() && !t_mesh.positions.empty())) {
+      throw std::runtime_error("Vertex layouts need interleaved vertices, not split streams or a caller's buffer: " +
+                               t_mesh.name);
+    }
+  }
+
+  /*!
+   * @brief Bytes per vertex of an output format
+   * @param t_format Format as chosen by LoadRequest::vertexFormat
+   */
+  size_t VertexFormatSize(const VertexFormat t_format) {
+    switch (t_format) {
+      case VertexFormat::HalfUv: return sizeof(HalfUvVertex);
+      case VertexFormat::Compact: return sizeof(CompactVertex);
+      case VertexFormat::Quantized: return sizeof(QuantizedVertex);
+      case VertexFormat::Position: return sizeof(PositionVertex);
+      case VertexFormat::QuantizedPosition: return sizeof(QuantizedPositionVertex);
+      default: return sizeof(Vertex);
+    }
+  }
+
+  /*!
+   * @brief Writes the interleaved vertices of a mesh into raw memory in a chosen format, the runtime counterpart of
+   * PackVertices<Layout>() that WriteBuffers() uses for LoadRequest::vertexFormat
+   * @param t_mesh Processed mesh with interleaved vertices
+   * @param t_format Output format
+   * @param t_out At least VertexFormatSize(t_format) bytes per vertex
+   * @return Scale and bias needed to decode quantized positions, identity for the other formats
+   */
+  PositionQuantization PackVertices(const Mesh& t_mesh, const VertexFormat t_format, std::byte* t_out) {
+    RequireInterleaved(t_mesh);
+
+    switch (t_format) {
+      case VertexFormat::HalfUv: return PackInto<HalfUvVertex>(t_mesh, t_out);
+      case VertexFormat::Compact: return PackInto<CompactVertex>(t_mesh, t_out);
+      case VertexFormat::Quantized: return PackInto<QuantizedVertex>(t_mesh, t_out);
+      case VertexFormat::Position: return PackInto<PositionVertex>(t_mesh, t_out);
+      case VertexFormat::QuantizedPosition: return PackInto<QuantizedPositionVertex>(t_mesh, t_out);
+      default:
+        std::memcpy(t_out, t_mesh.vertices.data(), t_mesh.vertices.size() * sizeof(Vertex));
+        return {};
+    }
+  }
+
+  /*!
+   * @brief Calculates the scale and bias that map a mesh's bounding box onto the 16-bit unorm range
+   * @param t_mesh Mesh to quantize
+   * @return Bounds minimum as bias and extent as scale, axes without extent get a scale of zero
+   */
+  PositionQuantization GetPositionQuantization(const Mesh& t_mesh) {
+    if (t_mesh.vertices.empty()) {
+      return {};
+    }
+
+    glm::vec3 min(FLT_MAX);
+    glm::vec3 max(-FLT_MAX);
+
+    for (const Vertex& v : t_mesh.vertices) {
+      min = glm::min(min, v.position);
+      max = glm::max(max, v.position);
+    }
+
+    return {.scale = max - min, .bias = min};
+  }
+
+  std::uint32_t PackHalf2(const glm::vec2& t_v) {
+    return glm::packHalf2x16(t_v);
+  }
+
+  /*!
+   * @brief Packs a unit tangent into signed 10-bit xyz with the bitangent sign in the 2-bit w
+   * @param t_tangent Tangent with handedness in w, as written by CalcTangentSpace
+   */
+  std::uint32_t PackTangent_2_10_10_10_REV(const glm::vec4& t_tangent) {
+    return glm::packSnorm3x10_1x2(glm::vec4(t_tangent.x, t_tangent.y, t_tangent.z, t_tangent.w < 0.0f ? -1.0f : 1.0f));
+  }
+
+  void QuantizePosition(const glm::vec3& t_position, const PositionQuantization& t_q, std::uint16_t (&t_out)[3]) {
+    for (int i = 0; i < 3; ++i) {
+      const float unorm = t_q.scale[i] > 0.0f ? (t_position[i] - t_q.bias[i]) / t_q.scale[i] : 0.0f;
+      t_out[i]          = static_cast<std::uint16_t>(std::round(glm::clamp(unorm, 0.0f, 1.0f) * 65535.0f));
+    }
+  }
+
+  HalfUvVertex HalfUvVertex::Pack(const Vertex& t_v, const PositionQuantization&) {
+    return {
+      .position = t_v.position,
+      .packedNormal = t_v.packedNormal,
+      .texCoords = PackHalf2(t_v.texCoords),
+      .tangent = t_v.tangent
+    };
+  }
+
+  CompactVertex CompactVertex::Pack(const Vertex& t_v, const PositionQuantization&) {
+    return {
+      .position = t_v.position,
+      .packedNormal = t_v.packedNormal,
+      .texCoords = PackHalf2(t_v.texCoords),
+      .packedTangent = PackTangent_2_10_10_10_REV(t_v.tangent)
+    };
+  }
+
+  QuantizedVertex QuantizedVertex::Pack(const Vertex& t_v, const PositionQuantization& t_q) {
+    QuantizedVertex packed{};
+    QuantizePosition(t_v.position, t_q, packed.position);
+    packed.packedNormal  = t_v.packedNormal;
+    packed.texCoords     = PackHalf2(t_v.texCoords);
+    packed.packedTangent = PackTangent_2_10_10_10_REV(t_v.tangent);
+    return packed;
+  }
+
+  PositionVertex PositionVertex::Pack(const Vertex& t_v, const PositionQuantization&) {
+    return {.position = t_v.position};
+  }
+
+  QuantizedPositionVertex QuantizedPositionVertex::Pack(const Vertex& t_v, const PositionQuantization& t_q) {
+    QuantizedPositionVertex packed{};
+    QuantizePosition(t_v.position, t_q, packed.position);
+    return packed;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "obj/VertexWelder.hpp"
+
+#include "obj/ObjHelpers.hpp"
+
+namespace obj
+{
+  /*!
+   * @brief Deduplicates vertices with identical pos, uv, normal and tangent data and rewrites the indices to match.
+   * \n Unique vertices keep the order in which the indices first reference them
+   * @param t_mesh Mesh to weld in place
+   */
+  void VertexWelder::Weld(Mesh& t_mesh) {
+    const size_t vertexCount = t_mesh.vertices.size();
+
+    // keep the load factor at or below one half so probe sequences stay short
+    size_t capacity = 16;
+    while (capacity < vertexCount * 2) {
+      capacity <<= 1;
+    }
+    const size_t mask = capacity - 1;
+
+    m_slots.assign(capacity, EMPTY);
+    m_remap.assign(vertexCount, EMPTY);
+    m_keys.clear();
+
+    std::vector<Vertex> newVertices;
+    newVertices.reserve(vertexCount);
+
+    for (auto& idx : t_mesh.indices) {
+      std::uint32_t& id = m_remap[idx];
+
+      // only hash each input vertex once, no matter how many faces share it
+      if (id == EMPTY) {
+        const Vertex& v   = t_mesh.vertices[idx];
+        const Key     key = MakeKey(v);
+
+        for (size_t slot = HashKey(key) & mask;; slot = (slot + 1) & mask) {
+          const std::uint32_t candidate = m_slots[slot];
+
+          if (candidate == EMPTY) {
+            id            = static_cast<std::uint32_t>(newVertices.size());
+            m_slots[slot] = id;
+            m_keys.push_back(key);
+            newVertices.push_back(v);
+            break;
+          }
+
+          if (m_keys[candidate] == key && VertexEqual{}(newVertices[candidate], v)) {
+            id = candidate;
+            break;
+          }
+        }
+      }
+
+      idx = id;
+    }
+
+    t_mesh.vertices.swap(newVertices);
+
+    // don't let one huge mesh pin its scratch memory on this thread forever
+    if (capacity > MAX_RETAINED_SLOTS) {
+      m_slots = {};
+      m_keys  = {};
+      m_remap = {};
+    }
+  }
+
+  VertexWelder::Key VertexWelder::MakeKey(const Vertex& t_vertex) noexcept {
+    return {
+      VertexHasher::Quantize(t_vertex.position.x),
+      VertexHasher::Quantize(t_vertex.position.y),
+      VertexHasher::Quantize(t_vertex.position.z),
+      static_cast<std::int32_t>(t_vertex.packedNormal),
+      VertexHasher::Quantize(t_vertex.texCoords.x),
+      VertexHasher::Quantize(t_vertex.texCoords.y),
+      VertexHasher::Quantize(t_vertex.tangent.x),
+      VertexHasher::Quantize(t_vertex.tangent.y),
+      VertexHasher::Quantize(t_vertex.tangent.z),
+      VertexHasher::Quantize(t_vertex.tangent.w)
+    };
+  }
+
+  std::uint64_t VertexWelder::HashKey(const Key& t_key) noexcept {
+    std::uint64_t h = 0;
+    for (const std::int32_t q : t_key) {
+      h = (h ^ static_cast<std::uint32_t>(q)) * 0x9e3779b97f4a7c15;
+    }
+    return h ^ (h >> 32);
+  }
+}
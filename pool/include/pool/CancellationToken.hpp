@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+/*!
+ * @brief Thrown by work that was cancelled or ran past its deadline, a cancelled task's future rethrows it
+ */
+class OperationCancelled : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+/*!
+ * @brief Cancellation flag with an optional deadline, shared by every copy of the token.
+ * \n The thread that queues some work keeps one copy to cancel it, the work checks its own copy between its steps.
+ * A default constructed token can't be cancelled and is free to check, Create() makes one that can
+ */
+class CancellationToken
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  [[nodiscard]] static CancellationToken Create() {
+    CancellationToken token;
+    token.m_state = std::make_shared<State>();
+    return token;
+  }
+
+  // no-op on a default constructed token
+  void Cancel() const noexcept {
+    if (m_state) {
+      m_state->cancelled.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  // the token counts as cancelled from t_deadline on, no-op on a default constructed token
+  void SetDeadline(const Clock::time_point t_deadline) const noexcept {
+    if (m_state) {
+      m_state->deadline.store(t_deadline.time_since_epoch().count(), std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] bool IsCancelled() const noexcept {
+    if (!m_state) {
+      return false;
+    }
+    if (m_state->cancelled.load(std::memory_order_relaxed)) {
+      return true;
+    }
+
+    const Clock::rep deadline = m_state->deadline.load(std::memory_order_relaxed);
+    return deadline != NO_DEADLINE && Clock::now().time_since_epoch().count() >= deadline;
+  }
+
+  void ThrowIfCancelled() const {
+    if (IsCancelled()) {
+      throw OperationCancelled("Operation was cancelled or missed its deadline");
+    }
+  }
+
+private:
+  static constexpr Clock::rep NO_DEADLINE = std::numeric_limits<Clock::rep>::max();
+
+  struct State
+  {
+    std::atomic<bool>       cancelled = false;
+    std::atomic<Clock::rep> deadline  = NO_DEADLINE;
+  };
+
+  std::shared_ptr<State> m_state;
+};
\ No newline at end of file
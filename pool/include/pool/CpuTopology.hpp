@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/*!
+ * @brief Logical cores the process may run on, grouped by NUMA node, queried from the OS once.
+ * \n Platforms or machines without NUMA information report a single node holding every core, pinning is best effort
+ * and reports whether the OS accepted it
+ */
+class CpuTopology
+{
+public:
+  [[nodiscard]] static const CpuTopology& Get();
+
+  [[nodiscard]] size_t                           NodeCount() const { return m_nodes.size(); }
+  [[nodiscard]] const std::vector<unsigned int>& NodeCores(const size_t t_node) const { return m_nodes[t_node]; }
+  [[nodiscard]] const std::vector<unsigned int>& Cores() const { return m_cores; } // node by node
+
+  // restricts the calling thread to one logical core
+  static bool PinToCore(unsigned int t_core);
+
+  // restricts the calling thread to the cores of one node, the OS still balances it between them
+  bool PinToNode(size_t t_node) const;
+
+private:
+  CpuTopology();
+
+  std::vector<std::vector<unsigned int>> m_nodes; // never empty, and neither is any node
+  std::vector<unsigned int>              m_cores;
+};
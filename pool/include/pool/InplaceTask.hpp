@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*!
+ * @brief Move-only void() callable that stores small callables inside itself instead of on the heap.
+ * \n Anything up to INLINE_BYTES that moves without throwing lives in the task, which covers a coroutine handle, a
+ * handful of captured pointers or a std::packaged_task. Larger callables still work and are allocated once
+ */
+class InplaceTask
+{
+public:
+  static constexpr size_t INLINE_BYTES = 48;
+
+  //-------------------------------------------------------------------------------------------------------------------
+  // Constructors/operators
+  InplaceTask() noexcept = default;
+
+  template <typename F>
+    requires (!std::is_same_v<std::decay_t<F>, InplaceTask> && std::is_invocable_v<std::decay_t<F>&>)
+  InplaceTask(F&& t_f) { // implicit, so Dispatch() takes a lambda as it is
+    using Fn = std::decay_t<F>;
+    if constexpr (FITS_INLINE<Fn>) {
+      ::new (static_cast<void*>(m_storage)) Fn(std::forward<F>(t_f));
+      m_ops = &INLINE_OPS<Fn>;
+    }
+    else {
+      ::new (static_cast<void*>(m_storage)) Fn*(new Fn(std::forward<F>(t_f)));
+      m_ops = &HEAP_OPS<Fn>;
+    }
+  }
+
+  ~InplaceTask() { Reset(); }
+
+  InplaceTask(InplaceTask&& t_other) noexcept : m_ops(t_other.m_ops) {
+    if (m_ops) {
+      m_ops->move(t_other.m_storage, m_storage);
+      t_other.m_ops = nullptr;
+    }
+  }
+
+  InplaceTask& operator=(InplaceTask&& t_other) noexcept {
+    if (this != &t_other) {
+      Reset();
+      m_ops = t_other.m_ops;
+      if (m_ops) {
+        m_ops->move(t_other.m_storage, m_storage);
+        t_other.m_ops = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  InplaceTask(const InplaceTask& t_other)            = delete;
+  InplaceTask& operator=(const InplaceTask& t_other) = delete;
+  //-------------------------------------------------------------------------------------------------------------------
+
+  void operator()() { m_ops->invoke(m_storage); }
+
+  explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+  [[nodiscard]] bool IsInline() const noexcept { return m_ops && m_ops->isInline; }
+
+private:
+  struct Operations
+  {
+    void (*invoke)(void* t_storage);
+    void (*move)(void* t_from, void* t_to) noexcept; // leaves t_from destroyed
+    void (*destroy)(void* t_storage) noexcept;
+    bool isInline;
+  };
+
+  template <typename Fn>
+  static constexpr bool FITS_INLINE = sizeof(Fn) <= INLINE_BYTES && alignof(Fn) <= alignof(std::max_align_t) &&
+                                      std::is_nothrow_move_constructible_v<Fn>;
+
+  template <typename Fn>
+  static constexpr Operations INLINE_OPS = {
+    .invoke = [] (void* t_storage) { (*static_cast<Fn*>(t_storage))(); },
+    .move = [] (void* t_from, void* t_to) noexcept
+    {
+      ::new (t_to) Fn(std::move(*static_cast<Fn*>(t_from)));
+      static_cast<Fn*>(t_from)->~Fn();
+    },
+    .destroy = [] (void* t_storage) noexcept { static_cast<Fn*>(t_storage)->~Fn(); },
+    .isInline = true};
+
+  // the storage holds nothing but the pointer, moving the task moves only that
+  template <typename Fn>
+  static constexpr Operations HEAP_OPS = {
+    .invoke = [] (void* t_storage) { (**static_cast<Fn**>(t_storage))(); },
+    .move = [] (void* t_from, void* t_to) noexcept { ::new (t_to) Fn*(*static_cast<Fn**>(t_from)); },
+    .destroy = [] (void* t_storage) noexcept { delete *static_cast<Fn**>(t_storage); },
+    .isInline = false};
+
+  void Reset() noexcept {
+    if (m_ops) {
+      m_ops->destroy(m_storage);
+      m_ops = nullptr;
+    }
+  }
+
+  alignas(std::max_align_t) std::byte m_storage[INLINE_BYTES];
+  const Operations*                   m_ops = nullptr;
+};
@@ -1,13 +1,31 @@
 #pragma once
 
-#define NOMINMAX
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <format>
 #include <fstream>
-#include <map>
-#include <mutex>
-#include <queue>
-#include <windows.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
 
+// Highest severity compiled into Logger::Log calls, 0 Error, 1 Warning, 2 Info, 3 Debug
+// anything above it is stripped at compile time, including the formatting of its arguments
+#ifndef LOGGER_COMPILED_SEVERITY
+#ifdef NDEBUG
+#define LOGGER_COMPILED_SEVERITY 2
+#else
+#define LOGGER_COMPILED_SEVERITY 3
+#endif
+#endif
+
+/*!
+ * @brief Asynchronous logger, producers claim a slot of a fixed ring buffer without locking or allocating and a worker
+ * thread formats, prints and writes them in batches.
+ * \n Messages whose arguments are all numbers or durations are formatted on the worker, anything else is formatted
+ * into the slot right away, truncated to SLOT_BYTES. A full ring drops the message and reports the count later
+ */
 class Logger
 {
 public:
@@ -20,31 +38,7 @@ public:
     None
   };
 
-  struct LogEntry
-  {
-    LogEntry(std::string t_message, const LogSeverity t_severity) : message(std::move(t_message)), severity(t_severity) {}
-    std::string message;
-    LogSeverity severity;
-  };
-
-  struct ConsoleColor
-  {
-    HANDLE h;
-    WORD   original;
-
-    ConsoleColor(const HANDLE t_h, const WORD t_c) : h(t_h) {
-      CONSOLE_SCREEN_BUFFER_INFO info;
-      GetConsoleScreenBufferInfo(t_h, &info);
-      original = info.wAttributes;
-      SetConsoleTextAttribute(t_h, t_c);
-    }
-
-    ~ConsoleColor() { SetConsoleTextAttribute(h, original); }
-    ConsoleColor& operator=(const ConsoleColor&) = delete;
-    ConsoleColor& operator=(ConsoleColor&&)      = delete;
-    ConsoleColor(const ConsoleColor&)            = delete;
-    ConsoleColor(ConsoleColor&&)                 = delete;
-  };
+  static constexpr LogSeverity COMPILED_SEVERITY = static_cast<LogSeverity>(LOGGER_COMPILED_SEVERITY);
 
   //-------------------------------------------------------------------------------------------------------------------
   // Constructors/operators
@@ -62,10 +56,12 @@ public:
 
   void DispatchWorkerThread();
 
+  template <LogSeverity Severity, typename... Args>
+  void Log(std::format_string<Args...> t_format, Args&&... t_args);
+
+  // check before building expensive arguments, Log() only checks once they were evaluated
   template <LogSeverity Severity>
-  void Log(const std::string& t_entry) {
-    ThreadSafeLogMessage(LogEntry(t_entry, Severity));
-  }
+  [[nodiscard]] bool IsEnabled() const noexcept;
 
   void Shutdown();
 
@@ -75,20 +71,68 @@ public:
   std::string           logName = "log.txt";
 
 private:
-  Logger() = default;
-  [[nodiscard]] bool    IsLogLevelEnabled(LogSeverity t_logLevel, bool t_disk = false) const;
-  constexpr static WORD GetSeverityColor(LogSeverity t_logLevel);
-  void                  ThreadSafeLogMessage(LogEntry t_entry);
-  void                  WorkerThread();
-  void                  FlushQueue();
-
-  std::jthread                       m_thread;         // Worker thread
-  std::queue<LogEntry>               m_logQueue;       // The message queue
-  std::mutex                         m_waitLogMutex;   // Mutex for inserting and popping into the queue
-  std::condition_variable            m_cv;             // Cv to wait thread
-  std::thread::id                    m_workerThreadId; // The thread id of the dispatched worker
-  bool                               m_shutdown  = false;
-  bool                               m_logToDisk = false;
-  std::ofstream                      m_diskFile; // disk log file
-  std::map<LogSeverity, std::string> m_severityNames = {{Error, "Error"}, {Warning, "Warning"}, {Info, "Info"}, {Debug, "Debug"}};
+  static constexpr size_t RING_CAPACITY = 1024; // slots, has to be a power of two
+  static constexpr size_t SLOT_BYTES    = 384;  // formatted text or deferred arguments of one message
+
+  using FormatFn = void (*)(const void* t_storage, std::string& t_out);
+
+  struct Slot
+  {
+    std::atomic<size_t>                   sequence; // position it is free for, position + 1 once published
+    std::chrono::system_clock::time_point time;
+    FormatFn                              format = nullptr; // null if storage holds length bytes of finished text
+    size_t                                length = 0;
+    LogSeverity                           severity = None;
+    alignas(std::max_align_t) char        storage[SLOT_BYTES];
+  };
+
+  template <typename... Args>
+  struct Deferred
+  {
+    std::string_view    format;
+    std::tuple<Args...> args;
+  };
+
+  // arguments that are safe to copy into a slot and format later
+  template <typename T>
+  static constexpr bool IsDeferrable() {
+    if constexpr (std::is_arithmetic_v<T>) {
+      return true;
+    }
+    else if constexpr (requires { typename T::rep; typename T::period; }) {
+      return std::is_same_v<T, std::chrono::duration<typename T::rep, typename T::period>> &&
+             std::is_arithmetic_v<typename T::rep>;
+    }
+    else {
+      return false;
+    }
+  }
+
+  template <typename... Args>
+  static void FormatDeferred(const void* t_storage, std::string& t_out);
+
+  Logger();
+  [[nodiscard]] bool IsLogLevelEnabled(LogSeverity t_logLevel, bool t_disk = false) const;
+  [[nodiscard]] Slot* Claim() noexcept;
+  void                Publish(Slot& t_slot) noexcept;
+  void                WorkerThread();
+  bool                FlushQueue();
+
+  std::unique_ptr<Slot[]>               m_slots;              // The message ring
+  alignas(64) std::atomic<size_t>       m_head      = 0;      // Next position to claim, shared by producers
+  alignas(64) size_t                    m_tail      = 0;      // Next position to print, only touched by the worker
+  std::atomic<unsigned int>             m_published = 0;      // Bumped on every publish, what the idle worker waits on
+  std::atomic<bool>                     m_sleeping  = false;  // Worker is about to wait, producers only notify then
+  std::atomic<size_t>                   m_dropped   = 0;      // Messages lost to a full ring since the last flush
+  std::jthread                          m_thread;             // Worker thread
+  std::thread::id                       m_workerThreadId;     // The thread id of the dispatched worker
+  std::atomic<bool>                     m_shutdown  = false;
+  bool                                  m_logToDisk = false;
+  bool                                  m_colorize  = false;  // Console supports colors, checked once on dispatch
+  std::ofstream                         m_diskFile;           // disk log file
+  std::string                           m_message;            // worker scratch, one formatted message
+  std::string                           m_consoleBuffer;      // worker scratch, console text of one batch
+  std::string                           m_diskBuffer;         // worker scratch, disk text of one batch
 };
+
+#include "Logger.inl"
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <new>
+
+/*!
+ * @brief Queues a message for the worker thread, never blocks or allocates
+ * \n Severities above COMPILED_SEVERITY compile to nothing, disabled ones return before formatting anything
+ * @param t_format Format string, checked at compile time
+ * @param t_args Format arguments, numbers and durations are copied and formatted by the worker
+ */
+template <Logger::LogSeverity Severity, typename... Args>
+void Logger::Log(std::format_string<Args...> t_format, Args&&... t_args) {
+  if constexpr (Severity <= COMPILED_SEVERITY) {
+    if (!IsEnabled<Severity>()) {
+      return;
+    }
+
+    Slot* slot = Claim();
+    if (!slot) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    slot->severity = Severity;
+    slot->time     = std::chrono::system_clock::now();
+
+    using Stored = Deferred<std::decay_t<Args>...>;
+    if constexpr ((IsDeferrable<std::decay_t<Args>>() && ...) && sizeof(Stored) <= SLOT_BYTES) {
+      ::new (slot->storage) Stored{t_format.get(), {t_args...}};
+      slot->format = &FormatDeferred<std::decay_t<Args>...>;
+    }
+    else {
+      // the arguments may not outlive this call, format them now
+      const auto result = std::format_to_n(slot->storage, SLOT_BYTES, t_format, std::forward<Args>(t_args)...);
+      slot->length      = std::min(static_cast<size_t>(result.size), SLOT_BYTES);
+      slot->format      = nullptr;
+    }
+
+    Publish(*slot);
+  }
+}
+
+template <Logger::LogSeverity Severity>
+bool Logger::IsEnabled() const noexcept {
+  if constexpr (Severity > COMPILED_SEVERITY) {
+    return false;
+  }
+  else {
+    return Severity <= currentLogLevel || (m_logToDisk && Severity <= currentDiskLogLevel);
+  }
+}
+
+template <typename... Args>
+void Logger::FormatDeferred(const void* t_storage, std::string& t_out) {
+  const auto& deferred = *std::launder(static_cast<const Deferred<Args...>*>(t_storage));
+  std::apply(
+    [&] (const Args&... t_args)
+    {
+      std::vformat_to(std::back_inserter(t_out), deferred.format, std::make_format_args(t_args...));
+    },
+    deferred.args);
+}
\ No newline at end of file
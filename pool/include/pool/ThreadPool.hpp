@@ -1,12 +1,19 @@
 #pragma once
 #include "Logger/Logger.hpp"
 
+#include "CancellationToken.hpp"
+#include "InplaceTask.hpp"
 #include "Time/Timer.hpp"
+#include "WorkStealingDeque.hpp"
 
+#include <array>
+#include <condition_variable>
+#include <coroutine>
 #include <future>
+#include <mutex>
+#include <optional>
 #include <queue>
-
-// TODO: shutdown function?
+#include <variant>
 
 class Logger;
 
@@ -16,24 +23,108 @@ namespace obj
   {
     QueuedTask() = delete;
 
-    QueuedTask(std::packaged_task<void()> t_task, const unsigned int t_taskNumber) : task(std::move(t_task)), timer(Timer()),
-                                                                                     taskNumber(t_taskNumber) {}
+    QueuedTask(InplaceTask t_task, const unsigned int t_taskNumber) : task(std::move(t_task)), timer(Timer()),
+                                                                      taskNumber(t_taskNumber) {}
 
     [[nodiscard]] static std::string ThreadIdString(const std::thread::id& t_id);
 
-    std::packaged_task<void()> task;
-    Timer                      timer;
-    unsigned int               taskNumber;
-    std::thread::id            threadId;
+    InplaceTask     task;
+    Timer           timer;
+    unsigned int    taskNumber;
+    std::thread::id threadId;
   };
 }
 
 class ThreadPool
 {
 public:
+  enum class Scheduling : uint8_t
+  {
+    SharedQueue, // one queue behind a single lock, threads are spawned on demand
+    WorkStealing // every worker owns a lock-free deque, tasks spawned by a worker stay local and idle workers steal
+  };
+
+  // order in which queued tasks start, a steady stream of High tasks keeps Low ones waiting
+  enum class Priority : uint8_t
+  {
+    Low,
+    Normal,
+    High
+  };
+
+  enum class ShutdownMode : uint8_t
+  {
+    Drain, // every queued task still runs before the workers exit
+    Cancel // queued tasks that haven't started fail with OperationCancelled
+  };
+
+  // where workers run, pinning is best effort and skipped on platforms that don't support it
+  enum class Affinity : uint8_t
+  {
+    None,     // the OS places and moves workers freely
+    PinCores, // worker i is pinned to logical core i, numbered node by node
+    NumaNodes // workers are dealt out round-robin across NUMA nodes and may move between the cores of their node
+  };
+
+  struct PoolOptions
+  {
+    Scheduling scheduling  = Scheduling::SharedQueue;
+    Affinity   affinity    = Affinity::None;
+    bool       preSpawnAll = false; // start every worker up front, never spawning on the Enqueue() path
+  };
+
+  struct TaskOptions
+  {
+    Priority          priority = Priority::Normal;
+    CancellationToken cancel{}; // checked right before the task starts, a cancelled task fails with OperationCancelled
+  };
+
+  // co_await-ed to continue a coroutine on one of the pool's workers, see Schedule()
+  class ScheduleAwaiter
+  {
+  public:
+    ScheduleAwaiter(ThreadPool& t_pool, const Priority t_priority) : m_pool(&t_pool), m_priority(t_priority) {}
+
+    [[nodiscard]] bool await_ready() const noexcept { return s_currentPool == m_pool; }
+    bool               await_suspend(std::coroutine_handle<> t_handle) const;
+    void               await_resume() const noexcept {}
+
+  private:
+    ThreadPool* m_pool;
+    Priority    m_priority;
+  };
+
+  // co_await-ed to run a callable on one of the pool's workers and continue there with its result, see RunAsync()
+  template <typename F>
+  class AsyncAwaiter
+  {
+  public:
+    using Result = std::invoke_result_t<F>;
+
+    AsyncAwaiter(ThreadPool& t_pool, F t_f, TaskOptions t_options) : m_pool(&t_pool), m_f(std::move(t_f)),
+                                                                     m_options(std::move(t_options)) {}
+
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+    bool               await_suspend(std::coroutine_handle<> t_handle);
+    Result             await_resume();
+
+  private:
+    using Value = std::conditional_t<std::is_void_v<Result>, std::monostate, Result>;
+
+    void Run() noexcept;
+
+    ThreadPool*             m_pool;
+    F                       m_f;
+    TaskOptions             m_options;
+    std::coroutine_handle<> m_handle;
+    std::optional<Value>    m_value;
+    std::exception_ptr      m_error;
+  };
+
   //-------------------------------------------------------------------------------------------------------------------
   // Constructors/operators
-  explicit ThreadPool(size_t t_threadCount);
+  explicit ThreadPool(size_t t_threadCount, Scheduling t_scheduling = Scheduling::SharedQueue);
+  ThreadPool(size_t t_threadCount, const PoolOptions& t_options);
   ~ThreadPool();
   ThreadPool& operator=(ThreadPool& t_other)  = delete;
   ThreadPool& operator=(ThreadPool&& t_other) = delete;
@@ -47,26 +138,100 @@ public:
   template <typename F, typename... Args>
   std::future<std::invoke_result_t<F, Args...>> Enqueue(F&& t_f, Args&&... t_args);
 
+  template <typename F, typename... Args>
+  std::future<std::invoke_result_t<F, Args...>> EnqueueWith(TaskOptions t_options, F&& t_f, Args&&... t_args);
+
+  template <typename F>
+  bool Post(F&& t_f, Priority t_priority = Priority::Normal);
+
+  [[nodiscard]] ScheduleAwaiter Schedule(Priority t_priority = Priority::Normal);
+
+  template <typename F>
+  [[nodiscard]] AsyncAwaiter<std::decay_t<F>> RunAsync(F&& t_f);
+
+  template <typename F>
+  [[nodiscard]] AsyncAwaiter<std::decay_t<F>> RunAsyncWith(TaskOptions t_options, F&& t_f);
+
+  template <typename F>
+  void ParallelFor(size_t t_count, F&& t_f);
+
+  void Drain();
+  void Shutdown(ShutdownMode t_mode = ShutdownMode::Drain);
+
   [[nodiscard]] constexpr size_t ThreadCount() const { return m_workerPool.size(); }
+  [[nodiscard]] constexpr size_t MaxThreadCount() const { return m_maxThreadsUser; }
+  [[nodiscard]] constexpr Scheduling GetScheduling() const { return m_scheduling; }
+  [[nodiscard]] constexpr Affinity   GetAffinity() const { return m_affinity; }
 
 private:
   /*!
    * @brief A worker intended to be dispatched on a thread that will automatically pick up tasks that are inserted into the queue and will wait if the queue is empty.
    */
-  void WorkerLoop();
+  void WorkerLoop(size_t t_index);
+
+  /*!
+   * @brief Scheduling::WorkStealing worker, runs its own deque first, then the shared queue, then steals from random
+   * victims, and only sleeps once no task is pending anywhere in the pool
+   * @param t_index Index of the deque owned by this worker
+   */
+  void StealingWorkerLoop(size_t t_index);
+
+  static constexpr size_t PRIORITY_COUNT = 3;
+
+  // deque entry of a worker's task, reused by the worker that allocated it so pushing a task doesn't allocate
+  struct TaskNode
+  {
+    std::optional<obj::QueuedTask> task;
+    TaskNode*                      next  = nullptr; // in the owner's free list or return stack
+    size_t                         owner = 0;       // index of the worker that allocated the node
+  };
+
+  // every node one worker allocated, only its return stack is touched by other threads
+  struct NodePool
+  {
+    std::vector<std::unique_ptr<TaskNode>> nodes;              // owner only
+    TaskNode*                              free     = nullptr; // owner only
+    alignas(64) std::atomic<TaskNode*>     returned = nullptr; // nodes of stolen tasks, pushed by the thieves
+  };
+
+  TaskNode*       AcquireNode(size_t t_index, obj::QueuedTask t_task);
+  obj::QueuedTask ReleaseNode(size_t t_index, TaskNode* t_node);
+
+  bool                                         Dispatch(InplaceTask t_task, Priority t_priority);
+  bool                                         Submit(obj::QueuedTask t_task, Priority t_priority);
+  [[nodiscard]] std::optional<obj::QueuedTask> FindTask(size_t t_index);
+  [[nodiscard]] std::optional<obj::QueuedTask> PopQueued();
+  [[nodiscard]] bool                           QueueEmpty() const;
+  void                                         RunTask(obj::QueuedTask& t_task);
+  void                                         PlaceWorker(size_t t_index) const;
 
   std::mutex                  m_mutex; // Mutex for inserting tasks
   std::condition_variable     m_cv; // Cv to wait threads
-  std::queue<obj::QueuedTask> m_queue; // Task queue
+  std::condition_variable     m_drainCv; // Cv to wait Drain() callers
+  // Task queue per priority, only takes tasks from non-worker threads when work stealing
+  std::array<std::queue<obj::QueuedTask>, PRIORITY_COUNT> m_queues;
+  std::vector<std::unique_ptr<WorkStealingDeque<TaskNode>>> m_deques; // One per worker when work stealing
+  std::vector<std::unique_ptr<NodePool>>                    m_nodePools; // Deque nodes of every worker, same indices
   std::vector<std::jthread>   m_workerPool; // Container for dispatched worker threads
+  std::vector<size_t>         m_workerNodes; // NUMA node of every worker index, empty with Affinity::None
   size_t                      m_maxThreadsUser    = 0; // User-defined maximum number of dispatched threads
   size_t                      m_maxThreadsHw      = std::thread::hardware_concurrency(); // Hardware-defined maximum
   size_t                      m_maxPreSpawnThread = 0; // Calculated amount of threads to dispatch pre-emptively
   size_t                      m_idleThreads       = 0; // Amount of dispatched threads that are currently idle
-  bool                        m_shutdown          = false;
+  std::atomic<bool>           m_shutdown          = false;
+  std::atomic<bool>           m_cancelQueued      = false; // queued tasks fail instead of running, ShutdownMode::Cancel
   bool                        m_poolActive        = false;
   std::atomic<unsigned int>   m_totalTasks        = 0; // Global task counter
+  std::atomic<size_t>         m_pendingTasks      = 0; // Tasks queued anywhere but not yet picked up, work stealing only
+  std::atomic<size_t>         m_queuedTasks       = 0; // Tasks in m_queues, lets stealing workers skip the lock
+  std::atomic<size_t>         m_activeTasks       = 0; // Tasks queued or running on a worker, what Drain() waits for
+  std::atomic<size_t>         m_sleepingThreads   = 0; // Stealing workers blocked on m_cv
+  Scheduling                  m_scheduling        = Scheduling::SharedQueue;
+  Affinity                    m_affinity          = Affinity::None;
   Logger*                     m_logger            = &Logger::Instance();
+
+  inline static thread_local ThreadPool* s_currentPool = nullptr; // Pool owning the calling worker thread
+  inline static thread_local size_t      s_workerIndex = 0;       // Deque index of the calling worker thread
 };
 
 #include "ThreadPool.inl"
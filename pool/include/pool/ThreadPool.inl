@@ -7,13 +7,30 @@ void ThreadPool::AddThread(F&& t_f) {
 
 template <typename F, typename... Args>
 std::future<std::invoke_result_t<F, Args...>> ThreadPool::Enqueue(F&& t_f, Args&&... t_args) {
+  return EnqueueWith(TaskOptions{}, std::forward<F>(t_f), std::forward<Args>(t_args)...);
+}
+
+/*!
+ * @brief Enqueues t_f(t_args...) like Enqueue(), started in t_options.priority order and skipped if
+ * t_options.cancel was cancelled by the time a worker picks it up
+ * @param t_options Priority and cancellation of the task
+ * @param t_f Callable to run
+ * @param t_args Arguments moved into the task
+ * @return Future of the result, rethrows OperationCancelled if the task never started
+ */
+template <typename F, typename... Args>
+std::future<std::invoke_result_t<F, Args...>> ThreadPool::EnqueueWith(TaskOptions t_options, F&& t_f, Args&&... t_args) {
   // the return type of the function being passed
   using ReturnT = std::invoke_result_t<F, Args...>;
   // Wrap the function and its arguments into a packaged_task
 
   auto task = std::packaged_task<ReturnT()>(
-    [f = std::forward<F>(t_f), ...args = std::forward<Args>(t_args)]() mutable
+    [this, cancel = std::move(t_options.cancel), f = std::forward<F>(t_f), ...args = std::forward<Args>(t_args)]() mutable
     {
+      // a stale task only costs the pop, not the work
+      if (m_cancelQueued || cancel.IsCancelled()) {
+        throw OperationCancelled("Task was cancelled before it started");
+      }
       return std::invoke(std::move(f), std::move(args)...);
     });
 
@@ -32,18 +49,159 @@ std::future<std::invoke_result_t<F, Args...>> ThreadPool::Enqueue(F&& t_f, Args&
     return fut;
   }
 
+  // the packaged_task is the only allocation, the void() wrapper around it fits into the queued task itself
+  Dispatch([t = std::move(task)]() mutable { t(); }, t_options.priority);
+  return fut;
+}
+
+/*!
+ * @brief Queues t_f() without a future, the cheapest way onto a worker: a callable of up to InplaceTask::INLINE_BYTES
+ * is queued without allocating. Unlike EnqueueWith() it runs even when ShutdownMode::Cancel skips the tasks around it,
+ * so whatever t_f resumes or completes is never left hanging
+ * @param t_f Callable to run on a worker, it must not throw
+ * @param t_priority Order in which it starts
+ * @return False without running t_f if the pool has no workers or was shut down
+ */
+template <typename F>
+bool ThreadPool::Post(F&& t_f, const Priority t_priority) {
+  if (m_shutdown || m_maxThreadsUser == 0) {
+    return false;
+  }
+  return Dispatch(std::forward<F>(t_f), t_priority);
+}
+
+template <typename F>
+ThreadPool::AsyncAwaiter<std::decay_t<F>> ThreadPool::RunAsync(F&& t_f) {
+  return RunAsyncWith(TaskOptions{}, std::forward<F>(t_f));
+}
+
+/*!
+ * @brief Awaitable running t_f() on a worker like EnqueueWith(), for coroutines: co_await suspends the caller, which
+ * resumes on the worker that ran t_f with its result, no future or shared state involved
+ * \n t_f lives in the awaiter, only a pointer to it is queued. A pool without workers runs t_f on the awaiting thread
+ * @param t_options Priority and cancellation of the call
+ * @param t_f Callable to run, moved into the awaiter
+ * @return Awaiter yielding t_f's result, rethrows what t_f threw or OperationCancelled if it never started
+ */
+template <typename F>
+ThreadPool::AsyncAwaiter<std::decay_t<F>> ThreadPool::RunAsyncWith(TaskOptions t_options, F&& t_f) {
+  return AsyncAwaiter<std::decay_t<F>>(*this, std::forward<F>(t_f), std::move(t_options));
+}
+
+template <typename F>
+bool ThreadPool::AsyncAwaiter<F>::await_suspend(const std::coroutine_handle<> t_handle) {
+  m_handle = t_handle;
+
+  // the awaiter lives in the suspended frame, which the resume may destroy, so nothing touches it afterwards
+  if (m_pool->Post([this] { Run(); m_handle.resume(); }, m_options.priority)) {
+    return true;
+  }
+
+  if (m_pool->m_shutdown) {
+    m_error = std::make_exception_ptr(OperationCancelled("Thread pool was shut down"));
+  }
+  else {
+    Run();
+  }
+  return false;
+}
+
+template <typename F>
+typename ThreadPool::AsyncAwaiter<F>::Result ThreadPool::AsyncAwaiter<F>::await_resume() {
+  if (m_error) {
+    std::rethrow_exception(m_error);
+  }
+  if constexpr (!std::is_void_v<Result>) {
+    return std::move(*m_value);
+  }
+}
+
+template <typename F>
+void ThreadPool::AsyncAwaiter<F>::Run() noexcept {
+  try {
+    if (m_pool->m_cancelQueued || m_options.cancel.IsCancelled()) {
+      throw OperationCancelled("Task was cancelled before it started");
+    }
+
+    if constexpr (std::is_void_v<Result>) {
+      std::invoke(std::move(m_f));
+      m_value.emplace();
+    }
+    else {
+      m_value.emplace(std::invoke(std::move(m_f)));
+    }
+  }
+  catch (...) {
+    m_error = std::current_exception();
+  }
+}
+
+/*!
+ * @brief Calls t_f(i) for every i in [0, t_count) spread across the pool, and returns once every call has finished.
+ * \n The calling thread works through the range as well, so this is safe to call from inside a running pool task:
+ * it only ever waits on calls that another thread is already executing, never on queued helpers that haven't started
+ * @param t_count Number of iterations
+ * @param t_f Callable taking the iteration index, the first exception it throws is rethrown on the calling thread
+ */
+template <typename F>
+void ThreadPool::ParallelFor(const size_t t_count, F&& t_f) {
+  if (t_count == 0) {
+    return;
+  }
+
+  // run on calling thread only
+  if (m_maxThreadsUser == 0 || m_shutdown || t_count == 1) {
+    for (size_t i = 0; i < t_count; ++i) {
+      t_f(i);
+    }
+    return;
+  }
+
+  // helpers can be picked up after this call returned, so everything they share lives on the heap
+  struct SharedState
   {
-    std::lock_guard lock(m_mutex);
-    unsigned int    taskNumber = ++m_totalTasks;
-    // lambda wrap to a void() task to insert into queue
-    m_queue.emplace(std::packaged_task<void()>([t = std::move(task)]() mutable { t(); }), taskNumber);
-
-    // If all threads are busy, and we haven't reached maxThreads, spawn a new one
-    if (m_idleThreads == 0 && ThreadCount() < m_maxThreadsUser) {
-      AddThread([this] { WorkerLoop(); });
+    std::atomic<size_t>     next = 0; // next unclaimed iteration
+    std::atomic<size_t>     done = 0; // finished iterations
+    std::mutex              mutex;
+    std::condition_variable cv;
+    std::exception_ptr      error;
+  };
+
+  auto shared = std::make_shared<SharedState>();
+
+  // t_f is only dereferenced while an iteration is claimed, which can't happen after the caller stopped waiting
+  auto work = [shared, t_count, f = &t_f]
+  {
+    size_t i;
+    while ((i = shared->next.fetch_add(1)) < t_count) {
+      try {
+        (*f)(i);
+      }
+      catch (...) {
+        std::lock_guard lock(shared->mutex);
+        if (!shared->error) {
+          shared->error = std::current_exception();
+        }
+      }
+
+      if (shared->done.fetch_add(1) + 1 == t_count) {
+        std::lock_guard lock(shared->mutex);
+        shared->cv.notify_all();
+      }
     }
+  };
+
+  const size_t helpers = std::min(t_count - 1, m_maxThreadsUser);
+  for (size_t i = 0; i < helpers; ++i) {
+    Enqueue(work);
   }
 
-  m_cv.notify_one();
-  return fut;
-}
+  work();
+
+  std::unique_lock lock(shared->mutex);
+  shared->cv.wait(lock, [&] { return shared->done.load() == t_count; });
+
+  if (shared->error) {
+    std::rethrow_exception(shared->error);
+  }
+}
\ No newline at end of file
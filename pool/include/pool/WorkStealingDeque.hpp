@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*!
+ * @brief Lock-free Chase-Lev deque of pointers. The owning worker pushes and pops at the bottom, any other thread
+ * may steal from the top.
+ * \n Grown rings are kept alive until the deque is destroyed, so a thief still reading an old ring never sees freed memory
+ */
+template <typename T>
+class WorkStealingDeque
+{
+public:
+  //-------------------------------------------------------------------------------------------------------------------
+  // Constructors/operators
+  explicit WorkStealingDeque(std::int64_t t_capacity = 256);
+  ~WorkStealingDeque()                                      = default;
+  WorkStealingDeque& operator=(WorkStealingDeque& t_other)  = delete;
+  WorkStealingDeque& operator=(WorkStealingDeque&& t_other) = delete;
+  WorkStealingDeque(WorkStealingDeque& t_other)             = delete;
+  WorkStealingDeque(WorkStealingDeque&& t_other)            = delete;
+  //-------------------------------------------------------------------------------------------------------------------
+
+  // owner thread only
+  void Push(T* t_item);
+  T*   Pop();
+
+  // any thread, returns nullptr when empty or when it lost a race for the last item
+  T* Steal();
+
+  [[nodiscard]] bool Empty() const noexcept {
+    return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Ring
+  {
+    explicit Ring(const std::int64_t t_capacity) : capacity(t_capacity), mask(t_capacity - 1),
+                                                   slots(std::make_unique<std::atomic<T*>[]>(t_capacity)) {}
+
+    T* Get(const std::int64_t t_i) const noexcept { return slots[t_i & mask].load(std::memory_order_relaxed); }
+    void Put(const std::int64_t t_i, T* t_item) noexcept { slots[t_i & mask].store(t_item, std::memory_order_relaxed); }
+
+    std::int64_t                       capacity;
+    std::int64_t                       mask;
+    std::unique_ptr<std::atomic<T*>[]> slots;
+  };
+
+  Ring* Grow(Ring* t_ring, std::int64_t t_bottom, std::int64_t t_top);
+
+  alignas(64) std::atomic<std::int64_t> m_top    = 0; // next item to steal
+  alignas(64) std::atomic<std::int64_t> m_bottom = 0; // next free slot of the owner
+  std::atomic<Ring*>                    m_ring;
+  std::vector<std::unique_ptr<Ring>>    m_rings; // current ring and every ring it grew out of, owner only
+};
+
+#include "WorkStealingDeque.inl"
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+/*!
+ * @param t_capacity Initial amount of slots, must be a power of two. The deque doubles whenever it runs full
+ */
+template <typename T>
+WorkStealingDeque<T>::WorkStealingDeque(const std::int64_t t_capacity) {
+  m_rings.push_back(std::make_unique<Ring>(t_capacity));
+  m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+}
+
+template <typename T>
+void WorkStealingDeque<T>::Push(T* t_item) {
+  const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+  const std::int64_t top    = m_top.load(std::memory_order_acquire);
+  Ring*              ring   = m_ring.load(std::memory_order_relaxed);
+
+  if (bottom - top > ring->capacity - 1) {
+    ring = Grow(ring, bottom, top);
+  }
+
+  ring->Put(bottom, t_item);
+  // publish the item before thieves can see the new bottom, pairs with the acquire load in Steal()
+  m_bottom.store(bottom + 1, std::memory_order_release);
+}
+
+template <typename T>
+T* WorkStealingDeque<T>::Pop() {
+  const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+  Ring*              ring   = m_ring.load(std::memory_order_relaxed);
+  m_bottom.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::int64_t top = m_top.load(std::memory_order_relaxed);
+
+  // empty, restore bottom
+  if (top > bottom) {
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  T* item = ring->Get(bottom);
+
+  // last item, race thieves for it
+  if (top == bottom) {
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      item = nullptr;
+    }
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  return item;
+}
+
+template <typename T>
+T* WorkStealingDeque<T>::Steal() {
+  std::int64_t top = m_top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+  if (top >= bottom) {
+    return nullptr;
+  }
+
+  const Ring* ring = m_ring.load(std::memory_order_acquire);
+  T*          item = ring->Get(top);
+
+  if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+    return nullptr;
+  }
+
+  return item;
+}
+
+template <typename T>
+typename WorkStealingDeque<T>::Ring* WorkStealingDeque<T>::Grow(Ring* t_ring, const std::int64_t t_bottom,
+                                                                const std::int64_t t_top) {
+  auto grown = std::make_unique<Ring>(t_ring->capacity * 2);
+  for (std::int64_t i = t_top; i < t_bottom; ++i) {
+    grown->Put(i, t_ring->Get(i));
+  }
+
+  Ring* ring = grown.get();
+  m_rings.push_back(std::move(grown));
+  m_ring.store(ring, std::memory_order_release);
+  return ring;
+}
\ No newline at end of file
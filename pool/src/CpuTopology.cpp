@@ -0,0 +1,185 @@
+#include "pool/CpuTopology.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+  // cores are numbered group * GROUP_BITS + bit, which the group affinity calls take apart again
+  constexpr unsigned int GROUP_BITS = sizeof(KAFFINITY) * 8;
+
+  bool SetGroupAffinity(const std::vector<unsigned int>& t_cores) {
+    GROUP_AFFINITY affinity{};
+    affinity.Group = static_cast<WORD>(t_cores.front() / GROUP_BITS);
+
+    for (const unsigned int core : t_cores) {
+      // a thread can only be restricted to cores of one processor group
+      if (core / GROUP_BITS == affinity.Group) {
+        affinity.Mask |= KAFFINITY(1) << (core % GROUP_BITS);
+      }
+    }
+    return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+  }
+#elif defined(__linux__)
+  bool SetAffinity(const std::vector<unsigned int>& t_cores) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const unsigned int core : t_cores) {
+      if (core < CPU_SETSIZE) {
+        CPU_SET(core, &set);
+      }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+  }
+
+  /*!
+   * @brief Parses a sysfs cpu list like "0-3,8-11"
+   */
+  std::vector<unsigned int> ParseCpuList(const std::string& t_list) {
+    std::vector<unsigned int> cores;
+
+    const char* ptr = t_list.data();
+    const char* end = ptr + t_list.size();
+
+    while (ptr < end) {
+      unsigned int           first  = 0;
+      std::from_chars_result result = std::from_chars(ptr, end, first);
+      if (result.ec != std::errc()) {
+        break;
+      }
+
+      unsigned int last = first;
+      if (result.ptr < end && *result.ptr == '-') {
+        result = std::from_chars(result.ptr + 1, end, last);
+        if (result.ec != std::errc()) {
+          break;
+        }
+      }
+
+      for (unsigned int core = first; core <= last; ++core) {
+        cores.push_back(core);
+      }
+
+      ptr = result.ptr < end && *result.ptr == ',' ? result.ptr + 1 : end;
+    }
+
+    return cores;
+  }
+#endif
+}
+
+const CpuTopology& CpuTopology::Get() {
+  static const CpuTopology topology;
+  return topology;
+}
+
+CpuTopology::CpuTopology() {
+#ifdef _WIN32
+  ULONG highestNode = 0;
+  if (GetNumaHighestNodeNumber(&highestNode)) {
+    for (USHORT node = 0; node <= highestNode; ++node) {
+      GROUP_AFFINITY affinity{};
+      if (!GetNumaNodeProcessorMaskEx(node, &affinity)) {
+        continue;
+      }
+
+      std::vector<unsigned int> cores;
+      for (unsigned int bit = 0; bit < GROUP_BITS; ++bit) {
+        if (affinity.Mask & (KAFFINITY(1) << bit)) {
+          cores.push_back(affinity.Group * GROUP_BITS + bit);
+        }
+      }
+      if (!cores.empty()) {
+        m_nodes.push_back(std::move(cores));
+      }
+    }
+  }
+#elif defined(__linux__)
+  // cores outside of the process' mask, e.g. in a container, would only make pinning fail
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  const bool haveMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+  auto isAllowed = [&] (const unsigned int t_core)
+  {
+    return !haveMask || (t_core < CPU_SETSIZE && CPU_ISSET(t_core, &allowed));
+  };
+
+  // node ids can have gaps, stop after a run of missing ones
+  for (unsigned int node = 0, missing = 0; missing < 64; ++node) {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (!file.is_open()) {
+      ++missing;
+      continue;
+    }
+    missing = 0;
+
+    std::string list;
+    std::getline(file, list);
+
+    std::vector<unsigned int> cores = ParseCpuList(list);
+    std::erase_if(cores, [&] (const unsigned int t_core) { return !isAllowed(t_core); });
+    if (!cores.empty()) {
+      m_nodes.push_back(std::move(cores));
+    }
+  }
+
+  if (m_nodes.empty() && haveMask) {
+    std::vector<unsigned int> cores;
+    for (unsigned int core = 0; core < CPU_SETSIZE; ++core) {
+      if (CPU_ISSET(core, &allowed)) {
+        cores.push_back(core);
+      }
+    }
+    if (!cores.empty()) {
+      m_nodes.push_back(std::move(cores));
+    }
+  }
+#endif
+
+  // no topology available, one node of consecutive cores
+  if (m_nodes.empty()) {
+    m_nodes.emplace_back();
+    for (unsigned int core = 0; core < std::max(std::thread::hardware_concurrency(), 1u); ++core) {
+      m_nodes.back().push_back(core);
+    }
+  }
+
+  for (const auto& cores : m_nodes) {
+    m_cores.insert(m_cores.end(), cores.begin(), cores.end());
+  }
+}
+
+bool CpuTopology::PinToCore(const unsigned int t_core) {
+#ifdef _WIN32
+  return SetGroupAffinity({t_core});
+#elif defined(__linux__)
+  return SetAffinity({t_core});
+#else
+  (void)t_core;
+  return false;
+#endif
+}
+
+bool CpuTopology::PinToNode(const size_t t_node) const {
+#ifdef _WIN32
+  return SetGroupAffinity(m_nodes[t_node]);
+#elif defined(__linux__)
+  return SetAffinity(m_nodes[t_node]);
+#else
+  (void)t_node;
+  return false;
+#endif
+}
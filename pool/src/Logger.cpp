@@ -2,8 +2,51 @@
 
 #include "pool/ThreadPool.hpp" // TODO: remove this
 
+#include <array>
 #include <iostream>
 
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+  constexpr std::array<std::string_view, 4> SEVERITY_NAMES = {"Error", "Warning", "Info", "Debug"};
+
+#ifdef _WIN32
+  constexpr WORD GetSeverityColor(const Logger::LogSeverity t_logLevel) {
+    switch (t_logLevel) {
+      case Logger::Debug: return 8;
+      case Logger::Info: return 7;
+      case Logger::Warning: return 6;
+      case Logger::Error: return 4;
+      default: return 7;
+    }
+  }
+#else
+  constexpr std::string_view GetSeverityColor(const Logger::LogSeverity t_logLevel) {
+    switch (t_logLevel) {
+      case Logger::Debug: return "\x1b[90m";
+      case Logger::Info: return "\x1b[37m";
+      case Logger::Warning: return "\x1b[33m";
+      case Logger::Error: return "\x1b[31m";
+      default: return "\x1b[0m";
+    }
+  }
+#endif
+}
+
+Logger::Logger() : m_slots(std::make_unique<Slot[]>(RING_CAPACITY)) {
+  static_assert((RING_CAPACITY & (RING_CAPACITY - 1)) == 0, "ring capacity has to be a power of two");
+
+  for (size_t i = 0; i < RING_CAPACITY; ++i) {
+    m_slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
 Logger::~Logger() {
   Shutdown();
   m_diskFile.flush();
@@ -27,105 +70,204 @@ void Logger::DispatchWorkerThread() {
     }
   }
 
+#ifdef _WIN32
+  m_colorize = GetFileType(GetStdHandle(STD_OUTPUT_HANDLE)) == FILE_TYPE_CHAR;
+#else
+  m_colorize = isatty(STDOUT_FILENO) != 0;
+#endif
+
   m_thread = std::jthread([this] { WorkerThread(); });
 }
 
 /*!
- * @brief Signals all threads to wake up and finish printing any outstanding messages.
+ * @brief Signals the worker to finish printing any outstanding messages and waits for it.
  */
 void Logger::Shutdown() {
-  Log<Debug>(std::format("Logger worker closed on thread: {}", obj::QueuedTask::ThreadIdString(m_workerThreadId)));
-  {
-    std::lock_guard lock(m_waitLogMutex);
-    m_shutdown = true;
+  if (!m_thread.joinable()) {
+    return;
   }
 
-  m_cv.notify_all(); // wake worker
+  Log<Debug>("Logger worker closed on thread: {}", obj::QueuedTask::ThreadIdString(m_workerThreadId));
 
-  if (m_thread.joinable()) {
-    m_thread.join(); // wait until worker finishes flushing
-  }
+  m_shutdown.store(true);
+  m_published.fetch_add(1);
+  m_published.notify_one(); // wake worker
+
+  m_thread.join(); // wait until worker finishes flushing
 }
 
 bool Logger::IsLogLevelEnabled(const LogSeverity t_logLevel, const bool t_disk) const {
   return t_disk ? t_logLevel <= currentDiskLogLevel : t_logLevel <= currentLogLevel;
 }
 
-constexpr WORD Logger::GetSeverityColor(const LogSeverity t_logLevel) {
-  switch (t_logLevel) {
-    case Debug: return 8;
-    case Info: return 7;
-    case Warning: return 6;
-    case Error: return 4;
-    default: return 7;
+/*!
+ * @brief Reserves the next free slot of the ring for one message, lock-free for any number of producers
+ * @return The slot to fill and Publish(), or nullptr if the ring is full
+ */
+Logger::Slot* Logger::Claim() noexcept {
+  size_t position = m_head.load(std::memory_order_relaxed);
+
+  while (true) {
+    Slot&        slot     = m_slots[position & (RING_CAPACITY - 1)];
+    const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    const auto   distance = static_cast<std::ptrdiff_t>(sequence - position);
+
+    if (distance == 0) {
+      if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        return &slot;
+      }
+    }
+    else if (distance < 0) {
+      // the worker hasn't printed this slot from the previous lap yet
+      return nullptr;
+    }
+    else {
+      position = m_head.load(std::memory_order_relaxed);
+    }
   }
 }
 
 /*!
- * @brief Inserts a log message into a queue in a thread-safe manner
- * @param t_entry The log entry
+ * @brief Hands a filled slot to the worker, and wakes it only if it is idle
+ * @param t_slot Slot returned by Claim()
  */
-void Logger::ThreadSafeLogMessage(LogEntry t_entry) {
-  {
-    std::lock_guard lock(m_waitLogMutex);
-    m_logQueue.emplace(std::move(t_entry));
-  }
+void Logger::Publish(Slot& t_slot) noexcept {
+  t_slot.sequence.store(t_slot.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
 
-  // notify thread
-  m_cv.notify_one();
+  // the worker flags itself before its last check, so one of the two always sees the other
+  m_published.fetch_add(1);
+  if (m_sleeping.load()) {
+    m_published.notify_one();
+  }
 }
 
 /*!
- * @brief A worker intended to be dispatched to a separate thread that will automatically detect messages that are inserted into the queue and will wait if the queue is empty.
+ * @brief A worker intended to be dispatched to a separate thread that prints every published message in batches and waits while the ring is empty.
  */
 void Logger::WorkerThread() {
   m_workerThreadId = std::this_thread::get_id();
-  Log<Debug>(std::format("Logger worker dispatched to thread: {}", obj::QueuedTask::ThreadIdString(m_workerThreadId)));
+  Log<Debug>("Logger worker dispatched to thread: {}", obj::QueuedTask::ThreadIdString(m_workerThreadId));
+
   while (true) {
-    {
-      std::unique_lock lock(m_waitLogMutex);
+    const unsigned int published = m_published.load();
 
-      // wait until there's something in the log queue
-      m_cv.wait(lock, [this] { return !m_logQueue.empty() || m_shutdown; });
+    // print logs
+    if (FlushQueue()) {
+      continue;
+    }
 
-      if (m_shutdown && m_logQueue.empty()) {
-        break;
-      }
-    } // release lock
+    if (m_shutdown.load()) {
+      break;
+    }
 
-    // print logs
-    FlushQueue();
+    m_sleeping.store(true);
+    if (m_slots[m_tail & (RING_CAPACITY - 1)].sequence.load(std::memory_order_acquire) != m_tail + 1) {
+      m_published.wait(published);
+    }
+    m_sleeping.store(false);
   }
 }
 
-void Logger::FlushQueue() {
+/*!
+ * @brief Formats every published message, then writes all console text at once and all disk text at once
+ * @return Whether any message was printed
+ */
+bool Logger::FlushQueue() {
+#ifdef _WIN32
   const HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
-
-  std::queue<LogEntry> local;
-  {
-    std::lock_guard lock(m_waitLogMutex);
-    std::swap(local, m_logQueue); // grab everything fast
+  WORD         original = 7;
+  if (m_colorize) {
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    GetConsoleScreenBufferInfo(console, &info);
+    original = info.wAttributes;
   }
+#endif
+
+  m_consoleBuffer.clear();
+  m_diskBuffer.clear();
 
-  while (!local.empty()) {
-    auto [message, severity] = local.front();
+  LogSeverity color = None;
+  size_t      count = 0;
 
-    ConsoleColor color(console, GetSeverityColor(severity));
+  // the console color only changes between runs of equally severe messages
+  auto setColor = [&] (const LogSeverity t_severity)
+  {
+    if (!m_colorize || t_severity == color) {
+      return;
+    }
+#ifdef _WIN32
+    std::cout << m_consoleBuffer << std::flush;
+    m_consoleBuffer.clear();
+    SetConsoleTextAttribute(console, t_severity == None ? original : GetSeverityColor(t_severity));
+#else
+    m_consoleBuffer += GetSeverityColor(t_severity);
+#endif
+    color = t_severity;
+  };
 
+  auto print = [&] (const LogSeverity t_severity, const std::chrono::system_clock::time_point t_time)
+  {
     // if the severity is lower than our current set log level, skip it
-    if (IsLogLevelEnabled(severity)) {
-      std::cout << message << '\n';
+    if (IsLogLevelEnabled(t_severity)) {
+      setColor(t_severity);
+      m_consoleBuffer += m_message;
+      m_consoleBuffer += '\n';
     }
 
-    if (IsLogLevelEnabled(severity, true) && m_logToDisk) {
+    if (IsLogLevelEnabled(t_severity, true) && m_logToDisk) {
       auto time = std::chrono::zoned_time(
         std::chrono::current_zone(),
-        time_point_cast<std::chrono::duration<double, std::milli>>(std::chrono::system_clock::now()));
+        time_point_cast<std::chrono::duration<double, std::milli>>(t_time));
+
+      std::format_to(
+        std::back_inserter(m_diskBuffer),
+        "[{0:%F}T{0:%T}] {1}: {2}\n",
+        time,
+        SEVERITY_NAMES[t_severity],
+        m_message);
+    }
+  };
 
-      m_diskFile << std::format("[{0:%F}T{0:%T}] {1}: {2}\n", time, m_severityNames[severity], message);
-      m_diskFile.flush();
+  // bounded, so a flood of messages still gets written out in pieces
+  for (; count < RING_CAPACITY; ++count) {
+    Slot& slot = m_slots[m_tail & (RING_CAPACITY - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1) {
+      break;
     }
 
-    local.pop();
+    m_message.clear();
+    if (slot.format) {
+      slot.format(slot.storage, m_message);
+    }
+    else {
+      m_message.append(slot.storage, slot.length);
+    }
+
+    const LogSeverity severity = slot.severity;
+    const auto        time     = slot.time;
+
+    // free the slot for the lap after this one
+    slot.sequence.store(m_tail + RING_CAPACITY, std::memory_order_release);
+    ++m_tail;
+
+    print(severity, time);
   }
-}
+
+  if (const size_t dropped = m_dropped.exchange(0); dropped > 0) {
+    m_message = std::format("Logger dropped {} messages, its ring buffer was full", dropped);
+    print(Warning, std::chrono::system_clock::now());
+  }
+
+  setColor(None);
+
+  if (!m_consoleBuffer.empty()) {
+    std::cout << m_consoleBuffer << std::flush;
+  }
+
+  if (!m_diskBuffer.empty()) {
+    m_diskFile << m_diskBuffer;
+    m_diskFile.flush();
+  }
+
+  return count > 0;
+}
\ No newline at end of file
@@ -1,5 +1,12 @@
 #include "pool/ThreadPool.hpp"
 
+#include "pool/CpuTopology.hpp"
+
+#include <algorithm>
+#include <random>
+#include <ranges>
+#include <sstream>
+
 
 std::string obj::QueuedTask::ThreadIdString(const std::thread::id& t_id) {
   std::ostringstream s;
@@ -7,7 +14,17 @@ std::string obj::QueuedTask::ThreadIdString(const std::thread::id& t_id) {
   return s.str();
 }
 
-ThreadPool::ThreadPool(const size_t t_threadCount) : m_maxThreadsUser(t_threadCount) {
+ThreadPool::ThreadPool(const size_t t_threadCount, const Scheduling t_scheduling) :
+  ThreadPool(t_threadCount, PoolOptions{.scheduling = t_scheduling}) {}
+
+/*!
+ * @brief Creates the pool and starts its first workers
+ * @param t_threadCount Maximum number of workers, capped to the hardware, 0 runs every task on the calling thread
+ * @param t_options Scheduling, worker placement and whether every worker starts right away
+ */
+ThreadPool::ThreadPool(const size_t t_threadCount, const PoolOptions& t_options) : m_maxThreadsUser(t_threadCount),
+                                                                                   m_scheduling(t_options.scheduling),
+                                                                                   m_affinity(t_options.affinity) {
   // if we are not able to get the amount of max concurrent threads
   if (m_maxThreadsUser == 0 || m_maxThreadsHw == 0) {
     // only run on the main thread
@@ -17,37 +34,108 @@ ThreadPool::ThreadPool(const size_t t_threadCount) : m_maxThreadsUser(t_threadCo
   // make sure user did not request more threads than hw is capable of
   m_maxThreadsUser = std::min(m_maxThreadsUser, m_maxThreadsHw);
 
+  // decided up front, so a worker spawned on demand later lands where its index says
+  if (m_affinity != Affinity::None) {
+    const CpuTopology& topology = CpuTopology::Get();
+    const auto&        cores    = topology.Cores();
+
+    for (size_t i = 0; i < m_maxThreadsUser; ++i) {
+      if (m_affinity == Affinity::PinCores) {
+        const unsigned int core = cores[i % cores.size()];
+        for (size_t node = 0; node < topology.NodeCount(); ++node) {
+          if (std::ranges::find(topology.NodeCores(node), core) != topology.NodeCores(node).end()) {
+            m_workerNodes.push_back(node);
+          }
+        }
+      }
+      else {
+        m_workerNodes.push_back(i % topology.NodeCount());
+      }
+    }
+  }
+
+  // spawning on demand needs the shared lock on every enqueue, so a stealing pool starts all of its workers up front
+  if (m_scheduling == Scheduling::WorkStealing) {
+    m_maxPreSpawnThread = m_maxThreadsUser;
+
+    // every deque has to exist before the first worker starts stealing from its neighbours
+    for (size_t i = 0; i < m_maxThreadsUser; ++i) {
+      m_deques.push_back(std::make_unique<WorkStealingDeque<TaskNode>>());
+      m_nodePools.push_back(std::make_unique<NodePool>());
+    }
+    for (size_t i = 0; i < m_maxThreadsUser; ++i) {
+      AddThread([this, i] { StealingWorkerLoop(i); });
+    }
+
+    m_poolActive = true;
+    return;
+  }
+
   // half of physical cores, at least 1
   const size_t safeMinimumThreads = std::max<size_t>(1, m_maxThreadsUser / 2);
 
   // pre-spawn a few threads that can be picked up by new tasks before creating more
   // only spawn as many threads as the cpu has, if its a double core, only spawn one
-  m_maxPreSpawnThread = std::min(m_maxThreadsUser, safeMinimumThreads);
+  m_maxPreSpawnThread = t_options.preSpawnAll ? m_maxThreadsUser : std::min(m_maxThreadsUser, safeMinimumThreads);
 
   for (size_t i = 0; i < m_maxPreSpawnThread; ++i) {
-    AddThread([this] { WorkerLoop(); });
+    AddThread([this, i] { WorkerLoop(i); });
   }
 
   m_poolActive = true;
 }
 
 ThreadPool::~ThreadPool() {
+  Shutdown(ShutdownMode::Drain);
+}
+
+/*!
+ * @brief Blocks until every task queued so far, and every task those spawn, has finished. The pool keeps accepting
+ * tasks while and after draining, so tasks enqueued concurrently from other threads may or may not be waited for
+ * \n Must not be called from one of this pool's own tasks, which would wait for itself
+ */
+void ThreadPool::Drain() {
+  if (s_currentPool == this) {
+    throw std::runtime_error("ThreadPool::Drain called from one of its own workers");
+  }
+
+  std::unique_lock lock(m_mutex);
+  m_drainCv.wait(lock, [this] { return m_activeTasks.load() == 0; });
+}
+
+/*!
+ * @brief Stops accepting tasks and joins every worker, called by the destructor with ShutdownMode::Drain
+ * \n Enqueue() after this returns a future that never gets a value. Must not be called from one of this pool's own
+ * tasks, which would join itself
+ * @param t_mode Whether queued tasks still run or fail with OperationCancelled without starting
+ */
+void ThreadPool::Shutdown(const ShutdownMode t_mode) {
   if (!m_poolActive) {
     return;
   }
 
+  if (s_currentPool == this) {
+    throw std::runtime_error("ThreadPool::Shutdown called from one of its own workers");
+  }
+
   {
     std::lock_guard lock(m_mutex);
-    m_shutdown = true;
+    m_cancelQueued = t_mode == ShutdownMode::Cancel;
+    m_shutdown     = true;
   }
   m_cv.notify_all();
-  // No need to manually join m_workers, jthreads will join automatically
-  const std::string msg = std::format("Thread Pool closed after processing {} tasks.", static_cast<unsigned int>(m_totalTasks));
-  m_logger->Log<Logger::Debug>(msg);
+
+  // workers only exit once nothing is queued, cancelled tasks are still popped so their futures get the error
+  m_workerPool.clear();
+
+  m_logger->Log<Logger::Debug>("Thread Pool closed after processing {} tasks.", m_totalTasks.load());
   m_poolActive = false;
 }
 
-void ThreadPool::WorkerLoop() {
+void ThreadPool::WorkerLoop(const size_t t_index) {
+  s_currentPool = this;
+  PlaceWorker(t_index);
+
   while (true) {
     // we made this std::optional to avoid the overhead of default constructing a QueuedTask
     std::optional<obj::QueuedTask> optTask;
@@ -56,50 +144,321 @@ void ThreadPool::WorkerLoop() {
       std::unique_lock lock(m_mutex);
       m_idleThreads++; // thread is now idle
       // make the thread wait until shutdown, or we insert a task
-      m_cv.wait(lock, [this] { return m_shutdown || !m_queue.empty(); });
+      m_cv.wait(lock, [this] { return m_shutdown || !QueueEmpty(); });
       m_idleThreads--; // thread is waking up
 
-      if (m_shutdown && m_queue.empty()) {
+      if (m_shutdown && QueueEmpty()) {
+        break;
+      }
+
+      // move the most urgent queued task to a temp var to run
+      optTask = PopQueued();
+    }
+
+    RunTask(*optTask);
+  }
+}
+
+void ThreadPool::StealingWorkerLoop(const size_t t_index) {
+  s_currentPool = this;
+  s_workerIndex = t_index;
+  PlaceWorker(t_index);
+
+  while (true) {
+    std::optional<obj::QueuedTask> optTask = FindTask(t_index);
+
+    if (!optTask) {
+      std::unique_lock lock(m_mutex);
+      m_sleepingThreads++;
+      // pending also counts tasks sitting in other workers' deques, waking up for those is how they get stolen
+      m_cv.wait(lock, [this] { return m_shutdown || m_pendingTasks.load() > 0; });
+      m_sleepingThreads--;
+
+      // drain everything that was queued before shutting down
+      if (m_shutdown && m_pendingTasks.load() == 0) {
         break;
       }
+      continue;
+    }
+
+    RunTask(*optTask);
+  }
+}
+
+/*!
+ * @brief Awaitable that continues the awaiting coroutine on one of this pool's workers, the hook a coroutine job
+ * system schedules onto the pool with. Awaiting it on a worker of this pool is a no-op, anywhere else the coroutine is
+ * resumed through Post(), so the hop itself doesn't allocate
+ * \n A pool without workers, or one that was shut down, resumes the coroutine right away on the calling thread
+ * @param t_priority Order in which the resumption starts among queued tasks
+ */
+ThreadPool::ScheduleAwaiter ThreadPool::Schedule(const Priority t_priority) {
+  return {*this, t_priority};
+}
+
+bool ThreadPool::ScheduleAwaiter::await_suspend(const std::coroutine_handle<> t_handle) const {
+  return m_pool->Post([t_handle] { t_handle.resume(); }, m_priority);
+}
+
+/*!
+ * @brief Queues a task for a worker, spawning one if every worker is busy and the pool may still grow
+ * @param t_task Task to run
+ * @param t_priority Shared queue the task goes into
+ * @return False if Shutdown() won the race and the task was dropped
+ */
+bool ThreadPool::Dispatch(InplaceTask t_task, const Priority t_priority) {
+  // worker threads push onto their own deque without touching the shared lock
+  if (m_scheduling == Scheduling::WorkStealing) {
+    return Submit(obj::QueuedTask(std::move(t_task), ++m_totalTasks), t_priority);
+  }
 
-      // move the next element in the queue to a temp var to run
-      optTask = std::move(m_queue.front());
-      m_queue.pop();
+  {
+    std::lock_guard lock(m_mutex);
+    // Shutdown() may have won the race since the caller checked, no worker would come back for this task
+    if (m_shutdown) {
+      return false;
     }
 
-    // Measure how long this job waited in the queue
-    const auto waitTime = optTask->timer.Elapsed();
-    // assign threadId once the task gets picked up
-    optTask->threadId = std::this_thread::get_id();
+    m_queues[static_cast<size_t>(t_priority)].emplace(std::move(t_task), ++m_totalTasks);
+    m_activeTasks.fetch_add(1);
 
-    std::string log;
+    // If all threads are busy, and we haven't reached maxThreads, spawn a new one
+    if (m_idleThreads == 0 && ThreadCount() < m_maxThreadsUser) {
+      AddThread([this, index = ThreadCount()] { WorkerLoop(index); });
+    }
+  }
+
+  m_cv.notify_one();
+  return true;
+}
+
+/*!
+ * @brief Hands a task to the work-stealing scheduler. Normal tasks spawned by one of this pool's workers go onto its
+ * own deque, every other task goes through the shared queues, which are the only place priorities apply
+ * @param t_task Task to run
+ * @param t_priority Shared queue the task goes into
+ * @return False if Shutdown() won the race and the task was dropped
+ */
+bool ThreadPool::Submit(obj::QueuedTask t_task, const Priority t_priority) {
+  if (s_currentPool == this && t_priority == Priority::Normal) {
+    m_activeTasks.fetch_add(1);
+    m_deques[s_workerIndex]->Push(AcquireNode(s_workerIndex, std::move(t_task)));
+    m_pendingTasks.fetch_add(1);
+
+    // a sleeper registers itself before checking pending, so one of the two always sees the other
+    if (m_sleepingThreads.load() > 0) {
+      std::lock_guard lock(m_mutex);
+      m_cv.notify_one();
+    }
+    return true;
+  }
 
-    if (optTask->taskNumber > m_maxPreSpawnThread && optTask->taskNumber <= m_maxThreadsUser) {
-      log = std::format(
+  {
+    std::lock_guard lock(m_mutex);
+    // Shutdown() may have won the race since Enqueue() checked, no worker would come back for this task
+    if (m_shutdown) {
+      return false;
+    }
+
+    m_queues[static_cast<size_t>(t_priority)].push(std::move(t_task));
+    m_activeTasks.fetch_add(1);
+    m_queuedTasks.fetch_add(1);
+    m_pendingTasks.fetch_add(1);
+  }
+  m_cv.notify_one();
+  return true;
+}
+
+/*!
+ * @brief Takes the next task for a stealing worker: newest task of its own deque, then the shared queue, then the
+ * oldest task of another worker starting at a random victim
+ * @param t_index Index of the deque owned by the calling worker
+ * @return The task, or std::nullopt if nothing could be taken right now
+ */
+std::optional<obj::QueuedTask> ThreadPool::FindTask(const size_t t_index) {
+  auto take = [this, t_index] (TaskNode* t_node)
+  {
+    m_pendingTasks.fetch_sub(1);
+    return std::optional<obj::QueuedTask>(ReleaseNode(t_index, t_node));
+  };
+
+  if (TaskNode* task = m_deques[t_index]->Pop()) {
+    return take(task);
+  }
+
+  if (m_queuedTasks.load() > 0) {
+    std::lock_guard lock(m_mutex);
+    if (std::optional<obj::QueuedTask> task = PopQueued()) {
+      m_queuedTasks.fetch_sub(1);
+      m_pendingTasks.fetch_sub(1);
+      return task;
+    }
+  }
+
+  // start at a random victim so idle workers spread out instead of all hitting the same deque
+  thread_local std::minstd_rand rng(static_cast<unsigned int>(t_index + 1));
+
+  const size_t count = m_deques.size();
+  const size_t start = rng() % count;
+
+  // victims on the same node first, the memory their tasks touch is local to it, a pool without placement is one node
+  auto sameNode = [&] (const size_t t_victim)
+  {
+    return m_workerNodes.empty() || m_workerNodes[t_victim] == m_workerNodes[t_index];
+  };
+
+  for (const bool local : {true, false}) {
+    for (size_t i = 0; i < count; ++i) {
+      const size_t victim = (start + i) % count;
+      if (victim == t_index || sameNode(victim) != local) {
+        continue;
+      }
+
+      if (TaskNode* task = m_deques[victim]->Steal()) {
+        return take(task);
+      }
+    }
+  }
+
+  return std::nullopt;
+}
+
+/*!
+ * @brief Wraps a task in a node of the calling worker, a free one if any came back, a new one only while the worker
+ * has more tasks in flight than ever before
+ * @param t_index Index of the calling worker
+ * @param t_task Task to store in the node
+ * @return Node to push onto the worker's deque
+ */
+ThreadPool::TaskNode* ThreadPool::AcquireNode(const size_t t_index, obj::QueuedTask t_task) {
+  NodePool& pool = *m_nodePools[t_index];
+
+  // nodes of tasks other workers stole come back in one batch, acquire pairs with the release in ReleaseNode()
+  if (!pool.free) {
+    pool.free = pool.returned.exchange(nullptr, std::memory_order_acquire);
+  }
+
+  TaskNode* node = pool.free;
+  if (node) {
+    pool.free = node->next;
+  }
+  else {
+    node        = pool.nodes.emplace_back(std::make_unique<TaskNode>()).get();
+    node->owner = t_index;
+  }
+
+  node->task.emplace(std::move(t_task));
+  return node;
+}
+
+/*!
+ * @brief Moves the task out of a node popped or stolen by the calling worker and hands the node back to its owner
+ * @param t_index Index of the calling worker
+ * @param t_node Node taken from a deque
+ * @return The task of the node
+ */
+obj::QueuedTask ThreadPool::ReleaseNode(const size_t t_index, TaskNode* t_node) {
+  obj::QueuedTask task = std::move(*t_node->task);
+  t_node->task.reset();
+
+  if (t_node->owner == t_index) {
+    NodePool& pool = *m_nodePools[t_index];
+    t_node->next   = pool.free;
+    pool.free      = t_node;
+    return task;
+  }
+
+  // the owner only ever takes the whole stack at once, so pushing from several thieves can't hit ABA
+  std::atomic<TaskNode*>& returned = m_nodePools[t_node->owner]->returned;
+  TaskNode*               head     = returned.load(std::memory_order_relaxed);
+  do {
+    t_node->next = head;
+  } while (!returned.compare_exchange_weak(head, t_node, std::memory_order_release, std::memory_order_relaxed));
+
+  return task;
+}
+
+/*!
+ * @brief Takes the oldest task of the most urgent non-empty shared queue, m_mutex has to be held
+ * @return The task, or std::nullopt if every shared queue is empty
+ */
+std::optional<obj::QueuedTask> ThreadPool::PopQueued() {
+  for (auto& queue : m_queues | std::views::reverse) {
+    if (!queue.empty()) {
+      std::optional<obj::QueuedTask> task(std::move(queue.front()));
+      queue.pop();
+      return task;
+    }
+  }
+  return std::nullopt;
+}
+
+// m_mutex has to be held
+bool ThreadPool::QueueEmpty() const {
+  return std::ranges::all_of(m_queues, [] (const std::queue<obj::QueuedTask>& t_queue) { return t_queue.empty(); });
+}
+
+void ThreadPool::RunTask(obj::QueuedTask& t_task) {
+  // Measure how long this job waited in the queue
+  const auto waitTime = t_task.timer.Elapsed();
+  // assign threadId once the task gets picked up
+  t_task.threadId = std::this_thread::get_id();
+
+  // the thread id string allocates, skip it entirely when nobody would see the message
+  if (m_logger->IsEnabled<Logger::Debug>()) {
+    const std::string threadId = obj::QueuedTask::ThreadIdString(t_task.threadId);
+
+    if (t_task.taskNumber > m_maxPreSpawnThread && t_task.taskNumber <= m_maxThreadsUser) {
+      m_logger->Log<Logger::Debug>(
         "Task #{} waited {:L} before starting on new thread: {}",
-        optTask->taskNumber,
+        t_task.taskNumber,
         waitTime,
-        obj::QueuedTask::ThreadIdString(optTask->threadId));
+        threadId);
     }
-    else if (optTask->taskNumber > m_maxPreSpawnThread) {
-      log = std::format(
+    else if (t_task.taskNumber > m_maxPreSpawnThread) {
+      m_logger->Log<Logger::Debug>(
         "Task #{} waited {:L} in queue before starting on thread: {}",
-        optTask->taskNumber,
+        t_task.taskNumber,
         waitTime,
-        obj::QueuedTask::ThreadIdString(optTask->threadId));
+        threadId);
     }
     else {
-      log = std::format(
-        "Task #{} assigned to already running thread: {}",
-        optTask->taskNumber,
-        obj::QueuedTask::ThreadIdString(optTask->threadId));
+      m_logger->Log<Logger::Debug>("Task #{} assigned to already running thread: {}", t_task.taskNumber, threadId);
     }
+  }
 
-    if (!log.empty()) {
-      m_logger->Log<Logger::Debug>(log);
-    }
+  t_task.task(); // run job
 
-    optTask->task(); // run job
+  // the lock orders this against a Drain() caller that just found tasks still active and is about to wait
+  if (m_activeTasks.fetch_sub(1) == 1) {
+    std::lock_guard lock(m_mutex);
+    m_drainCv.notify_all();
   }
 }
+
+/*!
+ * @brief Applies the pool's Affinity to the calling worker thread
+ * @param t_index Index of the worker, the same one m_workerNodes is indexed with
+ */
+void ThreadPool::PlaceWorker(const size_t t_index) const {
+  if (m_affinity == Affinity::None) {
+    return;
+  }
+
+  const CpuTopology& topology = CpuTopology::Get();
+  const bool         placed   = m_affinity == Affinity::PinCores
+                                  ? CpuTopology::PinToCore(topology.Cores()[t_index % topology.Cores().size()])
+                                  : topology.PinToNode(m_workerNodes[t_index]);
+
+  if (!placed) {
+    m_logger->Log<Logger::Warning>("Could not set the affinity of thread pool worker #{}", t_index);
+  }
+  else if (m_logger->IsEnabled<Logger::Debug>()) {
+    m_logger->Log<Logger::Debug>(
+      "Thread pool worker #{} placed on node {} of {} on thread: {}",
+      t_index,
+      m_workerNodes[t_index],
+      topology.NodeCount(),
+      obj::QueuedTask::ThreadIdString(std::this_thread::get_id()));
+  }
+}
\ No newline at end of file
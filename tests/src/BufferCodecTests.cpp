@@ -0,0 +1,264 @@
+#include "TestCase.hpp"
+
+#include "obj/BufferCodec.hpp"
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+namespace
+{
+  using obj::BufferCodec;
+
+  // counts around VERTEX_BLOCK_SIZE, so full blocks, a partial last block and the empty buffer all get decoded
+  constexpr size_t VERTEX_COUNTS[] = {0, 1, 255, 256, 257, 1000};
+
+  template <typename T>
+  bool SameBytes(const std::vector<T>& t_a, const std::vector<T>& t_b) {
+    return t_a.size() == t_b.size() && (t_a.empty() || std::memcmp(t_a.data(), t_b.data(), t_a.size() * sizeof(T)) == 0);
+  }
+
+  // every byte random, the worst case of the codec, which then stores 8 bits per lane
+  template <typename T>
+  std::vector<T> RandomBytes(std::mt19937& t_random, const size_t t_count) {
+    std::vector<std::uint8_t> bytes(t_count * sizeof(T));
+    for (auto& byte : bytes) {
+      byte = static_cast<std::uint8_t>(t_random());
+    }
+
+    std::vector<T> values(t_count);
+    if (t_count > 0) {
+      std::memcpy(values.data(), bytes.data(), bytes.size());
+    }
+    return values;
+  }
+
+  // a jittered grid, close to what a mesh looks like after Flag::OptimizeVertexCache
+  std::vector<obj::Vertex> SmoothVertices(std::mt19937& t_random, const size_t t_count) {
+    std::uniform_real_distribution<float> jitter(-0.01f, 0.01f);
+
+    std::vector<obj::Vertex> vertices;
+    vertices.reserve(t_count);
+    for (size_t i = 0; i < t_count; ++i) {
+      const float x = static_cast<float>(i % 32) * 0.1f + jitter(t_random);
+      const float z = static_cast<float>(i / 32) * 0.1f + jitter(t_random);
+      vertices.emplace_back(glm::vec3(x, jitter(t_random), z), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(x, z));
+      vertices.back().tangent = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+    }
+    return vertices;
+  }
+
+  std::vector<unsigned int> RandomIndices(std::mt19937& t_random, const size_t t_count, const unsigned int t_max) {
+    std::uniform_int_distribution<unsigned int> index(0, t_max);
+
+    std::vector<unsigned int> indices(t_count);
+    for (auto& i : indices) {
+      i = index(t_random);
+    }
+    return indices;
+  }
+
+  // triangles of a strip walking forward through the vertices, the small deltas the varints are built for
+  std::vector<unsigned int> LocalIndices(const size_t t_triangles) {
+    std::vector<unsigned int> indices;
+    for (unsigned int i = 0; i < t_triangles; ++i) {
+      indices.insert(indices.end(), {i, i + 1, i + 2});
+    }
+    return indices;
+  }
+
+  obj::Mesh RoundTrip(const obj::Mesh& t_mesh) {
+    obj::Mesh decoded;
+    BufferCodec::DecodeMesh(BufferCodec::EncodeMesh(t_mesh), decoded);
+    return decoded;
+  }
+
+  template <typename F>
+  bool Throws(F&& t_function) {
+    try {
+      t_function();
+    }
+    catch (const std::runtime_error&) {
+      return true;
+    }
+    return false;
+  }
+}
+
+OBJ_TEST(EncodeVerticesRandomRoundTrip) {
+  std::mt19937 random(1);
+
+  for (const size_t count : VERTEX_COUNTS) {
+    const auto vertices = RandomBytes<obj::Vertex>(random, count);
+
+    std::vector<obj::Vertex> decoded;
+    BufferCodec::DecodeVertices(BufferCodec::EncodeVertices(vertices), decoded, count);
+    OBJ_CHECK(SameBytes(vertices, decoded));
+  }
+}
+
+OBJ_TEST(EncodeVerticesSmoothRoundTrip) {
+  std::mt19937 random(2);
+
+  for (const size_t count : VERTEX_COUNTS) {
+    const auto vertices = SmoothVertices(random, count);
+    const auto encoded  = BufferCodec::EncodeVertices(vertices);
+
+    std::vector<obj::Vertex> decoded;
+    BufferCodec::DecodeVertices(encoded, decoded, count);
+    OBJ_CHECK(SameBytes(vertices, decoded));
+    OBJ_CHECK(count < BufferCodec::VERTEX_BLOCK_SIZE || encoded.size() < count * sizeof(obj::Vertex));
+  }
+}
+
+OBJ_TEST(EncodeVerticesOddStrideRoundTrip) {
+  std::mt19937 random(3);
+
+  // a stride that is not a multiple of the 16 lanes a group packs
+  struct Odd
+  {
+    std::uint8_t bytes[7];
+  };
+
+  for (const size_t count : VERTEX_COUNTS) {
+    const auto values = RandomBytes<Odd>(random, count);
+
+    std::vector<Odd> decoded;
+    BufferCodec::DecodeVertices(BufferCodec::EncodeVertices(values), decoded, count);
+    OBJ_CHECK(SameBytes(values, decoded));
+  }
+}
+
+OBJ_TEST(EncodeMeshInterleavedRoundTrip) {
+  std::mt19937 random(4);
+
+  for (const size_t count : VERTEX_COUNTS) {
+    obj::Mesh mesh;
+    mesh.vertices = SmoothVertices(random, count);
+    mesh.indices  = count > 0 ? RandomIndices(random, count * 3, static_cast<unsigned int>(count - 1)) : obj::Indices{};
+
+    const auto encoded = BufferCodec::EncodeMesh(mesh);
+    OBJ_CHECK(!encoded.split);
+    OBJ_CHECK(encoded.indexSize == 4);
+
+    const auto decoded = RoundTrip(mesh);
+    OBJ_CHECK(SameBytes(mesh.vertices, decoded.vertices));
+    OBJ_CHECK(decoded.indices == mesh.indices);
+    OBJ_CHECK(decoded.positions.empty() && decoded.attributes.empty() && decoded.indices16.empty());
+  }
+}
+
+OBJ_TEST(EncodeMeshSplitRoundTrip) {
+  std::mt19937 random(5);
+
+  for (const size_t count : VERTEX_COUNTS) {
+    if (count == 0) {
+      continue; // an empty split mesh has nothing that tells it apart from an interleaved one
+    }
+
+    obj::Mesh mesh;
+    mesh.positions  = RandomBytes<glm::vec3>(random, count);
+    mesh.attributes = RandomBytes<obj::VertexAttributes>(random, count);
+    mesh.indices    = LocalIndices(count);
+
+    const auto encoded = BufferCodec::EncodeMesh(mesh);
+    OBJ_CHECK(encoded.split);
+
+    const auto decoded = RoundTrip(mesh);
+    OBJ_CHECK(SameBytes(mesh.positions, decoded.positions));
+    OBJ_CHECK(SameBytes(mesh.attributes, decoded.attributes));
+    OBJ_CHECK(decoded.indices == mesh.indices);
+    OBJ_CHECK(decoded.vertices.empty());
+  }
+}
+
+OBJ_TEST(EncodeMeshIndices16RoundTrip) {
+  std::mt19937 random(6);
+
+  for (const size_t count : VERTEX_COUNTS) {
+    obj::Mesh mesh;
+    mesh.vertices = RandomBytes<obj::Vertex>(random, count);
+    for (const unsigned int i : RandomIndices(random, count * 3, UINT16_MAX)) {
+      mesh.indices16.push_back(static_cast<std::uint16_t>(i));
+    }
+
+    const auto encoded = BufferCodec::EncodeMesh(mesh);
+    OBJ_CHECK(count == 0 || encoded.indexSize == 2);
+
+    const auto decoded = RoundTrip(mesh);
+    OBJ_CHECK(decoded.indices16 == mesh.indices16);
+    OBJ_CHECK(decoded.indices.empty() || count == 0);
+  }
+}
+
+OBJ_TEST(EncodeIndicesRoundTrip) {
+  std::mt19937 random(7);
+
+  // full range deltas in both directions, the longest varints
+  auto indices = RandomIndices(random, 1000, UINT32_MAX);
+  indices.insert(indices.end(), {0u, UINT32_MAX, 0u, UINT32_MAX});
+
+  std::vector<unsigned int> decoded(indices.size());
+  BufferCodec::DecodeIndices(BufferCodec::EncodeIndices(std::span<const unsigned int>(indices)), decoded);
+  OBJ_CHECK(decoded == indices);
+
+  const auto local   = LocalIndices(1000);
+  const auto encoded = BufferCodec::EncodeIndices(std::span<const unsigned int>(local));
+  OBJ_CHECK(encoded.size() <= local.size() * 2);
+
+  decoded.assign(local.size(), 0);
+  BufferCodec::DecodeIndices(encoded, decoded);
+  OBJ_CHECK(decoded == local);
+}
+
+OBJ_TEST(DecodeTruncatedThrows) {
+  std::mt19937 random(8);
+
+  const auto vertices       = RandomBytes<obj::Vertex>(random, 1000);
+  const auto encoded        = BufferCodec::EncodeVertices(vertices);
+  const auto indices        = RandomIndices(random, 1000, UINT32_MAX);
+  const auto encodedIndices = BufferCodec::EncodeIndices(std::span<const unsigned int>(indices));
+
+  for (const size_t cut : {size_t{0}, size_t{1}, encoded.size() / 2, encoded.size() - 1}) {
+    std::vector<obj::Vertex> decoded;
+    OBJ_CHECK(Throws([&] { BufferCodec::DecodeVertices(std::span(encoded).first(cut), decoded, vertices.size()); }));
+  }
+
+  for (const size_t cut : {size_t{0}, encodedIndices.size() / 2, encodedIndices.size() - 1}) {
+    std::vector<unsigned int> decoded(indices.size());
+    OBJ_CHECK(Throws([&] { BufferCodec::DecodeIndices(std::span(encodedIndices).first(cut), decoded); }));
+  }
+}
+
+OBJ_TEST(DecodeCorruptThrows) {
+  std::mt19937 random(9);
+
+  obj::Mesh mesh;
+  mesh.vertices = RandomBytes<obj::Vertex>(random, 300);
+  mesh.indices  = LocalIndices(300);
+
+  // a count the encoded bytes cannot hold has to throw instead of allocating it
+  auto encoded        = BufferCodec::EncodeMesh(mesh);
+  encoded.vertexCount = UINT64_MAX / 2;
+  obj::Mesh decoded;
+  OBJ_CHECK(Throws([&] { BufferCodec::DecodeMesh(encoded, decoded); }));
+
+  encoded            = BufferCodec::EncodeMesh(mesh);
+  encoded.indexCount = UINT64_MAX / 2;
+  OBJ_CHECK(Throws([&] { BufferCodec::DecodeMesh(encoded, decoded); }));
+
+  // a 16-bit decode of indices that do not fit
+  const obj::Indices wide = {0, 70000, 3};
+  std::vector<std::uint16_t> narrow(wide.size());
+  OBJ_CHECK(Throws([&] { BufferCodec::DecodeIndices(BufferCodec::EncodeIndices(std::span<const unsigned int>(wide)), narrow); }));
+
+  // random garbage must either decode to something or throw, never read out of bounds
+  for (int i = 0; i < 100; ++i) {
+    auto garbage = RandomBytes<std::uint8_t>(random, random() % 512);
+    try {
+      std::vector<obj::Vertex> vertices;
+      BufferCodec::DecodeVertices(garbage, vertices, 300);
+    }
+    catch (const std::runtime_error&) {}
+  }
+}
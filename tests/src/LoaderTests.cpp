@@ -0,0 +1,277 @@
+#include "ScratchDirectory.hpp"
+#include "TestCase.hpp"
+
+#include "obj/MaterialRegistry.hpp"
+#include "obj/ModelWatcher.hpp"
+#include "obj/ObjHelpers.hpp"
+#include "obj/ObjLoader.hpp"
+#include "obj/VertexLayout.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+namespace
+{
+  namespace fs = std::filesystem;
+
+  using tests::ScratchDirectory;
+
+  // two quads in objects and materials of their own, every object lists its own elements like the parser expects
+  constexpr std::string_view QUADS_OBJ = R"(mtllib quads.mtl
+o quadA
+v 0 0 0
+v 1 0 0
+v 1 1 0
+v 0 1 0
+vt 0 0
+vt 1 0
+vt 1 1
+vt 0 1
+vn 0 0 1
+usemtl matA
+f 1/1/1 2/2/1 3/3/1 4/4/1
+o quadB
+v 2 0 0
+v 3 0 0
+v 3 1 0
+v 2 1 0
+vt 0 0
+vt 1 0
+vt 1 1
+vt 0 1
+vn 0 0 1
+usemtl matB
+f 5/5/2 6/6/2 7/7/2 8/8/2
+)";
+
+  constexpr std::string_view QUADS_MTL = R"(newmtl matA
+map_Kd a.png
+
+newmtl matB
+map_Kd b.png
+)";
+
+  // hands out heap buffers and remembers what was asked for, called from several workers at once
+  struct RecordingAllocator
+  {
+    struct Request
+    {
+      obj::VertexFormat format;
+      size_t            vertexCount;
+      size_t            vertexBytes;
+      size_t            indexBytes;
+
+      auto operator<=>(const Request&) const = default;
+    };
+
+    std::mutex                                           mutex;
+    std::vector<std::unique_ptr<std::vector<std::byte>>> buffers;
+    std::vector<obj::BufferGrant>                        grants; // indexed by BufferGrant::handle
+    std::vector<Request>                                 requests;
+
+    std::function<obj::BufferGrant(const obj::BufferRequest&)> Allocator() {
+      return [this] (const obj::BufferRequest& t_request)
+      {
+        std::lock_guard lock(mutex);
+        requests.push_back({t_request.format, t_request.mesh.VertexCount(), t_request.vertexBytes, t_request.indexBytes});
+
+        auto& buffer = *buffers.emplace_back(
+          std::make_unique<std::vector<std::byte>>(t_request.vertexBytes + t_request.attributeBytes + t_request.indexBytes));
+        std::byte* data = buffer.data();
+        return grants.emplace_back(obj::BufferGrant{
+          .vertices   = {data, t_request.vertexBytes},
+          .attributes = {data + t_request.vertexBytes, t_request.attributeBytes},
+          .indices    = {data + t_request.vertexBytes + t_request.attributeBytes, t_request.indexBytes},
+          .handle     = grants.size()});
+      };
+    }
+
+    // in a fixed order, the workers call in whatever order they finish
+    std::vector<Request> SortedRequests() {
+      std::lock_guard lock(mutex);
+      auto sorted = requests;
+      std::ranges::sort(sorted);
+      return sorted;
+    }
+  };
+}
+
+OBJ_TEST(CacheMissAndHitWriteSameVertexFormat) {
+  const ScratchDirectory directory("CacheMissAndHitWriteSameVertexFormat");
+  const fs::path         path = directory.Write("quads.obj", QUADS_OBJ);
+  directory.Write("quads.mtl", QUADS_MTL);
+
+  for (const obj::Flag flags : {obj::Flag::BinaryCache, obj::Flag::BinaryCache | obj::Flag::CombineMeshes}) {
+    ObjLoader loader(2);
+    loader.SetCacheDirectory(directory.Path() / "cache");
+
+    RecordingAllocator cold;
+    RecordingAllocator warm;
+    const auto         load = [&] (RecordingAllocator& t_allocator)
+    {
+      return loader.LoadFile({.path         = path,
+                              .flags        = flags,
+                              .allocator    = t_allocator.Allocator(),
+                              .vertexFormat = obj::VertexFormat::Position}).get();
+    };
+
+    const obj::Model miss = load(cold);
+    const obj::Model hit  = load(warm);
+    OBJ_CHECK(!miss.stats.fromCache);
+    OBJ_CHECK(hit.stats.fromCache);
+
+    const auto coldRequests = cold.SortedRequests();
+    OBJ_CHECK(!coldRequests.empty());
+    OBJ_CHECK(coldRequests == warm.SortedRequests());
+
+    for (const auto& request : coldRequests) {
+      OBJ_CHECK(request.format == obj::VertexFormat::Position);
+      OBJ_CHECK(request.vertexBytes == request.vertexCount * obj::VertexFormatSize(obj::VertexFormat::Position));
+    }
+
+    for (const obj::Model* model : {&miss, &hit}) {
+      for (const auto& mesh : model->meshes.at(0)) {
+        OBJ_CHECK(mesh.buffer && mesh.buffer->format == obj::VertexFormat::Position);
+        OBJ_CHECK(mesh.vertices.empty());
+      }
+    }
+  }
+}
+
+OBJ_TEST(MtlReloadMatchesFreshLoad) {
+  const ScratchDirectory directory("MtlReloadMatchesFreshLoad");
+  const fs::path         path = directory.Write("quads.obj", QUADS_OBJ);
+
+  for (const obj::Flag flags : {obj::Flag::CombineMeshes, obj::Flag::CombineMeshes | obj::Flag::SharedMaterials}) {
+    directory.Write("quads.mtl", QUADS_MTL);
+
+    ObjLoader         loader(2);
+    obj::ModelWatcher watcher;
+    watcher.Watch(path, flags);
+    obj::Model model = loader.LoadFile(path, flags).get();
+
+    // a new texture for matA makes it a different material, with an id of its own
+    directory.Rewrite("quads.mtl", "newmtl matA\nmap_Kd c.png\n\nnewmtl matB\nmap_Kd b.png\n");
+    const auto changes = watcher.Poll();
+    OBJ_CHECK(changes.size() == 1);
+    if (changes.size() != 1) {
+      continue;
+    }
+    OBJ_CHECK(changes[0].objLods.empty() && changes[0].mtlLods.size() == 1);
+
+    const obj::Model reloaded = loader.Reload(std::move(model), changes[0]).get();
+    const obj::Model fresh    = loader.LoadFile(path, flags).get();
+
+    const auto& meshes      = reloaded.meshes.at(0);
+    const auto& freshMeshes = fresh.meshes.at(0);
+    OBJ_CHECK(meshes.size() == freshMeshes.size());
+    for (size_t i = 0; i < meshes.size() && i < freshMeshes.size(); ++i) {
+      OBJ_CHECK(meshes[i].material.diffuseName == freshMeshes[i].material.diffuseName);
+      OBJ_CHECK(meshes[i].materialId == freshMeshes[i].materialId);
+    }
+
+    OBJ_CHECK(reloaded.combinedMeshes.size() == 1 && fresh.combinedMeshes.size() == 1);
+    if (reloaded.combinedMeshes.size() != 1 || fresh.combinedMeshes.size() != 1) {
+      continue;
+    }
+
+    const auto& ranges      = reloaded.combinedMeshes[0].drawRanges;
+    const auto& freshRanges = fresh.combinedMeshes[0].drawRanges;
+    OBJ_CHECK(ranges.size() == meshes.size() && ranges.size() == freshRanges.size());
+    for (size_t i = 0; i < ranges.size() && i < freshRanges.size() && i < meshes.size(); ++i) {
+      OBJ_CHECK(ranges[i].materialId == meshes[i].materialId);
+      OBJ_CHECK(ranges[i].materialId == freshRanges[i].materialId);
+      OBJ_CHECK(ranges[i].firstIndex == freshRanges[i].firstIndex && ranges[i].indexCount == freshRanges[i].indexCount);
+    }
+
+    if ((flags & obj::Flag::SharedMaterials) == obj::Flag::SharedMaterials) {
+      OBJ_CHECK(loader.Materials().Get(ranges.at(0).materialId).diffuseName == "c.png");
+    }
+  }
+}
+
+OBJ_TEST(AllocatorReceivesEveryVertexFormat) {
+  const ScratchDirectory directory("AllocatorReceivesEveryVertexFormat");
+  const fs::path         path = directory.Write("quads.obj", QUADS_OBJ);
+  directory.Write("quads.mtl", QUADS_MTL);
+
+  ObjLoader        loader(2);
+  const obj::Model reference = loader.LoadFile(path).get();
+
+  for (const obj::VertexFormat format : {obj::VertexFormat::Full,
+                                         obj::VertexFormat::HalfUv,
+                                         obj::VertexFormat::Compact,
+                                         obj::VertexFormat::Quantized,
+                                         obj::VertexFormat::Position,
+                                         obj::VertexFormat::QuantizedPosition}) {
+    RecordingAllocator allocator;
+    const obj::Model   model = loader.LoadFile({.path = path, .allocator = allocator.Allocator(), .vertexFormat = format}).get();
+
+    const auto& meshes          = model.meshes.at(0);
+    const auto& referenceMeshes = reference.meshes.at(0);
+    OBJ_CHECK(meshes.size() == referenceMeshes.size());
+    OBJ_CHECK(allocator.requests.size() == meshes.size());
+
+    for (const auto& request : allocator.requests) {
+      OBJ_CHECK(request.format == format);
+      OBJ_CHECK(request.vertexBytes == request.vertexCount * obj::VertexFormatSize(format));
+    }
+
+    for (size_t i = 0; i < meshes.size() && i < referenceMeshes.size(); ++i) {
+      const obj::Mesh& mesh = meshes[i];
+      const obj::Mesh& ref  = referenceMeshes[i];
+      if (!mesh.buffer) {
+        OBJ_CHECK(mesh.buffer.has_value());
+        continue;
+      }
+
+      OBJ_CHECK(mesh.buffer->format == format);
+      OBJ_CHECK(mesh.buffer->vertexCount == ref.VertexCount() && mesh.buffer->indexCount == ref.IndexCount());
+      OBJ_CHECK(mesh.vertices.empty() && mesh.indices.empty());
+
+      // the grant holds exactly what the Model would have, packed if the format asks for it
+      const obj::BufferGrant& grant = allocator.grants.at(mesh.buffer->handle);
+      OBJ_CHECK(std::memcmp(grant.indices.data(), ref.indices.data(), ref.indices.size() * sizeof(unsigned int)) == 0);
+      if (format == obj::VertexFormat::Full) {
+        OBJ_CHECK(std::memcmp(grant.vertices.data(), ref.vertices.data(), ref.vertices.size() * sizeof(obj::Vertex)) == 0);
+      }
+      if (format == obj::VertexFormat::Position) {
+        glm::vec3 first;
+        std::memcpy(&first, grant.vertices.data(), sizeof(first));
+        OBJ_CHECK(first == ref.vertices.at(0).position);
+      }
+    }
+  }
+}
+
+OBJ_TEST(SplitStreamsAllocatorRejectsPackedFormat) {
+  const ScratchDirectory directory("SplitStreamsAllocatorRejectsPackedFormat");
+  const fs::path         path = directory.Write("quads.obj", QUADS_OBJ);
+  directory.Write("quads.mtl", QUADS_MTL);
+
+  ObjLoader loader(2);
+
+  // split streams have no interleaved vertices to pack, only Full describes what they write
+  RecordingAllocator split;
+  const obj::Model   model = loader.LoadFile({.path = path, .flags = obj::Flag::SplitStreams, .allocator = split.Allocator()}).get();
+  OBJ_CHECK(!split.grants.empty());
+  for (const auto& grant : split.grants) {
+    OBJ_CHECK(!grant.attributes.empty());
+  }
+  OBJ_CHECK(model.meshes.at(0).at(0).positions.empty());
+
+  RecordingAllocator packed;
+  bool               threw = false;
+  try {
+    (void)loader.LoadFile({.path         = path,
+                           .flags        = obj::Flag::SplitStreams,
+                           .allocator    = packed.Allocator(),
+                           .vertexFormat = obj::VertexFormat::Compact}).get();
+  }
+  catch (const std::runtime_error&) {
+    threw = true;
+  }
+  OBJ_CHECK(threw);
+}
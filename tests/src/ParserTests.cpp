@@ -0,0 +1,106 @@
+#include "ScratchDirectory.hpp"
+#include "TestCase.hpp"
+
+#include "obj/ObjHelpers.hpp"
+#include "obj/ObjLoader.hpp"
+
+#include <cmath>
+#include <string>
+
+namespace
+{
+  using tests::ScratchDirectory;
+
+  // loads t_obj as the only lod of a model whose mtl is empty
+  obj::Model LoadText(const std::string_view t_name, const std::string_view t_obj, const obj::Flag t_flags = obj::Flag::None) {
+    const ScratchDirectory directory(t_name);
+    const auto             path = directory.Write("model.obj", t_obj);
+    directory.Write("model.mtl", "");
+
+    ObjLoader loader(2);
+    return loader.LoadFile(path, t_flags).get();
+  }
+
+  // twice the signed area of the triangle in the xy plane
+  float Cross2(const glm::vec3& t_a, const glm::vec3& t_b, const glm::vec3& t_c) {
+    return (t_b.x - t_a.x) * (t_c.y - t_a.y) - (t_b.y - t_a.y) * (t_c.x - t_a.x);
+  }
+
+  // the triangles as corner positions, independent of how the mesh shares its vertices
+  std::vector<glm::vec3> TrianglePositions(const obj::Mesh& t_mesh) {
+    std::vector<glm::vec3> corners;
+    for (const unsigned int index : t_mesh.indices) {
+      corners.push_back(t_mesh.vertices.at(index).position);
+    }
+    return corners;
+  }
+
+  constexpr std::string_view QUAD_PAIR_HEADER = R"(o pair
+v 0 0 0
+v 1 0 0
+v 1 1 0
+v 0 1 0
+v 2 0 0
+v 2 1 0
+vt 0 0
+vn 0 0 1
+)";
+}
+
+OBJ_TEST(NegativeFaceIndicesMatchAbsolute) {
+  const std::string absolute = std::string(QUAD_PAIR_HEADER) + "f 1/1/1 2/1/1 3/1/1 4/1/1\nf 2/1/1 5/1/1 6/1/1 3/1/1\n";
+  const std::string relative = std::string(QUAD_PAIR_HEADER) + "f -6/-1/-1 -5/-1/-1 -4/-1/-1 -3/-1/-1\n"
+                                                               "f -5/-1/-1 -2/-1/-1 -1/-1/-1 -4/-1/-1\n";
+
+  const obj::Model a = LoadText("NegativeFaceIndicesAbsolute", absolute);
+  const obj::Model b = LoadText("NegativeFaceIndicesRelative", relative);
+
+  const auto& meshA = a.meshes.at(0).at(0);
+  const auto& meshB = b.meshes.at(0).at(0);
+  OBJ_CHECK(meshA.indices.size() == 12);
+  OBJ_CHECK(TrianglePositions(meshA) == TrianglePositions(meshB));
+}
+
+OBJ_TEST(ConcavePolygonIsEarClipped) {
+  // an L, a fan from its first corner would cover the notch at (1, 1)
+  const obj::Model model = LoadText("ConcavePolygonIsEarClipped", R"(o l
+v 2 0 0
+v 2 1 0
+v 1 1 0
+v 1 2 0
+v 0 2 0
+v 0 0 0
+vt 0 0
+vn 0 0 1
+f 1/1/1 2/1/1 3/1/1 4/1/1 5/1/1 6/1/1
+)");
+
+  const auto corners = TrianglePositions(model.meshes.at(0).at(0));
+  OBJ_CHECK(corners.size() == 4 * 3);
+
+  // every triangle keeps the winding of the first, and together they cover exactly the area of 3 of the polygon
+  const float winding  = corners.size() < 3 ? 0.0f : Cross2(corners[0], corners[1], corners[2]);
+  float       area     = 0.0f;
+  bool        windings = winding != 0.0f;
+  for (size_t i = 0; i + 2 < corners.size(); i += 3) {
+    const float cross = Cross2(corners[i], corners[i + 1], corners[i + 2]);
+    windings          = windings && cross * winding > 0.0f;
+    area += std::abs(cross) * 0.5f;
+  }
+  OBJ_CHECK(windings);
+  OBJ_CHECK(std::abs(area - 3.0f) < 1e-5f);
+}
+
+OBJ_TEST(JoinIdenticalWeldsSharedCorners) {
+  // two triangles of one quad, every corner its own (v, vt, vn) so only the welder can share them
+  const std::string quad = std::string(QUAD_PAIR_HEADER) + "f 1/1/1 2/1/1 3/1/1\nf 1/1/1 3/1/1 4/1/1\n";
+
+  const obj::Model plain  = LoadText("JoinIdenticalPlain", quad);
+  const obj::Model welded = LoadText("JoinIdenticalWelded", quad, obj::Flag::JoinIdentical);
+
+  const auto& plainMesh  = plain.meshes.at(0).at(0);
+  const auto& weldedMesh = welded.meshes.at(0).at(0);
+  OBJ_CHECK(plainMesh.vertices.size() == 6);
+  OBJ_CHECK(weldedMesh.vertices.size() == 4);
+  OBJ_CHECK(TrianglePositions(plainMesh) == TrianglePositions(weldedMesh));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+namespace tests
+{
+  // a directory of its own under the system temp directory, removed again once the test is done
+  class ScratchDirectory
+  {
+  public:
+    explicit ScratchDirectory(const std::string_view t_name) :
+      m_path(std::filesystem::temp_directory_path() / "obj_tests" / t_name) {
+      std::filesystem::remove_all(m_path);
+      std::filesystem::create_directories(m_path);
+    }
+
+    ~ScratchDirectory() {
+      std::error_code error;
+      std::filesystem::remove_all(m_path, error);
+    }
+
+    ScratchDirectory(const ScratchDirectory&)            = delete;
+    ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+
+    std::filesystem::path Write(const std::string_view t_name, const std::string_view t_text) const {
+      const std::filesystem::path path = m_path / t_name;
+      std::ofstream(path, std::ios::binary) << t_text;
+      return path;
+    }
+
+    // rewrites a file with a later write time, so a watcher sees the change however coarse the file system clock is
+    void Rewrite(const std::string_view t_name, const std::string_view t_text) const {
+      const std::filesystem::path path     = m_path / t_name;
+      const auto                  previous = std::filesystem::last_write_time(path);
+      Write(t_name, t_text);
+      std::filesystem::last_write_time(path, previous + std::chrono::seconds(2));
+    }
+
+    [[nodiscard]] const std::filesystem::path& Path() const { return m_path; }
+
+  private:
+    std::filesystem::path m_path;
+  };
+}
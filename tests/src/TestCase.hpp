@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+/*
+ * A test is a function registered with OBJ_TEST and checked with OBJ_CHECK, a failed check is reported and the test
+ * keeps running, so one run lists every broken check. Tests must not depend on each other, they run in the order their
+ * files happen to be linked
+ */
+
+namespace tests
+{
+  struct TestCase
+  {
+    std::string_view name;
+    void (*run)();
+  };
+
+  std::vector<TestCase>& Registry();
+  void                   Fail(std::string_view t_expression, std::string_view t_file, int t_line);
+
+  struct Register
+  {
+    Register(const std::string_view t_name, void (*t_run)()) { Registry().push_back({t_name, t_run}); }
+  };
+}
+
+#define OBJ_TEST(t_name)                                                  \
+  static void                  t_name();                                  \
+  static const tests::Register t_name##Register(#t_name, &t_name);        \
+  static void                  t_name()
+
+#define OBJ_CHECK(t_expression)                                           \
+  do {                                                                    \
+    if (!(t_expression)) {                                                \
+      tests::Fail(#t_expression, __FILE__, __LINE__);                     \
+    }                                                                     \
+  } while (false)
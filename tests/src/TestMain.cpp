@@ -0,0 +1,56 @@
+#include "TestCase.hpp"
+
+#include "pool/Logger/Logger.hpp"
+
+#include <exception>
+#include <iostream>
+
+namespace
+{
+  size_t g_failures = 0; // failed checks of the test that is running
+}
+
+namespace tests
+{
+  std::vector<TestCase>& Registry() {
+    static std::vector<TestCase> registry;
+    return registry;
+  }
+
+  void Fail(const std::string_view t_expression, const std::string_view t_file, const int t_line) {
+    ++g_failures;
+    std::cerr << "  " << t_file << ":" << t_line << ": check failed: " << t_expression << "\n";
+  }
+}
+
+// runs every registered test, or only those whose name contains the first argument, and fails if any check did
+int main(const int t_argc, char** t_argv) {
+  const std::string_view filter = t_argc > 1 ? t_argv[1] : "";
+
+  // every load logs its progress at Debug, only what went wrong belongs in the test output
+  Logger::Instance().currentLogLevel = Logger::Warning;
+
+  size_t failed = 0;
+  size_t ran    = 0;
+
+  for (const auto& [name, run] : tests::Registry()) {
+    if (!filter.empty() && name.find(filter) == std::string_view::npos) {
+      continue;
+    }
+
+    g_failures = 0;
+    try {
+      run();
+    }
+    catch (const std::exception& e) {
+      tests::Fail(e.what(), name, 0);
+    }
+
+    ++ran;
+    failed += g_failures > 0 ? 1 : 0;
+    std::cout << (g_failures > 0 ? "[FAIL] " : "[ OK ] ") << name << "\n";
+  }
+
+  std::cout << ran - failed << " of " << ran << " tests passed\n";
+  return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+#include "TestCase.hpp"
+
+#include "pool/ThreadPool.hpp"
+#include "pool/WorkStealingDeque.hpp"
+
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  constexpr size_t ITEM_COUNT  = 200000;
+  constexpr size_t THIEF_COUNT = 4;
+
+  /*!
+   * @brief Runs one owner and THIEF_COUNT thieves on a deque that starts at t_capacity, then checks every item was
+   * taken exactly once. The owner pushes in bursts and pops some of every burst back, so pops race steals for the last
+   * item and the ring grows while thieves read it
+   */
+  void RunOwnerAndThieves(const std::int64_t t_capacity) {
+    WorkStealingDeque<size_t> deque(t_capacity);
+
+    std::vector<size_t> items(ITEM_COUNT);
+    std::iota(items.begin(), items.end(), size_t{0});
+
+    std::vector<std::atomic<unsigned int>> taken(ITEM_COUNT);
+    std::atomic<size_t>                    takenCount = 0;
+    std::atomic<size_t>                    takenSum   = 0;
+    std::atomic<bool>                      ownerDone  = false;
+
+    const auto take = [&](const size_t* t_item) {
+      taken[*t_item].fetch_add(1, std::memory_order_relaxed);
+      takenCount.fetch_add(1, std::memory_order_relaxed);
+      takenSum.fetch_add(*t_item, std::memory_order_relaxed);
+    };
+
+    std::vector<std::thread> thieves;
+    for (size_t i = 0; i < THIEF_COUNT; ++i) {
+      thieves.emplace_back([&] {
+        while (true) {
+          if (const size_t* item = deque.Steal()) {
+            take(item);
+          }
+          else if (ownerDone.load(std::memory_order_acquire) && deque.Empty()) {
+            return;
+          }
+        }
+      });
+    }
+
+    std::mt19937 random(static_cast<unsigned int>(t_capacity));
+    for (size_t next = 0; next < ITEM_COUNT;) {
+      const size_t burst = std::min<size_t>(random() % 1024 + 1, ITEM_COUNT - next);
+      for (size_t i = 0; i < burst; ++i) {
+        deque.Push(&items[next++]);
+      }
+
+      for (size_t pops = random() % (burst + 1); pops > 0; --pops) {
+        if (const size_t* item = deque.Pop()) {
+          take(item);
+        }
+      }
+    }
+
+    // whatever the thieves have not taken yet, the owner drains it itself
+    while (const size_t* item = deque.Pop()) {
+      take(item);
+    }
+    ownerDone.store(true, std::memory_order_release);
+
+    for (auto& thief : thieves) {
+      thief.join();
+    }
+
+    OBJ_CHECK(takenCount.load() == ITEM_COUNT);
+    OBJ_CHECK(takenSum.load() == ITEM_COUNT * (ITEM_COUNT - 1) / 2);
+    OBJ_CHECK(deque.Empty());
+    OBJ_CHECK(deque.Steal() == nullptr);
+
+    size_t wrong = 0;
+    for (const auto& count : taken) {
+      wrong += count.load() != 1 ? 1 : 0;
+    }
+    OBJ_CHECK(wrong == 0);
+  }
+
+  // posts two children per task down to t_depth, so most tasks are spawned by workers onto their own deque
+  void Fork(ThreadPool& t_pool, std::atomic<size_t>& t_ran, const unsigned int t_depth) {
+    t_ran.fetch_add(1, std::memory_order_relaxed);
+    if (t_depth == 0) {
+      return;
+    }
+
+    for (int i = 0; i < 2; ++i) {
+      t_pool.Post([&t_pool, &t_ran, t_depth] { Fork(t_pool, t_ran, t_depth - 1); });
+    }
+  }
+}
+
+OBJ_TEST(WorkStealingDequeOwnerOnly) {
+  WorkStealingDeque<size_t> deque(2);
+  std::vector<size_t>       items(1000);
+  std::iota(items.begin(), items.end(), size_t{0});
+
+  OBJ_CHECK(deque.Pop() == nullptr);
+  OBJ_CHECK(deque.Steal() == nullptr);
+
+  for (auto& item : items) {
+    deque.Push(&item);
+  }
+
+  // the owner pops newest first, thieves take the oldest
+  OBJ_CHECK(deque.Steal() == &items.front());
+  bool lifo = true;
+  for (size_t i = items.size() - 1; i > 0; --i) {
+    lifo = lifo && deque.Pop() == &items[i];
+  }
+  OBJ_CHECK(lifo);
+  OBJ_CHECK(deque.Empty());
+  OBJ_CHECK(deque.Pop() == nullptr);
+}
+
+OBJ_TEST(WorkStealingDequeConcurrent) {
+  RunOwnerAndThieves(256);
+}
+
+OBJ_TEST(WorkStealingDequeConcurrentGrowth) {
+  RunOwnerAndThieves(2); // an item count far above the capacity forces the ring to grow under contention
+}
+
+OBJ_TEST(WorkStealingPoolForkTree) {
+  constexpr unsigned int DEPTH = 14;
+
+  std::atomic<size_t> ran = 0;
+  {
+    ThreadPool pool(4, ThreadPool::Scheduling::WorkStealing);
+    for (int round = 0; round < 4; ++round) {
+      pool.Post([&pool, &ran] { Fork(pool, ran, DEPTH); });
+      pool.Drain();
+    }
+  }
+
+  OBJ_CHECK(ran.load() == 4 * ((size_t{1} << (DEPTH + 1)) - 1));
+}